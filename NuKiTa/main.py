@@ -1,8 +1,8 @@
-#import runpy
-
-
-#runpy.run_module("nukita_app.main", run_name="__main__")
-
-from nukita_app.main import main
-if __name__ == "__main__":
-    main()
+#import runpy
+
+
+#runpy.run_module("nukita_app.main", run_name="__main__")
+
+from nukita_app.main import main
+if __name__ == "__main__":
+    main()
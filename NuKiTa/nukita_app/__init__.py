@@ -1 +1 @@
-# NuKiTa application package
+# NuKiTa application package
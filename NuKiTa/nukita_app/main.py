@@ -1,39 +1,39 @@
-import sys
-from PySide6.QtWidgets import QApplication
-from PySide6.QtGui import QPalette, QColor, QFont
-from PySide6.QtCore import Qt
-from nukita_app.main_window import MainWindow
-
-def apply_dark_theme(app: QApplication):
-    app.setStyle("Fusion")
-    # Global readable UI font
-    app.setFont(QFont("Segoe UI", 11))
-
-    dark_palette = QPalette()
-    dark_color = QColor(45, 45, 45)
-    disabled_color = QColor(127, 127, 127)
-    dark_palette.setColor(QPalette.Window, dark_color)
-    dark_palette.setColor(QPalette.WindowText, Qt.white)
-    dark_palette.setColor(QPalette.Base, QColor(30, 30, 30))
-    dark_palette.setColor(QPalette.AlternateBase, dark_color)
-    dark_palette.setColor(QPalette.ToolTipBase, Qt.white)
-    dark_palette.setColor(QPalette.ToolTipText, Qt.white)
-    dark_palette.setColor(QPalette.Text, Qt.white)
-    dark_palette.setColor(QPalette.Disabled, QPalette.Text, disabled_color)
-    dark_palette.setColor(QPalette.Button, dark_color)
-    dark_palette.setColor(QPalette.ButtonText, Qt.white)
-    dark_palette.setColor(QPalette.Disabled, QPalette.ButtonText, disabled_color)
-    dark_palette.setColor(QPalette.BrightText, Qt.red)
-    dark_palette.setColor(QPalette.Highlight, QColor(64, 128, 255))
-    dark_palette.setColor(QPalette.HighlightedText, Qt.black)
-    app.setPalette(dark_palette)
-
-def main():
-    app = QApplication(sys.argv)
-    apply_dark_theme(app)
-    win = MainWindow()
-    win.show()
-    sys.exit(app.exec())
-
-if __name__ == "__main__":
-    main()
+import sys
+from PySide6.QtWidgets import QApplication
+from PySide6.QtGui import QPalette, QColor, QFont
+from PySide6.QtCore import Qt
+from nukita_app.main_window import MainWindow
+
+def apply_dark_theme(app: QApplication):
+    app.setStyle("Fusion")
+    # Global readable UI font
+    app.setFont(QFont("Segoe UI", 11))
+
+    dark_palette = QPalette()
+    dark_color = QColor(45, 45, 45)
+    disabled_color = QColor(127, 127, 127)
+    dark_palette.setColor(QPalette.Window, dark_color)
+    dark_palette.setColor(QPalette.WindowText, Qt.white)
+    dark_palette.setColor(QPalette.Base, QColor(30, 30, 30))
+    dark_palette.setColor(QPalette.AlternateBase, dark_color)
+    dark_palette.setColor(QPalette.ToolTipBase, Qt.white)
+    dark_palette.setColor(QPalette.ToolTipText, Qt.white)
+    dark_palette.setColor(QPalette.Text, Qt.white)
+    dark_palette.setColor(QPalette.Disabled, QPalette.Text, disabled_color)
+    dark_palette.setColor(QPalette.Button, dark_color)
+    dark_palette.setColor(QPalette.ButtonText, Qt.white)
+    dark_palette.setColor(QPalette.Disabled, QPalette.ButtonText, disabled_color)
+    dark_palette.setColor(QPalette.BrightText, Qt.red)
+    dark_palette.setColor(QPalette.Highlight, QColor(64, 128, 255))
+    dark_palette.setColor(QPalette.HighlightedText, Qt.black)
+    app.setPalette(dark_palette)
+
+def main():
+    app = QApplication(sys.argv)
+    apply_dark_theme(app)
+    win = MainWindow()
+    win.show()
+    sys.exit(app.exec())
+
+if __name__ == "__main__":
+    main()
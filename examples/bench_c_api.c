@@ -0,0 +1,100 @@
+/*
+Benchmark: per-call overhead of the typed C API (value stack) against the string API (AdaScript_Call and
+AdaScript_RegisterNativeStringFn), and of precompiled programs and function handles against AdaScript_Eval and calls
+by name. Build against the shared library and run from the repository root:
+     cc -O2 -Iinclude examples/bench_c_api.c -Lbuild -ladascript_core -o bench_c_api
+     LD_LIBRARY_PATH=build ./bench_c_api
+*/
+#include "AdaScript.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now(void){ struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts); return ts.tv_sec + ts.tv_nsec * 1e-9; }
+
+static void report(const char* what, int n, double t, double check){ printf("%-34s %8.0f ns/call  (check %.0f)\n", what, t / n * 1e9, check); }
+
+// Callbacks: add two numbers
+static char* add_str(void* user, const char* const* args, int argc){
+    (void)user; (void)argc; char* out = (char*)malloc(32); if(out) snprintf(out, 32, "%.17g", strtod(args[0], NULL) + strtod(args[1], NULL)); return out; }
+static int add_typed(AdaScriptVM* vm, void* user, int argc){
+    (void)user; (void)argc; AdaScript_PushNumber(vm, AdaScript_ToNumber(vm, 0) + AdaScript_ToNumber(vm, 1)); return 1; }
+
+int main(void){
+    const int n = 200000, items = 100;
+    AdaScriptVM* vm = AdaScript_Create(NULL); if(!vm) return 1;
+    AdaScript_RegisterNativeStringFn(vm, "c_add_str", 2, add_str, NULL);
+    AdaScript_RegisterNativeFn(vm, "c_add", 2, add_typed, NULL);
+    const char* src =
+        "func add(a, b) { return a + b; }\n"
+        "func add_str(a, b) { return float(a) + float(b); }\n"
+        "func sum(xs) { let s = 0; for (x in xs) { s = s + x; } return s; }\n"
+        "func sum_str(csv) { let s = 0; for (x in split(csv, \",\")) { s = s + float(x); } return s; }\n"
+        "func loop_str(n) { let s = 0; for (i in range(0, float(n))) { s = float(c_add_str(s, 1)); } return s; }\n"
+        "func loop_typed(n) { let s = 0; for (i in range(0, n)) { s = c_add(s, 1); } return s; }\n";
+    char* err = NULL;
+    if(AdaScript_Eval(vm, src, NULL, &err) != 0){ fprintf(stderr, "%s\n", err); return 1; }
+
+    // 1. two numbers in, one number out
+    double t = now(), acc = 0; char a[32], b[32];
+    for(int i = 0; i < n; ++i){
+        snprintf(a, sizeof a, "%d", i); snprintf(b, sizeof b, "%d", 1);
+        const char* args[] = { a, b }; char* r = AdaScript_Call(vm, "add_str", args, 2, &err);
+        acc += strtod(r, NULL); AdaScript_FreeString(r);
+    }
+    report("call add, string API", n, now() - t, acc);
+    t = now(); acc = 0;
+    for(int i = 0; i < n; ++i){
+        AdaScript_PushNumber(vm, i); AdaScript_PushNumber(vm, 1);
+        AdaScript_CallTyped(vm, "add", 2, &err); acc += AdaScript_ToNumber(vm, -1); AdaScript_Pop(vm, 1);
+    }
+    report("call add, typed API", n, now() - t, acc);
+
+    // 2. a list of 100 numbers in, one number out
+    int m = n / 10; char* csv = (char*)malloc(items * 12); t = now(); acc = 0;
+    for(int i = 0; i < m; ++i){
+        char* w = csv; for(int k = 0; k < items; ++k) w += sprintf(w, k? ",%d" : "%d", k + i);
+        const char* args[] = { csv }; char* r = AdaScript_Call(vm, "sum_str", args, 1, &err);
+        acc += strtod(r, NULL); AdaScript_FreeString(r);
+    }
+    report("call sum(100 items), string API", m, now() - t, acc);
+    free(csv); t = now(); acc = 0;
+    for(int i = 0; i < m; ++i){
+        AdaScript_NewList(vm, items); for(int k = 0; k < items; ++k){ AdaScript_PushNumber(vm, k + i); AdaScript_ListAppend(vm, -2); }
+        AdaScript_CallTyped(vm, "sum", 1, &err); acc += AdaScript_ToNumber(vm, -1); AdaScript_Pop(vm, 1);
+    }
+    report("call sum(100 items), typed API", m, now() - t, acc);
+    AdaScript_NewList(vm, items); for(int k = 0; k < items; ++k){ AdaScript_PushNumber(vm, k); AdaScript_ListAppend(vm, -2); }
+    AdaScriptValue* list = AdaScript_Ref(vm, -1); AdaScript_Pop(vm, 1); t = now(); acc = 0;
+    for(int i = 0; i < m; ++i){ AdaScript_PushRef(vm, list); AdaScript_CallTyped(vm, "sum", 1, &err); acc += AdaScript_ToNumber(vm, -1); AdaScript_Pop(vm, 1); }
+    report("call sum(100 items), reused handle", m, now() - t, acc);
+    AdaScript_Release(list);
+
+    // 3. script calling a native callback
+    const char* nstr = "200000"; t = now();
+    char* r = AdaScript_Call(vm, "loop_str", &nstr, 1, &err); acc = strtod(r, NULL); AdaScript_FreeString(r);
+    report("script -> native, string API", n, now() - t, acc);
+    t = now(); AdaScript_PushNumber(vm, n); AdaScript_CallTyped(vm, "loop_typed", 1, &err); acc = AdaScript_ToNumber(vm, -1); AdaScript_Pop(vm, 1);
+    report("script -> native, typed API", n, now() - t, acc);
+
+    // 4. a rule snippet evaluated per request, and a function called through a handle
+    const char* rule = "let score = 0; for (i in range(0, 10)) { score = score + i * 2; } if (score > 50) { verdict = true; }\n";
+    AdaScript_Eval(vm, "let verdict = false;", NULL, &err); t = now();
+    for(int i = 0; i < m; ++i) AdaScript_Eval(vm, rule, NULL, &err);
+    report("rule, Eval", m, now() - t, 0);
+    AdaScriptProgram* prog = AdaScript_Compile(rule, NULL, &err); t = now();
+    for(int i = 0; i < m; ++i) AdaScript_Execute(vm, prog, &err);
+    report("rule, Compile once + Execute", m, now() - t, 0);
+    AdaScript_FreeProgram(prog);
+    AdaScriptValue* add = AdaScript_GetFunction(vm, "add"); t = now(); acc = 0;
+    for(int i = 0; i < n; ++i){
+        AdaScript_PushNumber(vm, i); AdaScript_PushNumber(vm, 1);
+        AdaScript_CallHandle(vm, add, 2, &err); acc += AdaScript_ToNumber(vm, -1); AdaScript_Pop(vm, 1);
+    }
+    report("call add, function handle", n, now() - t, acc);
+    AdaScript_Release(add);
+
+    AdaScript_Destroy(vm);
+    return 0;
+}
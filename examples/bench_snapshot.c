@@ -0,0 +1,78 @@
+/*
+Benchmark: a fresh VM per request, built from scratch (AdaScript_Create + setup script) against one created from a
+snapshot of a VM that already ran the setup. Also checks that VMs created from the snapshot are isolated from each
+other, and runs them on several threads at once. Build against the shared library and run from the repository root:
+     cc -O2 -Iinclude examples/bench_snapshot.c -Lbuild -ladascript_core -lpthread -o bench_snapshot
+     LD_LIBRARY_PATH=build ./bench_snapshot [threads]
+*/
+#include "AdaScript.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now(void){ struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts); return ts.tv_sec + ts.tv_nsec * 1e-9; }
+
+static const char* kSetup =
+    "import \"builtins/libs\";\n"
+    "class Order { func init(id, qty) { this.id = id; this.qty = qty; } func total(price) { return this.qty * price; } }\n"
+    "let prices = {}; for (i in range(0, 200)) { prices[\"sku\" + str(i)] = i * 1.5; }\n"
+    "let seen = []; let recent = LRUCache(16); recent.put(\"boot\", 1);\n"
+    "func handle(id, qty) {\n"
+    "  let o = Order(id, qty); seen[len(seen)] = id; recent.put(str(id), qty);\n"
+    "  return o.total(prices[\"sku\" + str(id % 200)]) + len(seen) + recent.size() + scale(1);\n"
+    "}\n";
+
+static int scale(AdaScriptVM* vm, void* user, int argc){ (void)argc; AdaScript_PushNumber(vm, AdaScript_ToNumber(vm, 0) * *(double*)user); return 1; }
+static double g_factor = 10;
+
+static AdaScriptVM* fresh(void){ char* err = NULL; AdaScriptVM* vm = AdaScript_Create(".");
+    AdaScript_RegisterNativeFn(vm, "scale", 1, scale, &g_factor);
+    if(AdaScript_Eval(vm, kSetup, NULL, &err) != 0){ fprintf(stderr, "setup: %s\n", err); exit(1); } return vm; }
+
+// One request: handle(id, 3), which also grows the VM's own 'seen' list and LRU cache
+static double request(AdaScriptVM* vm, int id){ char* err = NULL; AdaScript_PushNumber(vm, id); AdaScript_PushNumber(vm, 3);
+    if(AdaScript_CallTyped(vm, "handle", 2, &err) != 0){ fprintf(stderr, "handle: %s\n", err); exit(1); }
+    double r = AdaScript_ToNumber(vm, -1); AdaScript_Pop(vm, 1); return r; }
+
+static AdaScriptSnapshot* g_snap;
+static int g_requests = 20000;
+struct Job { double sum; };
+static void* worker(void* arg){ struct Job* job = (struct Job*)arg; job->sum = 0;
+    for(int i = 0; i < g_requests; ++i){ AdaScriptVM* vm = AdaScript_CreateFromSnapshot(g_snap); job->sum += request(vm, i); AdaScript_Destroy(vm); }
+    return NULL; }
+
+int main(int argc, char** argv){
+    int threads = argc > 1? atoi(argv[1]) : 4; if(threads < 1) threads = 1;
+    const int n = 200;
+    double t = now(), a = 0;
+    for(int i = 0; i < n; ++i){ AdaScriptVM* vm = fresh(); a += request(vm, i); AdaScript_Destroy(vm); }
+    double scratch = (now() - t) / n;
+
+    char* err = NULL; AdaScriptVM* base = fresh();
+    g_snap = AdaScript_Snapshot(base, &err); if(!g_snap){ fprintf(stderr, "snapshot: %s\n", err); return 1; }
+    AdaScript_Destroy(base); // the snapshot does not depend on the VM it was taken from
+    t = now();
+    for(int i = 0; i < n * 100; ++i) AdaScript_Destroy(AdaScript_CreateFromSnapshot(g_snap));
+    double create = (now() - t) / (n * 100);
+    t = now(); double b = 0;
+    for(int i = 0; i < n; ++i){ AdaScriptVM* vm = AdaScript_CreateFromSnapshot(g_snap); b += request(vm, i); AdaScript_Destroy(vm); }
+    double snap = (now() - t) / n;
+    printf("create + setup + request:      %8.1f us\n", scratch * 1e6);
+    printf("create from snapshot:          %8.1f us\n", create * 1e6);
+    printf("create from snapshot + request:%8.1f us  (results %s)\n", snap * 1e6, a == b? "match" : "DIFFER");
+
+    // isolation: a second request on one VM sees its own earlier write, a new VM does not
+    AdaScriptVM* x = AdaScript_CreateFromSnapshot(g_snap); AdaScriptVM* y = AdaScript_CreateFromSnapshot(g_snap);
+    double x1 = request(x, 7), x2 = request(x, 7), y1 = request(y, 7);
+    printf("isolation: %s\n", x1 == y1 && x2 == x1 + 1? "ok" : "FAILED");
+    AdaScript_Destroy(x); AdaScript_Destroy(y);
+
+    struct Job* jobs = (struct Job*)calloc((size_t)threads, sizeof *jobs); pthread_t* tids = (pthread_t*)calloc((size_t)threads, sizeof *tids);
+    g_requests = 2000; struct Job expect; worker(&expect); t = now();
+    for(int i = 0; i < threads; ++i) pthread_create(&tids[i], NULL, worker, &jobs[i]);
+    int bad = 0; for(int i = 0; i < threads; ++i){ pthread_join(tids[i], NULL); if(jobs[i].sum != expect.sum) bad++; }
+    printf("%d threads x %d VMs from one snapshot: %.0f ms, %d mismatches\n", threads, g_requests, (now() - t) * 1e3, bad);
+    AdaScript_FreeSnapshot(g_snap); free(jobs); free(tids);
+    return bad || a != b? 1 : 0;
+}
@@ -0,0 +1,77 @@
+/*
+Stress test: N VMs on N threads. Every thread creates its own VM (alternating the tree and bytecode engines), imports
+builtins/libs (one shared module image), runs one shared precompiled program, calls into scripts through the typed
+API, and is called back through a native function. Results are checked against a single-threaded run.
+Build against the shared library and run from the repository root:
+     cc -O2 -Iinclude examples/stress_vms.c -Lbuild -ladascript_core -lpthread -o stress_vms
+     LD_LIBRARY_PATH=build ./stress_vms [threads] [iterations]
+*/
+#include "AdaScript.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static const char* kSetup =
+    "import \"builtins/libs\";\n"
+    "class Acc { func init(n) { this.n = n; } func add(x) { this.n = this.n + x; return this.n; } }\n"
+    "let rounds = 0;\n"
+    "func work(xs, seed) {\n"
+    "  let a = Acc(seed); let s = Stack(); let c = LRUCache(4);\n"
+    "  for (x in xs) { a.add(host_add(x, gcd(12, 18))); s.push(x); c.put(str(x % 5), x); }\n"
+    "  let back = json.parse(json.stringify({\"sum\": a.n, \"sorted\": sorted(xs), \"top\": s.pop()}));\n"
+    "  let cycle = []; cycle[0] = cycle;\n"
+    "  return back.sum + back.sorted[0] + back.top + c.size() + rounds;\n"
+    "}\n";
+static const char* kRule = "rounds = rounds + len(\"x\");\n";
+
+static AdaScriptProgram* g_rule;
+static int g_iterations = 200;
+
+static int host_add(AdaScriptVM* vm, void* user, int argc){
+    (void)user; (void)argc; AdaScript_PushNumber(vm, AdaScript_ToNumber(vm, 0) + AdaScript_ToNumber(vm, 1)); return 1; }
+
+struct Job { int engine; double result; int failed; };
+
+static void* run(void* arg){
+    struct Job* job = (struct Job*)arg; char* err = NULL; job->result = 0; job->failed = 1;
+    AdaScriptVM* vm = AdaScript_Create("."); if(!vm) return NULL;
+    AdaScript_SetEngine(vm, job->engine);
+    AdaScript_RegisterNativeFn(vm, "host_add", 2, host_add, NULL);
+    if(AdaScript_Eval(vm, kSetup, NULL, &err) != 0){ fprintf(stderr, "setup: %s\n", err); AdaScript_FreeString(err); AdaScript_Destroy(vm); return NULL; }
+    AdaScriptValue* work = AdaScript_GetFunction(vm, "work");
+    for(int i = 0; i < g_iterations; ++i){
+        if(AdaScript_Execute(vm, g_rule, &err) != 0){ fprintf(stderr, "rule: %s\n", err); AdaScript_FreeString(err); goto done; }
+        AdaScript_NewList(vm, 50); for(int k = 0; k < 50; ++k){ AdaScript_PushNumber(vm, (k * 7 + i) % 50); AdaScript_ListAppend(vm, -2); }
+        AdaScript_PushNumber(vm, i);
+        if(AdaScript_CallHandle(vm, work, 2, &err) != 0){ fprintf(stderr, "work: %s\n", err); AdaScript_FreeString(err); goto done; }
+        job->result += AdaScript_ToNumber(vm, -1); AdaScript_Pop(vm, 1);
+    }
+    job->failed = 0;
+done:
+    AdaScript_Release(work);
+    AdaScript_Destroy(vm);
+    return NULL;
+}
+
+int main(int argc, char** argv){
+    int threads = argc > 1? atoi(argv[1]) : 8; if(threads < 1) threads = 1;
+    if(argc > 2) g_iterations = atoi(argv[2]);
+    char* err = NULL; g_rule = AdaScript_Compile(kRule, NULL, &err);
+    if(!g_rule){ fprintf(stderr, "compile: %s\n", err); return 1; }
+
+    // reference results, one VM per engine on this thread
+    struct Job expect[2] = {{0, 0, 0}, {1, 0, 0}}; run(&expect[0]); run(&expect[1]);
+    if(expect[0].failed || expect[1].failed || expect[0].result != expect[1].result){ fprintf(stderr, "reference run failed\n"); return 1; }
+
+    struct Job* jobs = (struct Job*)calloc((size_t)threads, sizeof *jobs); pthread_t* tids = (pthread_t*)calloc((size_t)threads, sizeof *tids);
+    struct timespec t0, t1; clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(int i = 0; i < threads; ++i){ jobs[i].engine = i % 2; pthread_create(&tids[i], NULL, run, &jobs[i]); }
+    int bad = 0;
+    for(int i = 0; i < threads; ++i){ pthread_join(tids[i], NULL); if(jobs[i].failed || jobs[i].result != expect[0].result) bad++; }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("%d VMs x %d iterations: %d mismatches, %.0f ms (expected %.0f)\n", threads, g_iterations, bad,
+           (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6, expect[0].result);
+    AdaScript_FreeProgram(g_rule); free(jobs); free(tids);
+    return bad? 1 : 0;
+}
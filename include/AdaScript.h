@@ -1,71 +1,187 @@
-/*
-AdaScript
-(C) 2025 Afif Ali Saadman, Chief Author of AdaScript
-License: LGPL
-*/
-#ifndef ADASCRIPT_H
-#define ADASCRIPT_H
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-// Export macro
-#if defined(_WIN32)
-  #if defined(ADASCRIPT_BUILD_DLL)
-    #define ADASCRIPT_API __declspec(dllexport)
-  #else
-    #define ADASCRIPT_API
-  #endif
-#else
-  #define ADASCRIPT_API
-#endif
-
-// Opaque VM handle
-typedef struct AdaScriptVM AdaScriptVM;
-
-// Create a VM. entry_dir may be NULL; if provided, it's used as the base for relative imports.
-ADASCRIPT_API AdaScriptVM* AdaScript_Create(const char* entry_dir);
-
-// Destroy a VM created with AdaScript_Create.
-ADASCRIPT_API void AdaScript_Destroy(AdaScriptVM* vm);
-
-// Evaluate source code. filename is optional and used for error messages; may be NULL.
-// Returns 0 on success, non-zero on error. On error, *error_message is set to a malloc-allocated string
-// that must be freed with AdaScript_FreeString.
-ADASCRIPT_API int AdaScript_Eval(AdaScriptVM* vm, const char* source, const char* filename, char** error_message);
-
-// Run a file from disk. Returns 0 on success; on error, sets *error_message similarly to Eval.
-ADASCRIPT_API int AdaScript_RunFile(AdaScriptVM* vm, const char* path, char** error_message);
-
-// Call a global function by name with string arguments.
-// - args: array of C strings of length argc. They will be passed to AdaScript as strings.
-// - On success, returns a malloc-allocated C string representation of the return value (using AdaScript str semantics),
-//   which must be freed with AdaScript_FreeString. On error, returns NULL and sets *error_message.
-ADASCRIPT_API char* AdaScript_Call(AdaScriptVM* vm, const char* func_name, const char* const* args, int argc, char** error_message);
-
-// Register a native function that receives C string arguments and returns a malloc-allocated C string.
-// The returned string will be freed by the VM after converting to an AdaScript string.
-// Your callback may use user_data to carry context; it must be thread-safe if you call from multiple threads.
-// Return value must be a malloc-allocated NUL-terminated string, or NULL to indicate error. If returning NULL,
-// you should also set an error string via an out-of-band mechanism if desired; the VM will return an empty string.
-typedef char* (*AdaScript_NativeStringFn)(void* user_data, const char* const* args, int argc);
-ADASCRIPT_API int AdaScript_RegisterNativeStringFn(AdaScriptVM* vm, const char* name, int arity, AdaScript_NativeStringFn fn, void* user_data);
-
-// Plugin API (for DLLs/SOs loaded by the AdaScript interpreter)
-// A plugin must export AdaScript_ModuleInit symbol with this signature.
-// The interpreter will call it with a registration function you can use to register
-// native string functions into the global scope.
-typedef void (*AdaScript_RegisterFn)(const char* name, int arity, AdaScript_NativeStringFn fn, void* user_data);
-typedef int (*AdaScript_ModuleInitFn)(AdaScript_RegisterFn reg, void* host_ctx);
-// Plugins should implement:
-//   ADASCRIPT_API int AdaScript_ModuleInit(AdaScript_RegisterFn reg, void* host_ctx);
-
-// Free strings returned by AdaScript_Call or provided in *error_message.
-ADASCRIPT_API void AdaScript_FreeString(char* s);
-
-#ifdef __cplusplus
-} // extern "C"
-#endif
-
-#endif // ADASCRIPT_H
+/*
+AdaScript
+(C) 2025 Afif Ali Saadman, Chief Author of AdaScript
+License: LGPL
+*/
+#ifndef ADASCRIPT_H
+#define ADASCRIPT_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Export macro
+#if defined(_WIN32)
+  #if defined(ADASCRIPT_BUILD_DLL)
+    #define ADASCRIPT_API __declspec(dllexport)
+  #else
+    #define ADASCRIPT_API
+  #endif
+#else
+  #define ADASCRIPT_API
+#endif
+
+// Opaque VM handle
+typedef struct AdaScriptVM AdaScriptVM;
+
+// Create a VM. entry_dir may be NULL; if provided, it's used as the base for relative imports.
+ADASCRIPT_API AdaScriptVM* AdaScript_Create(const char* entry_dir);
+
+// Destroy a VM created with AdaScript_Create.
+ADASCRIPT_API void AdaScript_Destroy(AdaScriptVM* vm);
+
+// Execution engines. The tree-walking interpreter is the default; the bytecode engine compiles each
+// program (and imported module) to bytecode and runs it on a dispatch-loop VM with the same semantics.
+#define ADASCRIPT_ENGINE_TREE 0
+#define ADASCRIPT_ENGINE_BYTECODE 1
+
+// Select the engine used by subsequent Eval/RunFile calls. Returns 0 on success, non-zero for an invalid vm or engine.
+ADASCRIPT_API int AdaScript_SetEngine(AdaScriptVM* vm, int engine);
+
+// Resource limits for untrusted scripts. A zero field means no limit. Operations are loop iterations and function
+// calls; heap bytes are the VM's estimated live strings, containers and objects, including values the host pushed
+// (a push never fails; the script's next allocation past the cap does). Operations, the timeout and
+// interrupts are checked every 1024 operations, so a limit trips a little late and a single long native call
+// (sleep, HTTP) is not interrupted. Counters restart with each top-level Eval, RunFile, Execute or call; a tripped
+// limit fails that run with a runtime error ("Operation limit exceeded", "Time limit exceeded", "Memory limit
+// exceeded", "Call depth limit exceeded" or "Interrupted") and leaves the VM usable. Without max_call_depth, calls
+// nested 2000 deep fail with "Stack overflow: calls nested too deeply" on both engines instead of crashing or
+// exhausting memory; the tree engine can raise it earlier if the native stack runs short. Passing NULL clears the limits.
+typedef struct AdaScriptLimits {
+    unsigned long long max_operations;
+    size_t max_heap_bytes;
+    int max_call_depth;
+    double timeout_seconds;
+} AdaScriptLimits;
+ADASCRIPT_API int AdaScript_SetLimits(AdaScriptVM* vm, const AdaScriptLimits* limits); // 0 on success
+// Stops the VM's current run at its next check, with the error "Interrupted". Safe to call from any thread while
+// the VM runs elsewhere, e.g. from a watchdog; it has no effect on runs started after it.
+ADASCRIPT_API void AdaScript_Interrupt(AdaScriptVM* vm);
+
+// Evaluate source code. filename is optional (may be NULL): a syntax error message then starts with "<filename>: ", and
+// its directory is the base for relative imports.
+// Returns 0 on success, non-zero on error. On error, *error_message is set to a malloc-allocated string
+// that must be freed with AdaScript_FreeString.
+ADASCRIPT_API int AdaScript_Eval(AdaScriptVM* vm, const char* source, const char* filename, char** error_message);
+
+// Precompiled programs: lex, parse and resolve source once, then run it many times. A program is not tied to a VM and
+// may be executed by several; with the bytecode engine it is also compiled to bytecode once, on its first execution.
+// AdaScript_Compile returns NULL on a syntax error and sets *error_message as Eval does, e.g.
+// "rules/r.ad: Expected ')' at line 1, col 8".
+typedef struct AdaScriptProgram AdaScriptProgram;
+ADASCRIPT_API AdaScriptProgram* AdaScript_Compile(const char* source, const char* filename, char** error_message);
+// Runs a program at global scope. Returns 0 on success; on a runtime error, returns non-zero and sets *error_message.
+ADASCRIPT_API int AdaScript_Execute(AdaScriptVM* vm, const AdaScriptProgram* program, char** error_message);
+ADASCRIPT_API void AdaScript_FreeProgram(AdaScriptProgram* program);
+
+// Snapshots: capture a VM's globals once it is set up (imports run, classes and functions defined, data loaded), then
+// create fresh VMs from it, e.g. one per request. A new VM starts with a private copy of the captured globals, so
+// changes made by one VM are never seen by another; strings, native functions and compiled code are shared rather
+// than copied. A snapshot may be used by VMs on any number of threads at once, and stays valid after the VM it was
+// taken from is destroyed. AdaScript_Snapshot returns NULL and sets *error_message when a global holds an object that
+// can't be copied (a file handle, memory map, CSV reader or JSON parser).
+typedef struct AdaScriptSnapshot AdaScriptSnapshot;
+ADASCRIPT_API AdaScriptSnapshot* AdaScript_Snapshot(AdaScriptVM* vm, char** error_message);
+ADASCRIPT_API AdaScriptVM* AdaScript_CreateFromSnapshot(const AdaScriptSnapshot* snapshot); // destroy with AdaScript_Destroy
+// VMs created from a snapshot keep what they share alive, so the snapshot may be freed while they still run.
+ADASCRIPT_API void AdaScript_FreeSnapshot(AdaScriptSnapshot* snapshot);
+
+// Run a file from disk. Returns 0 on success; on error, sets *error_message similarly to Eval.
+ADASCRIPT_API int AdaScript_RunFile(AdaScriptVM* vm, const char* path, char** error_message);
+
+// Call a global function by name with string arguments.
+// - args: array of C strings of length argc. They will be passed to AdaScript as strings.
+// - On success, returns a malloc-allocated C string representation of the return value (using AdaScript str semantics),
+//   which must be freed with AdaScript_FreeString. On error, returns NULL and sets *error_message.
+ADASCRIPT_API char* AdaScript_Call(AdaScriptVM* vm, const char* func_name, const char* const* args, int argc, char** error_message);
+
+// Register a native function that receives C string arguments and returns a malloc-allocated C string.
+// The returned string will be freed by the VM after converting to an AdaScript string.
+// Your callback may use user_data to carry context; it must be thread-safe if you call from multiple threads.
+// Return value must be a malloc-allocated NUL-terminated string, or NULL to indicate error. If returning NULL,
+// you should also set an error string via an out-of-band mechanism if desired; the VM will return an empty string.
+typedef char* (*AdaScript_NativeStringFn)(void* user_data, const char* const* args, int argc);
+ADASCRIPT_API int AdaScript_RegisterNativeStringFn(AdaScriptVM* vm, const char* name, int arity, AdaScript_NativeStringFn fn, void* user_data);
+
+// Typed value API. Values cross the boundary on a per-VM value stack instead of being formatted as strings: push
+// arguments, call, read the result and pop it. Index 0 is the bottom of the current frame and -1 is the top. Inside a
+// native callback, the frame starts at the callback's first argument. Functions taking an index return -1 (or NULL/0)
+// for an invalid index or a value of the wrong type.
+#define ADASCRIPT_TYPE_NULL 0
+#define ADASCRIPT_TYPE_BOOL 1
+#define ADASCRIPT_TYPE_NUMBER 2
+#define ADASCRIPT_TYPE_STRING 3
+#define ADASCRIPT_TYPE_LIST 4
+#define ADASCRIPT_TYPE_DICT 5
+#define ADASCRIPT_TYPE_FUNCTION 6 // script function, native function or class
+#define ADASCRIPT_TYPE_OBJECT 7   // class instance or native object
+
+ADASCRIPT_API int AdaScript_GetTop(AdaScriptVM* vm);          // number of values in the current frame
+ADASCRIPT_API void AdaScript_Pop(AdaScriptVM* vm, int n);     // removes the top n values (at most the whole frame)
+ADASCRIPT_API void AdaScript_PushNull(AdaScriptVM* vm);
+ADASCRIPT_API void AdaScript_PushBool(AdaScriptVM* vm, int b);
+ADASCRIPT_API void AdaScript_PushNumber(AdaScriptVM* vm, double n);
+ADASCRIPT_API void AdaScript_PushString(AdaScriptVM* vm, const char* s, size_t len); // s may contain NUL bytes
+
+ADASCRIPT_API int AdaScript_Type(AdaScriptVM* vm, int idx);       // ADASCRIPT_TYPE_*, or -1 for an invalid index
+ADASCRIPT_API double AdaScript_ToNumber(AdaScriptVM* vm, int idx); // 0 unless the value is a number
+ADASCRIPT_API int AdaScript_ToBool(AdaScriptVM* vm, int idx);      // AdaScript truthiness: 0 or 1
+// Returns the string's bytes (NUL-terminated) and stores its length in *len when len is not NULL. The pointer stays
+// valid while the value is on the stack or held by a handle. Returns NULL unless the value is a string.
+ADASCRIPT_API const char* AdaScript_ToString(AdaScriptVM* vm, int idx, size_t* len);
+
+// List and dict builders and accessors
+ADASCRIPT_API void AdaScript_NewList(AdaScriptVM* vm, size_t reserve);
+ADASCRIPT_API void AdaScript_NewDict(AdaScriptVM* vm);
+ADASCRIPT_API int AdaScript_ListAppend(AdaScriptVM* vm, int list_idx);                         // pops the top value and appends it
+ADASCRIPT_API int AdaScript_DictSet(AdaScriptVM* vm, int dict_idx, const char* key, size_t len); // pops the top value and stores it
+ADASCRIPT_API size_t AdaScript_Len(AdaScriptVM* vm, int idx);                                  // length of a list, dict or string
+ADASCRIPT_API int AdaScript_ListGet(AdaScriptVM* vm, int list_idx, size_t i);                  // pushes item i, returns its type
+ADASCRIPT_API int AdaScript_DictGet(AdaScriptVM* vm, int dict_idx, const char* key, size_t len); // pushes the value, returns its type (-1 and no push if absent)
+ADASCRIPT_API int AdaScript_DictKeys(AdaScriptVM* vm, int dict_idx);                           // pushes a list of the keys
+
+// Calls a global callable by name with the top argc values as arguments. They are popped and replaced by the result.
+// Returns 0 on success. On error, the arguments are popped, nothing is pushed and *error_message is set as in Eval.
+ADASCRIPT_API int AdaScript_CallTyped(AdaScriptVM* vm, const char* func_name, int argc, char** error_message);
+
+// Value handles keep a value alive off the stack, e.g. a list built once and passed to many calls. A handle belongs to
+// the VM it came from: release it with AdaScript_Release on the thread that uses that VM. Destroying the VM drops the
+// values of handles not yet released; such a handle, or one passed to another VM, pushes null and fails to call, and
+// must still be released.
+typedef struct AdaScriptValue AdaScriptValue;
+ADASCRIPT_API AdaScriptValue* AdaScript_Ref(AdaScriptVM* vm, int idx); // new handle to the value at idx (not popped)
+ADASCRIPT_API void AdaScript_PushRef(AdaScriptVM* vm, const AdaScriptValue* value);
+ADASCRIPT_API void AdaScript_Release(AdaScriptValue* value);
+
+// Looks up a global callable once and returns a handle to it (release with AdaScript_Release), or NULL if the name is
+// undefined or not callable. The handle keeps calling the function it found, even if the global is later reassigned.
+ADASCRIPT_API AdaScriptValue* AdaScript_GetFunction(AdaScriptVM* vm, const char* func_name);
+// Calls a function handle (from AdaScript_GetFunction or AdaScript_Ref) with the top argc values, like AdaScript_CallTyped.
+ADASCRIPT_API int AdaScript_CallHandle(AdaScriptVM* vm, const AdaScriptValue* fn, int argc, char** error_message);
+
+// Typed native callback. The arguments are at indices 0..argc-1 of the callback's frame. Return 1 after pushing the
+// result, 0 to return null, or -1 to raise an error (with the message passed to AdaScript_SetError, if any). The
+// callback may push values, build containers and call back into scripts; its frame is dropped when it returns.
+typedef int (*AdaScript_NativeFn)(AdaScriptVM* vm, void* user_data, int argc);
+ADASCRIPT_API int AdaScript_RegisterNativeFn(AdaScriptVM* vm, const char* name, int arity, AdaScript_NativeFn fn, void* user_data);
+ADASCRIPT_API void AdaScript_SetError(AdaScriptVM* vm, const char* message);
+
+// Plugin API (for DLLs/SOs loaded by the AdaScript interpreter)
+// A plugin must export AdaScript_ModuleInit symbol with this signature.
+// The interpreter will call it with a registration function you can use to register
+// native string functions into the global scope.
+typedef void (*AdaScript_RegisterFn)(const char* name, int arity, AdaScript_NativeStringFn fn, void* user_data);
+typedef int (*AdaScript_ModuleInitFn)(AdaScript_RegisterFn reg, void* host_ctx);
+// Plugins should implement:
+//   ADASCRIPT_API int AdaScript_ModuleInit(AdaScript_RegisterFn reg, void* host_ctx);
+
+// Free strings returned by AdaScript_Call or provided in *error_message.
+ADASCRIPT_API void AdaScript_FreeString(char* s);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // ADASCRIPT_H
@@ -1,1159 +1,3774 @@
-/*
-AdaScript
-(C) 2025 Afif Ali Saadman, Chief Author of AdaScript
-License: LGPL
-*/
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <string>
-#include <vector>
-#include <unordered_map>
-#include <variant>
-#include <memory>
-#include <optional>
-#include <functional>
-#include <cctype>
-#include <cmath>
-#include <filesystem>
-#include <unordered_set>
-#include <cstring>
-#include <cstdlib>
-#include <cstdio>
-#include <chrono>
-#ifndef _WIN32
-#include <unistd.h>
-#endif
-#ifndef _WIN32
-  #ifndef ADASCRIPT_NO_CURL
-    #include <curl/curl.h>
-    #include <mutex>
-    // File-scope libcurl write callback (C signature)
-    struct CurlBuf { std::string s; };
-    static size_t curl_write_cb(char* ptr, size_t size, size_t nmemb, void* userdata){
-        CurlBuf* b = reinterpret_cast<CurlBuf*>(userdata);
-        if(!b || !ptr) return 0;
-        size_t total = size * nmemb;
-        b->s.append(ptr, total);
-        return total;
-    }
-  #endif
-#endif
-#include "AdaScript.h"
-
-// Forward declarations
-struct Value;
-struct Environment;
-struct Expr;
-struct Stmt;
-class Interpreter;
-
-using Ptr = std::shared_ptr<void>;
-
-// Value type
-using List = std::vector<Value>;
-using Dict = std::unordered_map<std::string, Value>;
-
-struct Function; // user-defined
-struct NativeFunction; // builtin
-struct Class;
-struct Instance;
-
-using ValueData = std::variant<std::monostate, bool, double, std::string, List, Dict,
-                               std::shared_ptr<Function>, std::shared_ptr<NativeFunction>,
-                               std::shared_ptr<Class>, std::shared_ptr<Instance>>;
-
-struct Value {
-    ValueData data;
-
-    Value() : data(std::monostate{}) {}
-    template<typename T>
-    Value(T v) : data(std::move(v)) {}
-
-    bool isNull() const { return std::holds_alternative<std::monostate>(data); }
-    std::string typeName() const {
-        if (std::holds_alternative<std::monostate>(data)) return "null";
-        if (std::holds_alternative<bool>(data)) return "bool";
-        if (std::holds_alternative<double>(data)) return "number";
-        if (std::holds_alternative<std::string>(data)) return "string";
-        if (std::holds_alternative<List>(data)) return "list";
-        if (std::holds_alternative<Dict>(data)) return "dict";
-        if (std::holds_alternative<std::shared_ptr<Function>>(data)) return "function";
-        if (std::holds_alternative<std::shared_ptr<NativeFunction>>(data)) return "native";
-        if (std::holds_alternative<std::shared_ptr<Class>>(data)) return "class";
-        if (std::holds_alternative<std::shared_ptr<Instance>>(data)) return "instance";
-        return "unknown";
-    }
-};
-
-struct RuntimeError : std::runtime_error {
-    using std::runtime_error::runtime_error;
-};
-
-// Lexer
-enum class TokenType {
-    // Single-char
-    LEFT_PAREN, RIGHT_PAREN, LEFT_BRACE, RIGHT_BRACE,
-    LEFT_BRACKET, RIGHT_BRACKET,
-    COMMA, DOT, SEMICOLON, COLON,
-    PLUS, MINUS, STAR, SLASH, PERCENT,
-    BANG, EQUAL, LESS, GREATER,
-
-    // Two-char
-    BANG_EQUAL, EQUAL_EQUAL, LESS_EQUAL, GREATER_EQUAL,
-    AND_AND, OR_OR,
-
-    // Literals
-    IDENTIFIER, STRING, NUMBER,
-
-    // Keywords
-    LET, FUNC, CLASS, RETURN, IF, ELSE, WHILE, FOR, TRUE, FALSE, NULL_T,
-    THIS, STRUCT, UNION, NEW, IMPORT, IN,
-    // Textual operators
-    NOT_KW, AND_KW, OR_KW, EQUALS_KW,
-
-    END_OF_FILE
-};
-
-struct Token { TokenType type; std::string lexeme; int line; int col; };
-
-struct Lexer {
-    std::string src; size_t start=0, current=0; int line=1, col=1;
-    std::vector<Token> tokens;
-
-    explicit Lexer(std::string s): src(std::move(s)) {}
-
-    static bool isAlpha(char c){return std::isalpha((unsigned char)c)||c=='_';}
-    static bool isAlnum(char c){return isAlpha(c)||std::isdigit((unsigned char)c);}    
-    bool isAtEnd() const { return current >= src.size(); }
-    char advance(){ char c=src[current++]; if(c=='\n'){line++; col=1;} else col++; return c;}
-    bool match(char expected){ if(isAtEnd()||src[current]!=expected) return false; current++; col++; return true; }
-    char peek() const { return isAtEnd()? '\0': src[current];}
-    char peekNext() const { return (current+1>=src.size())? '\0': src[current+1];}
-    void add(TokenType t){ tokens.push_back({t, src.substr(start, current-start), line, col}); }
-
-    void string(){ while(!isAtEnd() && peek()!='"'){ advance(); }
-        if(isAtEnd()) throw RuntimeError("Unterminated string"); advance(); // closing quote
-        std::string value = src.substr(start+1, (current-1)-(start+1));
-        tokens.push_back({TokenType::STRING, value, line, col}); }
-    void number(){ while(std::isdigit((unsigned char)peek())) advance(); if(peek()=='.' && std::isdigit((unsigned char)peekNext())){ advance(); while(std::isdigit((unsigned char)peek())) advance(); }
-        tokens.push_back({TokenType::NUMBER, src.substr(start, current-start), line, col}); }
-void identifier(){ while(isAlnum(peek())) advance(); std::string text = src.substr(start, current-start);
-        static std::unordered_map<std::string, TokenType> kw = {
-            {"let",TokenType::LET},{"func",TokenType::FUNC},{"class",TokenType::CLASS},{"return",TokenType::RETURN},
-            {"if",TokenType::IF},{"else",TokenType::ELSE},{"while",TokenType::WHILE},{"for",TokenType::FOR},
-            {"true",TokenType::TRUE},{"false",TokenType::FALSE},{"null",TokenType::NULL_T},{"this",TokenType::THIS},
-            {"struct",TokenType::STRUCT},{"union",TokenType::UNION},{"new",TokenType::NEW},
-            {"import",TokenType::IMPORT},{"in",TokenType::IN},
-            // textual operators mapped to dedicated token types
-            {"not",TokenType::NOT_KW},{"and",TokenType::AND_KW},{"or",TokenType::OR_KW},{"equals",TokenType::EQUALS_KW}
-        };
-        auto it=kw.find(text); if(it!=kw.end()) tokens.push_back({it->second,text,line,col}); else tokens.push_back({TokenType::IDENTIFIER,text,line,col}); }
-
-    std::vector<Token> scan(){
-        while(!isAtEnd()){
-            start=current; char c=advance();
-            switch(c){
-                case '(': add(TokenType::LEFT_PAREN); break;
-                case ')': add(TokenType::RIGHT_PAREN); break;
-                case '{': add(TokenType::LEFT_BRACE); break;
-                case '}': add(TokenType::RIGHT_BRACE); break;
-                case '[': add(TokenType::LEFT_BRACKET); break;
-                case ']': add(TokenType::RIGHT_BRACKET); break;
-                case ',': add(TokenType::COMMA); break;
-                case '.': add(TokenType::DOT); break;
-                case ';': add(TokenType::SEMICOLON); break;
-                case ':': add(TokenType::COLON); break;
-                case '+': add(TokenType::PLUS); break;
-                case '-': add(TokenType::MINUS); break;
-                case '*': add(TokenType::STAR); break;
-                case '%': add(TokenType::PERCENT); break;
-                case '!': add(match('=')?TokenType::BANG_EQUAL:TokenType::BANG); break;
-                case '=': add(match('=')?TokenType::EQUAL_EQUAL:TokenType::EQUAL); break;
-                case '<': add(match('=')?TokenType::LESS_EQUAL:TokenType::LESS); break;
-                case '>': add(match('=')?TokenType::GREATER_EQUAL:TokenType::GREATER); break;
-                case '/': if(match('/')){ while(peek()!='\n' && !isAtEnd()) advance(); } else add(TokenType::SLASH); break;
-                case '&': if(match('&')) add(TokenType::AND_AND); else throw RuntimeError("Unexpected '&'"); break;
-                case '|': if(match('|')) add(TokenType::OR_OR); else throw RuntimeError("Unexpected '|'"); break;
-                case ' ': case '\r': case '\t': /* skip */ break;
-                case '\n': /* handled in advance */ break;
-                case '"': string(); break;
-                default:
-                    if(std::isdigit((unsigned char)c)) number();
-                    else if(isAlpha(c)) identifier();
-                    else throw RuntimeError("Unexpected character");
-            }
-        }
-        tokens.push_back({TokenType::END_OF_FILE, "", line, col});
-        return tokens;
-    }
-};
-
-// AST definitions (minimal)
-struct Expr { virtual ~Expr()=default; };
-struct Stmt { virtual ~Stmt()=default; };
-using ExprPtr = std::shared_ptr<Expr>;
-using StmtPtr = std::shared_ptr<Stmt>;
-
-struct LiteralExpr : Expr { Value value; explicit LiteralExpr(Value v): value(std::move(v)){} };
-struct VarExpr : Expr { std::string name; explicit VarExpr(std::string n): name(std::move(n)){} };
-struct AssignExpr : Expr { std::string name; ExprPtr value; AssignExpr(std::string n, ExprPtr v): name(std::move(n)), value(std::move(v)){} };
-struct BinaryExpr : Expr { ExprPtr left; Token op; ExprPtr right; BinaryExpr(ExprPtr l, Token o, ExprPtr r): left(std::move(l)), op(std::move(o)), right(std::move(r)){} };
-struct UnaryExpr : Expr { Token op; ExprPtr right; UnaryExpr(Token o, ExprPtr r): op(std::move(o)), right(std::move(r)){} };
-struct GroupingExpr : Expr { ExprPtr expr; explicit GroupingExpr(ExprPtr e): expr(std::move(e)){} };
-struct CallExpr : Expr { ExprPtr callee; std::vector<ExprPtr> args; CallExpr(ExprPtr c, std::vector<ExprPtr>a): callee(std::move(c)), args(std::move(a)){} };
-struct GetExpr : Expr { ExprPtr object; std::string name; GetExpr(ExprPtr o, std::string n): object(std::move(o)), name(std::move(n)){} };
-struct SetExpr : Expr { ExprPtr object; std::string name; ExprPtr value; SetExpr(ExprPtr o,std::string n,ExprPtr v):object(std::move(o)),name(std::move(n)),value(std::move(v)){} };
-struct IndexExpr : Expr { ExprPtr object; ExprPtr index; IndexExpr(ExprPtr o, ExprPtr i): object(std::move(o)), index(std::move(i)){} };
-struct SetIndexExpr : Expr { ExprPtr object; ExprPtr index; ExprPtr value; SetIndexExpr(ExprPtr o, ExprPtr i, ExprPtr v): object(std::move(o)), index(std::move(i)), value(std::move(v)){} };
-
-struct ExprStmt : Stmt { ExprPtr expr; explicit ExprStmt(ExprPtr e): expr(std::move(e)){} };
-struct LetStmt : Stmt { std::string name; ExprPtr initializer; LetStmt(std::string n, ExprPtr i): name(std::move(n)), initializer(std::move(i)){} };
-struct BlockStmt : Stmt { std::vector<StmtPtr> stmts; explicit BlockStmt(std::vector<StmtPtr> s): stmts(std::move(s)){} };
-struct IfStmt : Stmt { ExprPtr cond; StmtPtr thenB; std::optional<StmtPtr> elseB; IfStmt(ExprPtr c, StmtPtr t, std::optional<StmtPtr> e): cond(std::move(c)), thenB(std::move(t)), elseB(std::move(e)){} };
-struct WhileStmt : Stmt { ExprPtr cond; StmtPtr body; WhileStmt(ExprPtr c, StmtPtr b): cond(std::move(c)), body(std::move(b)){} };
-struct ReturnStmt : Stmt { std::optional<ExprPtr> value; explicit ReturnStmt(std::optional<ExprPtr> v): value(std::move(v)){} };
-
-struct FunctionStmt : Stmt { std::string name; std::vector<std::string> params; std::shared_ptr<BlockStmt> body; };
-struct ClassStmt : Stmt { std::string name; std::unordered_map<std::string, std::shared_ptr<FunctionStmt>> methods; };
-struct StructStmt : Stmt { std::string name; std::vector<std::string> fields; };
-struct UnionStmt : Stmt { std::string name; std::vector<std::string> tags; };
-struct ForStmt : Stmt { std::string var; ExprPtr iterable; StmtPtr body; ForStmt(std::string v, ExprPtr it, StmtPtr b): var(std::move(v)), iterable(std::move(it)), body(std::move(b)){} };
-struct ImportStmt : Stmt { std::string path; explicit ImportStmt(std::string p): path(std::move(p)){} };
-struct MultiAssignStmt : Stmt { std::vector<std::string> names; ExprPtr value; MultiAssignStmt(std::vector<std::string> n, ExprPtr v): names(std::move(n)), value(std::move(v)){} };
-struct MultiLetStmt : Stmt { std::vector<std::string> names; explicit MultiLetStmt(std::vector<std::string> n): names(std::move(n)){} };
-
-// Parser (simplified)
-struct Parser {
-    const std::vector<Token>& tokens; size_t current=0;
-    explicit Parser(const std::vector<Token>& ts): tokens(ts) {}
-
-    bool isAtEnd() const { return peek().type==TokenType::END_OF_FILE; }
-    const Token& peek() const { return tokens[current]; }
-    const Token& previous() const { return tokens[current-1]; }
-    bool check(TokenType t) const { return !isAtEnd() && peek().type==t; }
-    const Token& advance(){ if(!isAtEnd()) current++; return previous(); }
-    bool match(std::initializer_list<TokenType> types){ for(auto t: types){ if(check(t)){ advance(); return true; } } return false; }
-const Token& consume(TokenType t, const char* msg){ if(check(t)) return advance();
-        std::ostringstream emsg; emsg<<msg<<" at line "<<peek().line<<", col "<<peek().col; throw RuntimeError(emsg.str()); }
-
-    std::vector<StmtPtr> parse(){ std::vector<StmtPtr> stmts; while(!isAtEnd()) stmts.push_back(declaration()); return stmts; }
-
-    StmtPtr declaration(){
-        if(match({TokenType::LET})) return letDecl();
-        if(match({TokenType::FUNC})) return funcDecl();
-        if(match({TokenType::CLASS})) return classDecl();
-        if(match({TokenType::STRUCT})) return structDecl();
-        if(match({TokenType::UNION})) return unionDecl();
-        if(match({TokenType::IMPORT})) return importStmt();
-        return statement();
-    }
-
-    StmtPtr letDecl(){
-        // Support: let a;  let a = expr;  let a,b,c = expr;
-        std::vector<std::string> names;
-        names.push_back(consume(TokenType::IDENTIFIER, "Expected variable name").lexeme);
-        while(match({TokenType::COMMA})){
-            names.push_back(consume(TokenType::IDENTIFIER, "Expected variable name").lexeme);
-        }
-        if(match({TokenType::EQUAL})){
-            auto init = expression();
-            consume(TokenType::SEMICOLON, "Expected ';'");
-            if(names.size()==1) return std::make_shared<LetStmt>(names[0], init);
-            return std::make_shared<MultiAssignStmt>(std::move(names), init);
-        }
-        // No initializer -> define as null
-        consume(TokenType::SEMICOLON, "Expected ';'");
-        if(names.size()==1) return std::make_shared<LetStmt>(names[0], std::make_shared<LiteralExpr>(Value()));
-        return std::make_shared<MultiLetStmt>(std::move(names));
-    }
-
-    std::shared_ptr<FunctionStmt> functionBody(std::string name){
-        consume(TokenType::LEFT_PAREN, "Expected '('"); std::vector<std::string> params; if(!check(TokenType::RIGHT_PAREN)){ do{ params.push_back(consume(TokenType::IDENTIFIER, "Expected parameter name").lexeme);} while(match({TokenType::COMMA})); }
-        consume(TokenType::RIGHT_PAREN, "Expected ')'");
-        auto body = block();
-        auto f = std::make_shared<FunctionStmt>(); f->name = std::move(name); f->params = std::move(params); f->body = body; return f;
-    }
-
-    StmtPtr funcDecl(){ auto name = consume(TokenType::IDENTIFIER, "Expected function name").lexeme; auto f = functionBody(name); return std::static_pointer_cast<Stmt>(f); }
-
-    StmtPtr classDecl(){ auto name = consume(TokenType::IDENTIFIER, "Expected class name").lexeme; consume(TokenType::LEFT_BRACE, "Expected '{'"); std::unordered_map<std::string, std::shared_ptr<FunctionStmt>> methods; while(!check(TokenType::RIGHT_BRACE)){
-            consume(TokenType::FUNC, "Expected method"); auto mname = consume(TokenType::IDENTIFIER, "Expected method name").lexeme; auto m = functionBody(mname); methods[mname]=m; }
-        consume(TokenType::RIGHT_BRACE, "Expected '}'"); auto cls = std::make_shared<ClassStmt>(); cls->name = name; cls->methods = std::move(methods); return cls; }
-
-    StmtPtr structDecl(){ auto name = consume(TokenType::IDENTIFIER, "Expected struct name").lexeme; consume(TokenType::LEFT_BRACE, "Expected '{'"); std::vector<std::string> fields; while(!check(TokenType::RIGHT_BRACE)){
-            fields.push_back(consume(TokenType::IDENTIFIER, "Expected field name").lexeme); consume(TokenType::SEMICOLON, "Expected ';' after field"); }
-        consume(TokenType::RIGHT_BRACE, "Expected '}'"); auto st = std::make_shared<StructStmt>(); st->name = name; st->fields = std::move(fields); return st; }
-
-    StmtPtr unionDecl(){ auto name = consume(TokenType::IDENTIFIER, "Expected union name").lexeme; consume(TokenType::LEFT_BRACE, "Expected '{'"); std::vector<std::string> tags; while(!check(TokenType::RIGHT_BRACE)){
-            tags.push_back(consume(TokenType::IDENTIFIER, "Expected tag name").lexeme); consume(TokenType::SEMICOLON, "Expected ';' after tag"); }
-        consume(TokenType::RIGHT_BRACE, "Expected '}'"); auto un = std::make_shared<UnionStmt>(); un->name = name; un->tags = std::move(tags); return un; }
-
-StmtPtr statement(){
-        if(match({TokenType::IF})) return ifStmt();
-        if(match({TokenType::WHILE})) return whileStmt();
-        if(match({TokenType::FOR})) return forStmt();
-        if(match({TokenType::LEFT_BRACE})) return block();
-        if(match({TokenType::RETURN})){
-            std::optional<ExprPtr> val;
-            if(!check(TokenType::SEMICOLON)) val = expression();
-            consume(TokenType::SEMICOLON, "Expected ';'");
-            return std::make_shared<ReturnStmt>(val);
-        }
-        // Multi-assign like: a, b, c = expr;
-        if(check(TokenType::IDENTIFIER)){
-            size_t save = current;
-            std::vector<std::string> names;
-            names.push_back(advance().lexeme);
-            if(check(TokenType::COMMA)){
-                while(match({TokenType::COMMA})){
-                    names.push_back(consume(TokenType::IDENTIFIER, "Expected identifier in multi-assign").lexeme);
-                }
-                consume(TokenType::EQUAL, "Expected '=' in multi-assign");
-                auto rhs = expression();
-                consume(TokenType::SEMICOLON, "Expected ';'");
-                return std::make_shared<MultiAssignStmt>(std::move(names), rhs);
-            }
-            current = save; // rollback if not actually a multi-assign
-        }
-        auto e = expression(); consume(TokenType::SEMICOLON, "Expected ';'"); return std::make_shared<ExprStmt>(e);
-    }
-
-    std::shared_ptr<BlockStmt> block(){
-        if(previous().type!=TokenType::LEFT_BRACE) consume(TokenType::LEFT_BRACE, "Expected '{'");
-        std::vector<StmtPtr> stmts; while(!check(TokenType::RIGHT_BRACE)) stmts.push_back(declaration());
-        consume(TokenType::RIGHT_BRACE, "Expected '}'"); return std::make_shared<BlockStmt>(std::move(stmts));
-    }
-
-    StmtPtr ifStmt(){ consume(TokenType::LEFT_PAREN, "Expected '('"); auto cond = expression(); consume(TokenType::RIGHT_PAREN, "Expected ')'"); auto thenB = statement(); std::optional<StmtPtr> elseB; if(match({TokenType::ELSE})) elseB = statement(); return std::make_shared<IfStmt>(cond, thenB, elseB); }
-    StmtPtr whileStmt(){ consume(TokenType::LEFT_PAREN, "Expected '('"); auto cond = expression(); consume(TokenType::RIGHT_PAREN, "Expected ')'"); auto body = statement(); return std::make_shared<WhileStmt>(cond, body); }
-    StmtPtr forStmt(){ consume(TokenType::LEFT_PAREN, "Expected '('"); auto nameTok = consume(TokenType::IDENTIFIER, "Expected loop variable"); consume(TokenType::IN, "Expected 'in'"); auto iter = expression(); consume(TokenType::RIGHT_PAREN, "Expected ')'"); auto body = statement(); return std::make_shared<ForStmt>(nameTok.lexeme, iter, body); }
-    StmtPtr importStmt(){
-        // Support: import "path"; or import builtins/some_lib.ad;
-        if(check(TokenType::STRING)){
-            auto pathTok = advance();
-            consume(TokenType::SEMICOLON, "Expected ';'");
-            return std::make_shared<ImportStmt>(pathTok.lexeme);
-        }
-        // Parse bare path segments: IDENT ('/' IDENT)* ('.' IDENT)?
-        std::ostringstream p;
-        bool first = true;
-        p << consume(TokenType::IDENTIFIER, "Expected path after import").lexeme;
-        while(match({TokenType::SLASH})){
-            p << '/';
-            p << consume(TokenType::IDENTIFIER, "Expected identifier after '/'").lexeme;
-        }
-        if(match({TokenType::DOT})){
-            p << '.';
-            p << consume(TokenType::IDENTIFIER, "Expected extension after '.'").lexeme;
-        }
-        consume(TokenType::SEMICOLON, "Expected ';'");
-        return std::make_shared<ImportStmt>(p.str());
-    }
-
-    ExprPtr expression(){ return assignment(); }
-
-    ExprPtr assignment(){ auto expr = orExpr(); if(match({TokenType::EQUAL})){
-            auto equals = previous(); auto value = assignment(); if(auto v = std::dynamic_pointer_cast<VarExpr>(expr)) return std::make_shared<AssignExpr>(v->name, value);
-            if(auto g = std::dynamic_pointer_cast<GetExpr>(expr)) return std::make_shared<SetExpr>(g->object, g->name, value);
-            if(auto ix = std::dynamic_pointer_cast<IndexExpr>(expr)) return std::make_shared<SetIndexExpr>(ix->object, ix->index, value);
-            throw RuntimeError("Invalid assignment target"); }
-        return expr; }
-
-ExprPtr orExpr(){ auto expr = andExpr(); while(match({TokenType::OR_OR, TokenType::OR_KW})){
-            Token op = previous(); if(op.type==TokenType::OR_KW){ Token norm = op; norm.type = TokenType::OR_OR; op = norm; }
-            auto right = andExpr(); expr = std::make_shared<BinaryExpr>(expr, op, right); }
-        return expr; }
-ExprPtr andExpr(){ auto expr = equality(); while(match({TokenType::AND_AND, TokenType::AND_KW})){
-            Token op = previous(); if(op.type==TokenType::AND_KW){ Token norm = op; norm.type = TokenType::AND_AND; op = norm; }
-            auto right = equality(); expr = std::make_shared<BinaryExpr>(expr, op, right); }
-        return expr; }
-ExprPtr equality(){ auto expr = comparison(); while(match({TokenType::BANG_EQUAL, TokenType::EQUAL_EQUAL, TokenType::EQUALS_KW})){
-            Token op = previous(); if(op.type==TokenType::EQUALS_KW){ Token norm = op; norm.type = TokenType::EQUAL_EQUAL; op = norm; }
-            auto right = comparison(); expr = std::make_shared<BinaryExpr>(expr, op, right); }
-        return expr; }
-    ExprPtr comparison(){ auto expr = term(); while(match({TokenType::LESS,TokenType::LESS_EQUAL,TokenType::GREATER,TokenType::GREATER_EQUAL})){
-            Token op = previous(); auto right = term(); expr = std::make_shared<BinaryExpr>(expr, op, right); }
-        return expr; }
-    ExprPtr term(){ auto expr = factor(); while(match({TokenType::PLUS,TokenType::MINUS})){
-            Token op = previous(); auto right = factor(); expr = std::make_shared<BinaryExpr>(expr, op, right); }
-        return expr; }
-    ExprPtr factor(){ auto expr = unary(); while(match({TokenType::STAR,TokenType::SLASH,TokenType::PERCENT})){
-            Token op = previous(); auto right = unary(); expr = std::make_shared<BinaryExpr>(expr, op, right); }
-        return expr; }
-ExprPtr unary(){ if(match({TokenType::BANG, TokenType::MINUS, TokenType::NOT_KW})){
-            Token op = previous(); // normalize NOT_KW to BANG semantics
-            if(op.type==TokenType::NOT_KW){ Token norm = op; norm.type = TokenType::BANG; op = norm; }
-            auto right = unary(); return std::make_shared<UnaryExpr>(op, right); }
-        return call(); }
-
-    ExprPtr call(){ auto expr = primary(); while(true){ if(match({TokenType::LEFT_PAREN})){
-                std::vector<ExprPtr> args; if(!check(TokenType::RIGHT_PAREN)){ do{ args.push_back(expression()); } while(match({TokenType::COMMA})); }
-                consume(TokenType::RIGHT_PAREN, "Expected ')'"); expr = std::make_shared<CallExpr>(expr, args);
-            } else if(match({TokenType::DOT})){
-                auto name = consume(TokenType::IDENTIFIER, "Expected property name after '.'").lexeme; expr = std::make_shared<GetExpr>(expr, name);
-            } else if(match({TokenType::LEFT_BRACKET})){
-                auto idx = expression(); consume(TokenType::RIGHT_BRACKET, "Expected ']'"); expr = std::make_shared<IndexExpr>(expr, idx);
-            } else break; }
-        return expr; }
-
-    ExprPtr primary(){ if(match({TokenType::FALSE})) return std::make_shared<LiteralExpr>(Value(false));
-        if(match({TokenType::TRUE})) return std::make_shared<LiteralExpr>(Value(true));
-        if(match({TokenType::NULL_T})) return std::make_shared<LiteralExpr>(Value());
-        if(match({TokenType::THIS})) return std::make_shared<VarExpr>("this");
-        if(match({TokenType::NUMBER})) return std::make_shared<LiteralExpr>(Value(std::stod(previous().lexeme)));
-        if(match({TokenType::STRING})) return std::make_shared<LiteralExpr>(Value(previous().lexeme));
-        if(match({TokenType::LEFT_PAREN})) { auto e = expression(); consume(TokenType::RIGHT_PAREN, "Expected ')'"); return std::make_shared<GroupingExpr>(e);}        
-        if(match({TokenType::LEFT_BRACKET})){
-            std::vector<ExprPtr> elems; if(!check(TokenType::RIGHT_BRACKET)){ do{ elems.push_back(expression()); } while(match({TokenType::COMMA})); }
-            consume(TokenType::RIGHT_BRACKET, "Expected ']'");
-            // Represent list literal as CallExpr on a special marker handled in interpreter
-            auto marker = std::make_shared<VarExpr>("__list_literal__"); return std::make_shared<CallExpr>(marker, elems);
-        }
-        if(match({TokenType::LEFT_BRACE})){
-            // dict literal: { "k": v, ... }
-            std::vector<ExprPtr> kv; if(!check(TokenType::RIGHT_BRACE)){
-                do{ auto keyTok = consume(TokenType::STRING, "Expected string key in dict literal"); consume(TokenType::COLON, "Expected ':'"); kv.push_back(std::make_shared<LiteralExpr>(Value(keyTok.lexeme))); kv.push_back(expression()); } while(match({TokenType::COMMA}));
-            }
-            consume(TokenType::RIGHT_BRACE, "Expected '}'"); auto marker = std::make_shared<VarExpr>("__dict_literal__"); return std::make_shared<CallExpr>(marker, kv);
-        }
-        if(match({TokenType::IDENTIFIER})) return std::make_shared<VarExpr>(previous().lexeme);
-        throw RuntimeError("Expected expression"); }
-};
-
-// Environments
-struct Environment {
-    std::shared_ptr<Environment> parent;
-    std::unordered_map<std::string, Value> values;
-    explicit Environment(std::shared_ptr<Environment> p=nullptr): parent(std::move(p)) {}
-    void define(const std::string& name, Value v){ values[name]=std::move(v); }
-    bool assign(const std::string& name, Value v){ if(values.count(name)){ values[name]=std::move(v); return true; } if(parent) return parent->assign(name, std::move(v)); return false; }
-    Value get(const std::string& name){ if(values.count(name)) return values[name]; if(parent) return parent->get(name); throw RuntimeError("Undefined variable: "+name); }
-    Value* getPtr(const std::string& name){ auto it=values.find(name); if(it!=values.end()) return &it->second; if(parent) return parent->getPtr(name); return nullptr; }
-};
-
-// Callable types
-struct Callable { virtual ~Callable()=default; virtual int arity() const =0; virtual Value call(Interpreter&, const std::vector<Value>&)=0; };
-
-struct Function : Callable { std::vector<std::string> params; std::shared_ptr<BlockStmt> body; std::shared_ptr<Environment> closure; bool isInit=false; std::string name;
-    Function(std::string n,std::vector<std::string> p,std::shared_ptr<BlockStmt> b,std::shared_ptr<Environment> c,bool init=false): params(std::move(p)), body(std::move(b)), closure(std::move(c)), isInit(init), name(std::move(n)) {}
-    int arity() const override { return (int)params.size(); }
-    Value call(Interpreter&, const std::vector<Value>&) override; };
-
-struct NativeFunction : Callable { std::string name; int fixedArity; std::function<Value(Interpreter&, const std::vector<Value>&)> fn; NativeFunction(std::string n,int a,std::function<Value(Interpreter&,const std::vector<Value>&)> f): name(std::move(n)), fixedArity(a), fn(std::move(f)){} int arity() const override { return fixedArity; } Value call(Interpreter& ip, const std::vector<Value>& args) override { return fn(ip,args);} };
-
-struct Class : Callable, std::enable_shared_from_this<Class> { std::string name; std::unordered_map<std::string, std::shared_ptr<Function>> methods; int ar= -1; Class(std::string n, std::unordered_map<std::string, std::shared_ptr<Function>> m): name(std::move(n)), methods(std::move(m)){} int arity() const override { return ar; } Value call(Interpreter&, const std::vector<Value>&) override; std::shared_ptr<Function> findMethod(const std::string& n){ auto it=methods.find(n); if(it!=methods.end()) return it->second; return nullptr; } };
-
-struct Instance { std::shared_ptr<Class> klass; std::unordered_map<std::string, Value> fields; explicit Instance(std::shared_ptr<Class> k): klass(std::move(k)){} };
-
-// Interpreter
-struct ReturnSignal { Value value; };
-
-class Interpreter {
-public:
-    std::shared_ptr<Environment> globals = std::make_shared<Environment>();
-    std::shared_ptr<Environment> env = globals;
-    std::filesystem::path current_dir;
-    std::filesystem::path builtins_dir; // optional root for builtins
-    std::unordered_set<std::string> loaded_files;
-
-    explicit Interpreter(const std::filesystem::path& entry_dir);
-    void interpret(const std::vector<StmtPtr>& stmts){ try{ for(auto&s: stmts) execute(s); } catch(const RuntimeError& e){ std::cerr << "Runtime error: " << e.what() << "\n"; }}
-
-    // exec
-void execute(const StmtPtr& stmt){ if(auto p=std::dynamic_pointer_cast<BlockStmt>(stmt)) execBlock(p, std::make_shared<Environment>(env));
-        else if(auto p=std::dynamic_pointer_cast<LetStmt>(stmt)){ auto v = evaluate(p->initializer); env->define(p->name, v); }
-        else if(auto p=std::dynamic_pointer_cast<ExprStmt>(stmt)){ (void)evaluate(p->expr); }
-        else if(auto p=std::dynamic_pointer_cast<IfStmt>(stmt)){ if(isTruthy(evaluate(p->cond))) execute(p->thenB); else if(p->elseB) execute(*p->elseB); }
-        else if(auto p=std::dynamic_pointer_cast<WhileStmt>(stmt)){ while(isTruthy(evaluate(p->cond))) execute(p->body); }
-        else if(auto p=std::dynamic_pointer_cast<ForStmt>(stmt)){ execFor(p); }
-        else if(auto p=std::dynamic_pointer_cast<ReturnStmt>(stmt)){ Value v; if(p->value) v = evaluate(*p->value); throw ReturnSignal{v}; }
-        else if(auto p=std::dynamic_pointer_cast<FunctionStmt>(stmt)){ auto f = std::make_shared<Function>(p->name, p->params, p->body, env, false); env->define(p->name, Value(f)); }
-        else if(auto p=std::dynamic_pointer_cast<ClassStmt>(stmt)){ std::unordered_map<std::string, std::shared_ptr<Function>> methods; for(auto& kv: p->methods){ auto f = std::make_shared<Function>(kv.first, kv.second->params, kv.second->body, env, kv.first=="init"); methods[kv.first]=f; } auto k = std::make_shared<Class>(p->name, methods); env->define(p->name, Value(k)); }
-        else if(auto p=std::dynamic_pointer_cast<StructStmt>(stmt)){ // store struct metadata as a Class without methods; instances created via Class call
-            auto k = std::make_shared<Class>(p->name, std::unordered_map<std::string, std::shared_ptr<Function>>{}); env->define(p->name, Value(k)); }
-        else if(auto p=std::dynamic_pointer_cast<UnionStmt>(stmt)){ auto k = std::make_shared<Class>(p->name, std::unordered_map<std::string, std::shared_ptr<Function>>{}); env->define(p->name, Value(k)); }
-        else if(auto p=std::dynamic_pointer_cast<ImportStmt>(stmt)){ execImport(p->path); }
-        else if(auto q = std::dynamic_pointer_cast<MultiAssignStmt>(stmt)){
-            Value rv = evaluate(q->value);
-            auto lst = std::get_if<List>(&rv.data);
-            if(!lst) throw RuntimeError("Right-hand side of multi-assign must be a list");
-            if(lst->size() != q->names.size()) throw RuntimeError("Multi-assign length mismatch");
-            for(size_t i=0;i<q->names.size();++i){
-                const auto& name = q->names[i];
-                if(env->values.count(name)) env->assign(name, (*lst)[i]); else env->define(name, (*lst)[i]);
-            }
-        }
-        else if(auto ml = std::dynamic_pointer_cast<MultiLetStmt>(stmt)){
-            for(const auto& name : ml->names){ env->define(name, Value()); }
-        }
-        else { throw RuntimeError("Unknown statement type"); } }
-
-    void execBlock(const std::shared_ptr<BlockStmt>& block, std::shared_ptr<Environment> newEnv){ auto prev = env; env = newEnv; try{ for(auto&s: block->stmts) execute(s); } catch(...) { env = prev; throw; } env = prev; }
-
-    void execFor(const std::shared_ptr<ForStmt>& fs){ Value it = evaluate(fs->iterable); auto setVar = [&](const Value& v){ if(env->values.count(fs->var)) env->assign(fs->var, v); else env->define(fs->var, v); };
-        if(auto l = std::get_if<List>(&it.data)){ for(const auto& v : *l){ setVar(v); execute(fs->body); } return; }
-        if(auto d = std::get_if<Dict>(&it.data)){ for(const auto& kv : *d){ setVar(Value(kv.first)); execute(fs->body); } return; }
-        if(auto s = std::get_if<std::string>(&it.data)){ for(char ch: *s){ std::string one(1, ch); setVar(Value(one)); execute(fs->body);} return; }
-        throw RuntimeError("for 'in' expects list, dict, or string"); }
-
-void execImport(const std::string& rawPath){ using namespace std::filesystem; path p(rawPath);
-        if(p.extension().empty()) p.replace_extension(".ad");
-        path full;
-        // Special handling for builtins location, e.g. import "builtins/..."
-        std::string raw = rawPath;
-        if(!builtins_dir.empty() && (raw.rfind("builtins/", 0)==0 || raw.rfind("builtins\\", 0)==0)){
-            // Compute sub path under builtins and ensure .ad extension if missing
-            path sub = raw.substr(raw.find('/')!=std::string::npos? raw.find('/')+1 : raw.find('\\')+1);
-            path subp(sub);
-            if(subp.extension().empty()) subp.replace_extension(".ad");
-            full = (builtins_dir / subp).lexically_normal();
-        } else {
-            full = (current_dir / p).lexically_normal();
-        }
-        std::string key = full.string(); if(loaded_files.count(key)) return; loaded_files.insert(key);
-        std::ifstream in(full, std::ios::binary); if(!in) throw RuntimeError(std::string("import: cannot open ")+ key);
-        std::ostringstream ss; ss<<in.rdbuf(); std::string src = ss.str(); Lexer lx(src); auto toks = lx.scan(); Parser ps(toks); auto stmts = ps.parse(); auto prevDir = current_dir; current_dir = full.parent_path(); try{ for(auto& s: stmts) execute(s); } catch(...) { current_dir = prevDir; throw; } current_dir = prevDir; }
-
-    Value evaluate(const ExprPtr& expr){
-        if(auto p=std::dynamic_pointer_cast<LiteralExpr>(expr)) return p->value;
-        if(auto p=std::dynamic_pointer_cast<VarExpr>(expr)) { if(auto ptr = env->getPtr(p->name)) return *ptr; return Value(); }
-        if(auto p=std::dynamic_pointer_cast<AssignExpr>(expr)){ auto v = evaluate(p->value); if(!env->assign(p->name, v)) throw RuntimeError("Undefined variable: "+p->name); return v; }
-        if(auto p=std::dynamic_pointer_cast<GroupingExpr>(expr)) return evaluate(p->expr);
-        if(auto p=std::dynamic_pointer_cast<UnaryExpr>(expr)) return evalUnary(p->op, evaluate(p->right));
-        if(auto p=std::dynamic_pointer_cast<BinaryExpr>(expr)){
-            // Implement short-circuit for logical AND/OR
-            if(p->op.type==TokenType::AND_AND || p->op.type==TokenType::AND_KW){
-                Token op = p->op; if(op.type==TokenType::AND_KW){ Token norm=op; norm.type=TokenType::AND_AND; op=norm; }
-                Value left = evaluate(p->left);
-                if(!isTruthy(left)) return Value(false);
-                Value right = evaluate(p->right);
-                return evalBinary(left, op, right);
-            }
-            if(p->op.type==TokenType::OR_OR || p->op.type==TokenType::OR_KW){
-                Token op = p->op; if(op.type==TokenType::OR_KW){ Token norm=op; norm.type=TokenType::OR_OR; op=norm; }
-                Value left = evaluate(p->left);
-                if(isTruthy(left)) return Value(true);
-                Value right = evaluate(p->right);
-                return evalBinary(left, op, right);
-            }
-            return evalBinary(evaluate(p->left), p->op, evaluate(p->right));
-        }
-        if(auto p=std::dynamic_pointer_cast<CallExpr>(expr)) return evalCall(p);
-        if(auto p=std::dynamic_pointer_cast<GetExpr>(expr)) return evalGet(p);
-        if(auto p=std::dynamic_pointer_cast<SetExpr>(expr)) return evalSet(p);
-        if(auto p=std::dynamic_pointer_cast<IndexExpr>(expr)) return evalIndex(p);
-        if(auto p=std::dynamic_pointer_cast<SetIndexExpr>(expr)) return evalSetIndex(p);
-        throw RuntimeError("Unknown expression");
-    }
-
-    static bool isTruthy(const Value& v){ if(std::holds_alternative<std::monostate>(v.data)) return false; if(auto b=std::get_if<bool>(&v.data)) return *b; if(auto n=std::get_if<double>(&v.data)) return *n!=0; return true; }
-
-    Value evalUnary(const Token& op, const Value& r){ switch(op.type){ case TokenType::BANG: return Value(!isTruthy(r)); case TokenType::MINUS: {
-                if(auto n=std::get_if<double>(&r.data)) return Value(-*n); throw RuntimeError("Unary '-' on non-number"); }
-            default: throw RuntimeError("Invalid unary op"); }}
-
-    Value evalBinary(const Value& l, const Token& op, const Value& r){ auto num = [&](const Value& v)->double{ if(auto n=std::get_if<double>(&v.data)) return *n; throw RuntimeError("Expected number"); };
-        auto str = [&](const Value& v)->std::string{ if(auto s=std::get_if<std::string>(&v.data)) return *s; throw RuntimeError("Expected string"); };
-        switch(op.type){
-            case TokenType::PLUS: {
-                if(std::holds_alternative<double>(l.data) && std::holds_alternative<double>(r.data)) return Value(num(l)+num(r));
-                if(std::holds_alternative<std::string>(l.data) || std::holds_alternative<std::string>(r.data)) {
-                    std::ostringstream oss; if(auto ls=std::get_if<std::string>(&l.data)) oss<<*ls; else if(auto ln=std::get_if<double>(&l.data)) oss<<*ln; else oss<<"[obj]";
-                    if(auto rs=std::get_if<std::string>(&r.data)) oss<<*rs; else if(auto rn=std::get_if<double>(&r.data)) oss<<*rn; else oss<<"[obj]";
-                    return Value(oss.str());
-                }
-                throw RuntimeError("'+' needs numbers or strings"); }
-            case TokenType::MINUS: return Value(num(l)-num(r));
-            case TokenType::STAR: return Value(num(l)*num(r));
-            case TokenType::SLASH: { double d=num(r); if(d==0) throw RuntimeError("Division by zero"); return Value(num(l)/d);}            
-            case TokenType::PERCENT: { double d=num(r); if(d==0) throw RuntimeError("Modulo by zero"); return Value(fmod(num(l), d)); }
-            case TokenType::EQUAL_EQUAL: return Value(equal(l,r));
-            case TokenType::BANG_EQUAL: return Value(!equal(l,r));
-            case TokenType::LESS: return Value(num(l)<num(r));
-            case TokenType::LESS_EQUAL: return Value(num(l)<=num(r));
-            case TokenType::GREATER: return Value(num(l)>num(r));
-            case TokenType::GREATER_EQUAL: return Value(num(l)>=num(r));
-            case TokenType::AND_AND: return Value(isTruthy(l) && isTruthy(r));
-            case TokenType::OR_OR: return Value(isTruthy(l) || isTruthy(r));
-            default: throw RuntimeError("Invalid binary op");
-        }
-    }
-
-    static bool equal(const Value& a, const Value& b){ if(a.data.index()!=b.data.index()) return false; if(auto pa=std::get_if<std::monostate>(&a.data)) return true; if(auto pb=std::get_if<bool>(&a.data)) return *pb==std::get<bool>(b.data); if(auto pn=std::get_if<double>(&a.data)) return *pn==std::get<double>(b.data); if(auto ps=std::get_if<std::string>(&a.data)) return *ps==std::get<std::string>(b.data); return &a==&b; }
-
-    Value evalCall(const std::shared_ptr<CallExpr>& c){
-        // list and dict literal markers
-        if(auto v=std::dynamic_pointer_cast<VarExpr>(c->callee)){
-            if(v->name=="__list_literal__"){ List lst; for(auto &e: c->args) lst.push_back(evaluate(e)); return Value(lst);}            
-            if(v->name=="__dict_literal__"){ Dict d; for(size_t i=0;i<c->args.size();i+=2){ auto k = evaluate(c->args[i]); auto val = evaluate(c->args[i+1]); d[std::get<std::string>(k.data)] = val; } return Value(d);}        }
-        Value cal = evaluate(c->callee);
-        if(auto nf = std::get_if<std::shared_ptr<NativeFunction>>(&cal.data)){
-            std::vector<Value> evaluated; evaluated.reserve(c->args.size()); for(auto &a: c->args) evaluated.push_back(evaluate(a)); return (*nf)->call(*this, evaluated);
-        }
-        if(auto uf = std::get_if<std::shared_ptr<Function>>(&cal.data)){
-            std::vector<Value> evaluated; evaluated.reserve(c->args.size()); for(auto &a: c->args) evaluated.push_back(evaluate(a)); return (*uf)->call(*this, evaluated);
-        }
-        if(auto kc = std::get_if<std::shared_ptr<Class>>(&cal.data)){
-            std::vector<Value> evaluated; evaluated.reserve(c->args.size()); for(auto &a: c->args) evaluated.push_back(evaluate(a)); return (*kc)->call(*this, evaluated);
-        }
-        throw RuntimeError("Can only call functions/classes");
-    }
-
-    Value evalGet(const std::shared_ptr<GetExpr>& g){ auto obj = evaluate(g->object); if(auto inst = std::get_if<std::shared_ptr<Instance>>(&obj.data)){
-            auto it = (*inst)->fields.find(g->name); if(it!=(*inst)->fields.end()) return it->second; if(auto m = (*inst)->klass->findMethod(g->name)){
-                // bind this
-                auto bound = std::make_shared<Function>(m->name, m->params, m->body, std::make_shared<Environment>(m->closure), m->isInit);
-                bound->closure->define("this", obj); return Value(bound);
-            }
-            throw RuntimeError("Undefined property: "+g->name);
-        }
-        if(auto d = std::get_if<Dict>(&obj.data)){
-            auto it = d->find(g->name); if(it!=d->end()) return it->second; throw RuntimeError("Dict has no key: "+g->name);
-        }
-        if(auto s = std::get_if<std::string>(&obj.data)){
-            // Provide string methods: split
-            if(g->name == "split"){
-                std::string base = *s;
-                auto fn = std::make_shared<NativeFunction>("string.split", -1, [base](Interpreter&, const std::vector<Value>& args)->Value{
-                    // emulate split(base, sep?)
-                    std::string sep;
-                    if(args.size()==1){ if(std::holds_alternative<std::string>(args[0].data)) sep = std::get<std::string>(args[0].data); else throw RuntimeError("split sep must be string"); }
-                    else if(args.size()>1) throw RuntimeError("split expects at most 1 arg");
-                    // Reuse split logic
-                    if(sep.empty()){
-                        std::istringstream iss(base); std::string tok; List out; while(iss>>tok){ out.push_back(Value(tok)); } return Value(out);
-                    } else {
-                        List out; size_t pos=0; while(true){ size_t n=base.find(sep, pos); if(n==std::string::npos){ out.push_back(Value(base.substr(pos))); break; } out.push_back(Value(base.substr(pos, n-pos))); pos = n + sep.size(); } return Value(out);
-                    }
-                });
-                return Value(fn);
-            }
-            throw RuntimeError("String has no property: "+g->name);
-        }
-        throw RuntimeError("Only instances, dicts, or strings have properties");
-    }
-
-    Value evalSet(const std::shared_ptr<SetExpr>& s){ auto obj = evaluate(s->object); Value v = evaluate(s->value); if(auto inst = std::get_if<std::shared_ptr<Instance>>(&obj.data)){
-            (*inst)->fields[s->name]=v; return v; }
-        if(auto d = std::get_if<Dict>(&obj.data)){
-            (*d)[s->name]=v; return v; }
-        throw RuntimeError("Only instances or dicts support set");
-    }
-
-    Value evalIndex(const std::shared_ptr<IndexExpr>& ix){ auto obj = evaluate(ix->object); auto idx = evaluate(ix->index); if(auto lst = std::get_if<List>(&obj.data)){
-            int i = (int)std::get<double>(idx.data); if(i<0 || i>=(int)lst->size()) throw RuntimeError("List index out of range"); return (*lst)[i]; }
-        if(auto d = std::get_if<Dict>(&obj.data)){
-            auto key = std::get<std::string>(idx.data); auto it=d->find(key); if(it==d->end()) throw RuntimeError("Key not found"); return it->second; }
-        throw RuntimeError("Indexing supported on list/dict"); }
-
-Value evalSetIndex(const std::shared_ptr<SetIndexExpr>& sx){ auto idxv = evaluate(sx->index); auto val = evaluate(sx->value);
-        // Handle instance field or dict property: this.field[i] = v
-        if(auto ge = std::dynamic_pointer_cast<GetExpr>(sx->object)){
-            Value base = evaluate(ge->object);
-            if(auto inst = std::get_if<std::shared_ptr<Instance>>(&base.data)){
-                Value &slot = (*inst)->fields[ge->name];
-                if(auto lst = std::get_if<List>(&slot.data)){
-                    int i = (int)std::get<double>(idxv.data); if(i<0) throw RuntimeError("List index out of range"); if(i==(int)lst->size()) { lst->push_back(val); return val; } if(i>=(int)lst->size()) throw RuntimeError("List index out of range"); (*lst)[i]=val; return val;
-                }
-                if(auto d = std::get_if<Dict>(&slot.data)){
-                    auto key = std::get<std::string>(idxv.data); (*d)[key]=val; return val;
-                }
-                throw RuntimeError("Index assignment on non-indexable field");
-            }
-            if(auto d = std::get_if<Dict>(&base.data)){
-                Value &slot = (*d)[ge->name];
-                if(auto lst = std::get_if<List>(&slot.data)){
-                    int i = (int)std::get<double>(idxv.data); if(i<0) throw RuntimeError("List index out of range"); if(i==(int)lst->size()) { lst->push_back(val); return val; } if(i>=(int)lst->size()) throw RuntimeError("List index out of range"); (*lst)[i]=val; return val;
-                }
-                if(auto d2 = std::get_if<Dict>(&slot.data)){
-                    auto key = std::get<std::string>(idxv.data); (*d2)[key]=val; return val;
-                }
-                throw RuntimeError("Index assignment on non-indexable dict property");
-            }
-        }
-        // Handle variable list: xs[i] = v
-        if(auto ve = std::dynamic_pointer_cast<VarExpr>(sx->object)){
-            Value* slot = env->getPtr(ve->name);
-            if(!slot) throw RuntimeError("Undefined variable: "+ve->name);
-            if(auto lst = std::get_if<List>(&slot->data)){
-                int i = (int)std::get<double>(idxv.data); if(i<0) throw RuntimeError("List index out of range"); if(i==(int)lst->size()) { lst->push_back(val); return val; } if(i>=(int)lst->size()) throw RuntimeError("List index out of range"); (*lst)[i]=val; return val;
-            }
-            if(auto d = std::get_if<Dict>(&slot->data)){
-                auto key = std::get<std::string>(idxv.data); (*d)[key]=val; return val;
-            }
-            throw RuntimeError("Index assignment on non-indexable variable");
-        }
-        // Fallback: evaluate object value and attempt to modify; may not persist if temporary
-        Value obj = evaluate(sx->object);
-        if(auto lst = std::get_if<List>(&obj.data)){
-            int i = (int)std::get<double>(idxv.data); if(i<0) throw RuntimeError("List index out of range"); if(i==(int)lst->size()) { lst->push_back(val); return val; } if(i>=(int)lst->size()) throw RuntimeError("List index out of range"); (*lst)[i] = val; return val; }
-        if(auto d = std::get_if<Dict>(&obj.data)){
-            auto key = std::get<std::string>(idxv.data); (*d)[key] = val; return val; }
-        throw RuntimeError("Index assignment supported on list/dict"); }
-};
-
-// Function call impl
-Value Function::call(Interpreter& ip, const std::vector<Value>& args){ if((int)args.size()!=arity()) throw RuntimeError("Arity mismatch"); auto local = std::make_shared<Environment>(closure); for(size_t i=0;i<params.size();++i) local->define(params[i], args[i]);
-    // if method with 'this' in closure, keep it
-    try{ ip.execBlock(body, local); if(isInit) return local->get("this"); return Value(); } catch(const ReturnSignal& r){ if(isInit) return local->get("this"); return r.value; } }
-
-// Class call creates instance and invokes init if exists
-Value Class::call(Interpreter& ip, const std::vector<Value>& args){ auto inst = std::make_shared<Instance>(std::static_pointer_cast<Class>(shared_from_this())); auto init = findMethod("init"); if(init){ auto bound = std::make_shared<Function>(init->name, init->params, init->body, std::make_shared<Environment>(init->closure), true); bound->closure->define("this", Value(inst)); if((int)args.size()!=bound->arity()) throw RuntimeError("Arity mismatch in init"); (void)bound->call(ip, args); }
-    return Value(inst); }
-
-// Builtins
-static Value builtin_print(Interpreter&, const std::vector<Value>& args){ std::ostringstream oss; for(size_t i=0;i<args.size();++i){ const Value& v=args[i]; if(i) oss<<" "; if(auto n=std::get_if<double>(&v.data)) oss<<*n; else if(auto s=std::get_if<std::string>(&v.data)) oss<<*s; else if(auto b=std::get_if<bool>(&v.data)) oss<<(*b?"true":"false"); else if(std::holds_alternative<std::monostate>(v.data)) oss<<"null"; else if(auto l=std::get_if<List>(&v.data)){ oss<<"["; for(size_t j=0;j<l->size();++j){ if(j) oss<<", "; const Value& e=(*l)[j]; if(auto en=std::get_if<double>(&e.data)) oss<<*en; else if(auto es=std::get_if<std::string>(&e.data)) oss<<'"'<<*es<<'"'; else oss<<"...";} oss<<"]"; } else if(auto d=std::get_if<Dict>(&v.data)){ oss<<"{"; size_t j=0; for(auto& kv:*d){ if(j++) oss<<", "; oss<<kv.first<<": "; const Value& e=kv.second; if(auto en=std::get_if<double>(&e.data)) oss<<*en; else if(auto es=std::get_if<std::string>(&e.data)) oss<<'"'<<*es<<'"'; else oss<<"...";} oss<<"}"; } else { oss<<"<"<<v.typeName()<<">";} }
-    std::cout<<oss.str()<<"\n"; std::cout.flush(); return Value(); }
-
-static Value builtin_len(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("len expects 1 arg"); if(auto l=std::get_if<List>(&args[0].data)) return Value((double)l->size()); if(auto s=std::get_if<std::string>(&args[0].data)) return Value((double)s->size()); if(auto d=std::get_if<Dict>(&args[0].data)) return Value((double)d->size()); throw RuntimeError("len on unsupported type"); }
-
-static Value builtin_input(Interpreter&, const std::vector<Value>& args){ if(args.size()>1) throw RuntimeError("input expects 0 or 1 arg"); if(args.size()==1){ if(auto s=std::get_if<std::string>(&args[0].data)) { std::cout<<*s; std::cout.flush(); } else throw RuntimeError("input prompt must be string"); }
-    else { std::cout.flush(); }
-    std::string line; std::getline(std::cin, line); return Value(line); }
-
-static Value builtin_map(Interpreter& ip, const std::vector<Value>& args){ if(args.size()!=2) throw RuntimeError("map expects (func, list)"); auto fptr = std::get_if<std::shared_ptr<Function>>(&args[0].data); auto nptr = std::get_if<std::shared_ptr<NativeFunction>>(&args[0].data); auto lptr = std::get_if<List>(&args[1].data); if(!lptr) throw RuntimeError("map arg2 must be list"); List out; out.reserve(lptr->size()); for(const auto& v: *lptr){ if(fptr){ out.push_back((*fptr)->call(ip, {v})); } else if(nptr){ out.push_back((*nptr)->call(ip, {v})); } else throw RuntimeError("map arg1 must be callable"); } return Value(out); }
-
-static Value builtin_sqrt_bs(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("sqrt_bs expects 1 arg"); double x; if(auto n=std::get_if<double>(&args[0].data)) x=*n; else throw RuntimeError("sqrt_bs needs number"); if(x<0) throw RuntimeError("sqrt_bs domain error"); if(x==0) return Value(0.0); double lo=0, hi=std::max(1.0, x), mid; for(int i=0;i<100;i++){ mid=(lo+hi)/2; if(mid*mid>=x) hi=mid; else lo=mid; } return Value((lo+hi)/2); }
-
-static Value builtin_range(Interpreter&, const std::vector<Value>& args){ auto asInt=[&](const Value& v)->long long{ if(auto n=std::get_if<double>(&v.data)) return (long long)*n; throw RuntimeError("range expects numbers");}; long long start=0, stop=0, step=1; if(args.size()==1){ stop=asInt(args[0]); } else if(args.size()==2){ start=asInt(args[0]); stop=asInt(args[1]); } else if(args.size()==3){ start=asInt(args[0]); stop=asInt(args[1]); step=asInt(args[2]); if(step==0) throw RuntimeError("range step cannot be 0"); } else throw RuntimeError("range expects 1..3 args"); List out; if(step>0){ for(long long i=start;i<stop;i+=step) out.push_back(Value((double)i)); } else { for(long long i=start;i>stop;i+=step) out.push_back(Value((double)i)); } return Value(out); }
-
-// Additional builtins for casting and string/list operations
-static Value builtin_int(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("int expects 1 arg"); if(auto n=std::get_if<double>(&args[0].data)) return Value((double)(long long)(*n)); if(auto s=std::get_if<std::string>(&args[0].data)) return Value((double)std::stoll(*s)); if(auto b=std::get_if<bool>(&args[0].data)) return Value(*b?1.0:0.0); throw RuntimeError("int() unsupported type"); }
-static Value builtin_float(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("float expects 1 arg"); if(auto n=std::get_if<double>(&args[0].data)) return Value(*n); if(auto s=std::get_if<std::string>(&args[0].data)) return Value(std::stod(*s)); if(auto b=std::get_if<bool>(&args[0].data)) return Value(*b?1.0:0.0); throw RuntimeError("float() unsupported type"); }
-static Value builtin_str(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("str expects 1 arg"); const Value& v=args[0]; std::ostringstream oss; if(auto n=std::get_if<double>(&v.data)) oss<<*n; else if(auto s=std::get_if<std::string>(&v.data)) oss<<*s; else if(auto b=std::get_if<bool>(&v.data)) oss<<(*b?"true":"false"); else if(std::holds_alternative<std::monostate>(v.data)) oss<<"null"; else oss<<"<"<<v.typeName()<<">"; return Value(oss.str()); }
-static Value builtin_split(Interpreter&, const std::vector<Value>& args){ if(args.size()<1||args.size()>2) throw RuntimeError("split expects (string[, sep])"); if(!std::holds_alternative<std::string>(args[0].data)) throw RuntimeError("split first arg must be string"); std::string s=std::get<std::string>(args[0].data); std::string sep = (args.size()==2)? std::get<std::string>(args[1].data) : std::string(); List out; if(sep.empty()){ std::istringstream iss(s); std::string part; while(iss>>part) out.push_back(Value(part)); } else { size_t pos=0; while(true){ size_t n=s.find(sep, pos); if(n==std::string::npos){ out.push_back(Value(s.substr(pos))); break; } out.push_back(Value(s.substr(pos, n-pos))); pos = n+sep.size(); } } return Value(out); }
-static Value builtin_join(Interpreter&, const std::vector<Value>& args){ if(args.size()!=2) throw RuntimeError("join expects (list, sep)"); auto lst = std::get_if<List>(&args[0].data); if(!lst) throw RuntimeError("join first arg must be list of strings"); std::string sep = std::get<std::string>(args[1].data); std::ostringstream oss; for(size_t i=0;i<lst->size();++i){ if(i) oss<<sep; oss<<std::get<std::string>((*lst)[i].data); } return Value(oss.str()); }
-static Value builtin_has(Interpreter&, const std::vector<Value>& args){ if(args.size()!=2) throw RuntimeError("has expects (dict, key)"); auto d = std::get_if<Dict>(&args[0].data); if(!d) throw RuntimeError("has first arg must be dict"); auto key = std::get<std::string>(args[1].data); return Value((bool)(d->find(key)!=d->end())); }
-#ifdef _WIN32
-#include <windows.h>
-#include <winhttp.h>
-#pragma comment(lib, "winhttp.lib")
-#endif
-
-// HTTP helpers using WinHTTP on Windows or libcurl elsewhere; supports http and https
-static Dict http_request(const std::string& method, const std::string& url, const std::string& body, const std::unordered_map<std::string, std::string>& extra_headers){
-    // file:// short-circuit on all platforms
-    const std::string filePrefix = "file://";
-    if(url.rfind(filePrefix, 0) == 0){
-        std::string path = url.substr(filePrefix.size());
-        std::ifstream in(path, std::ios::binary);
-        if(!in) throw RuntimeError("requests."+method+": cannot open file");
-        std::ostringstream ss; ss << in.rdbuf();
-        Dict resp; resp["status"] = Value((double)200); resp["text"] = Value(ss.str()); return resp;
-    }
-#ifdef _WIN32
-    // Windows: WinHTTP
-    URL_COMPONENTS uc{}; ZeroMemory(&uc, sizeof(uc));
-    wchar_t host[256]; wchar_t path[2048];
-    wchar_t scheme[16];
-    uc.dwStructSize = sizeof(uc);
-    uc.lpszHostName = host; uc.dwHostNameLength = _countof(host);
-    uc.lpszUrlPath = path; uc.dwUrlPathLength = _countof(path);
-    uc.lpszScheme = scheme; uc.dwSchemeLength = _countof(scheme);
-    if(!WinHttpCrackUrl(std::wstring(url.begin(), url.end()).c_str(), 0, 0, &uc)){
-        throw RuntimeError("requests."+method+": invalid URL");
-    }
-    bool secure = (uc.nScheme == INTERNET_SCHEME_HTTPS);
-
-    HINTERNET hSession = WinHttpOpen(L"AdaScript/2.0", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
-    if(!hSession) throw RuntimeError("requests."+method+": WinHttpOpen failed");
-    HINTERNET hConnect = WinHttpConnect(hSession, uc.lpszHostName, uc.nPort? uc.nPort : (secure? INTERNET_DEFAULT_HTTPS_PORT : INTERNET_DEFAULT_HTTP_PORT), 0);
-    if(!hConnect){ WinHttpCloseHandle(hSession); throw RuntimeError("requests."+method+": WinHttpConnect failed"); }
-
-    DWORD flags = secure? WINHTTP_FLAG_SECURE : 0;
-    HINTERNET hRequest = WinHttpOpenRequest(hConnect, std::wstring(method.begin(), method.end()).c_str(), uc.lpszUrlPath, nullptr, WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES, flags);
-    if(!hRequest){ WinHttpCloseHandle(hConnect); WinHttpCloseHandle(hSession); throw RuntimeError("requests."+method+": WinHttpOpenRequest failed"); }
-
-    // Build headers
-    std::ostringstream hdrs;
-    for(const auto& kv : extra_headers){ hdrs << kv.first << ": " << kv.second << "\r\n"; }
-    std::string hdrStr = hdrs.str();
-    std::wstring whdr(hdrStr.begin(), hdrStr.end());
-
-    const void* bodyData = body.empty()? nullptr : body.data();
-    DWORD bodySize = (DWORD)body.size();
-
-    BOOL sent = WinHttpSendRequest(hRequest,
-        whdr.empty()? WINHTTP_NO_ADDITIONAL_HEADERS : whdr.c_str(), (DWORD)-1L,
-        (LPVOID)bodyData, bodySize, bodySize, 0);
-    if(!sent){ WinHttpCloseHandle(hRequest); WinHttpCloseHandle(hConnect); WinHttpCloseHandle(hSession); throw RuntimeError("requests."+method+": WinHttpSendRequest failed"); }
-    if(!WinHttpReceiveResponse(hRequest, nullptr)){
-        WinHttpCloseHandle(hRequest); WinHttpCloseHandle(hConnect); WinHttpCloseHandle(hSession);
-        throw RuntimeError("requests."+method+": WinHttpReceiveResponse failed");
-    }
-
-    // Status code
-    DWORD statusCode = 0; DWORD size = sizeof(statusCode);
-    WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER, WINHTTP_HEADER_NAME_BY_INDEX, &statusCode, &size, WINHTTP_NO_HEADER_INDEX);
-
-    // Read body
-    std::string out;
-    for(;;){
-        DWORD dwSize = 0;
-        if(!WinHttpQueryDataAvailable(hRequest, &dwSize)) break;
-        if(dwSize == 0) break;
-        std::string chunk; chunk.resize(dwSize);
-        DWORD dwRead = 0;
-        if(!WinHttpReadData(hRequest, chunk.data(), dwSize, &dwRead)) break;
-        chunk.resize(dwRead);
-        out.append(chunk);
-    }
-
-    // Few headers
-    Dict headers;
-    wchar_t ctype[256]; DWORD ctypeLen = sizeof(ctype);
-    if(WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_CONTENT_TYPE, WINHTTP_HEADER_NAME_BY_INDEX, &ctype, &ctypeLen, WINHTTP_NO_HEADER_INDEX)){
-        std::wstring ws(ctype, (ctypeLen/sizeof(wchar_t))-1);
-        headers["Content-Type"] = Value(std::string(ws.begin(), ws.end()));
-    }
-    wchar_t server[256]; DWORD serverLen = sizeof(server);
-    if(WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_SERVER, WINHTTP_HEADER_NAME_BY_INDEX, &server, &serverLen, WINHTTP_NO_HEADER_INDEX)){
-        std::wstring ws(server, (serverLen/sizeof(wchar_t))-1);
-        headers["Server"] = Value(std::string(ws.begin(), ws.end()));
-    }
-
-    WinHttpCloseHandle(hRequest); WinHttpCloseHandle(hConnect); WinHttpCloseHandle(hSession);
-
-    Dict resp; resp["status"] = Value((double)statusCode); resp["text"] = Value(out); resp["headers"] = Value(headers);
-    return resp;
-#else
-    // Non-Windows: libcurl (optional)
-    #ifndef ADASCRIPT_NO_CURL
-      // Ensure global init once (thread-safe)
-      static std::once_flag curl_once;
-      std::call_once(curl_once, [](){ curl_global_init(CURL_GLOBAL_DEFAULT); });
-      CurlBuf buf; long code = 0;
-      CURL* curl = curl_easy_init();
-      if(!curl) throw RuntimeError("requests."+method+": curl init failed");
-      curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-      curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-      curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_write_cb);
-      curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buf);
-      // Prefer HTTP/1.1 for broader compatibility in constrained envs
-      curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
-      curl_easy_setopt(curl, CURLOPT_USERAGENT, "AdaScript/2.0");
-      // TLS configuration for WSL/Linux: try CA bundle, else relax verification as last resort
-      bool is_https = (url.rfind("https://", 0) == 0);
-      if(is_https){
-          // Common CA bundle locations
-          const char* ca_candidates[] = {
-            "/etc/ssl/certs/ca-certificates.crt",
-            "/etc/ssl/cert.pem",
-            "/etc/pki/tls/certs/ca-bundle.crt",
-            "/etc/ssl/certs/ca-bundle.crt"
-          };
-          bool ca_set = false;
-          for(const char* ca : ca_candidates){
-              FILE* f = fopen(ca, "rb");
-              if(f){ fclose(f); curl_easy_setopt(curl, CURLOPT_CAINFO, ca); ca_set = true; break; }
-          }
-          if(!ca_set){
-              // Fall back: disable peer/host verification (not recommended for production)
-              curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-              curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-          }
-      }
-      if(!body.empty()){
-          curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-          curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)body.size());
-      }
-      struct curl_slist* hdrs = nullptr;
-      // Default headers for broader compatibility
-      hdrs = curl_slist_append(hdrs, "Accept: */*");
-      for(const auto& kv : extra_headers){ std::string h = kv.first + ": " + kv.second; hdrs = curl_slist_append(hdrs, h.c_str()); }
-      if(hdrs) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, hdrs);
-      curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
-      // Avoid signals (SIGPIPE) in libcurl on Linux/WSL
-      curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
-      // Disable compression to avoid decoder issues in constrained envs
-      curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
-      char errbuf[CURL_ERROR_SIZE] = {0};
-      curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errbuf);
-      CURLcode rc = curl_easy_perform(curl);
-      if(rc == CURLE_GOT_NOTHING){
-          // Retry once with HTTP/1.0 and Connection: close
-          curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_0);
-          hdrs = curl_slist_append(hdrs, "Connection: close");
-          curl_easy_setopt(curl, CURLOPT_HTTPHEADER, hdrs);
-          rc = curl_easy_perform(curl);
-      }
-      if(rc != CURLE_OK){
-          std::string emsg = std::string("requests.")+method+": curl perform failed: "+ (errbuf[0]? errbuf : curl_easy_strerror(rc));
-          if(hdrs) curl_slist_free_all(hdrs);
-          curl_easy_cleanup(curl);
-          throw RuntimeError(emsg);
-      }
-      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
-      if(hdrs) curl_slist_free_all(hdrs);
-      curl_easy_cleanup(curl);
-      Dict resp; resp["status"] = Value((double)code); resp["text"] = Value(buf.s); return resp;
-    #else
-      throw RuntimeError("HTTP disabled: libcurl not available in this build");
-    #endif
-#endif
-}
-
-// requests.get(url)
-static Value builtin_requests_get(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("requests.get expects (url)"); std::string url = std::get<std::string>(args[0].data); auto resp = http_request("GET", url, std::string(), {}); return Value(resp); }
-// requests.post(url, data, headers?)
-static Value builtin_requests_post(Interpreter&, const std::vector<Value>& args){ if(args.size()<1||args.size()>3) throw RuntimeError("requests.post expects (url[, data[, headers]])"); std::string url = std::get<std::string>(args[0].data); std::string body; std::unordered_map<std::string,std::string> hdrs; if(args.size()>=2){ if(auto s=std::get_if<std::string>(&args[1].data)) body=*s; else throw RuntimeError("requests.post data must be string"); } if(args.size()==3){ auto d = std::get_if<Dict>(&args[2].data); if(!d) throw RuntimeError("requests.post headers must be dict"); for(const auto& kv : *d){ if(std::holds_alternative<std::string>(kv.second.data)) hdrs[kv.first] = std::get<std::string>(kv.second.data); }
-    }
-auto resp = http_request("POST", url, body, hdrs); return Value(resp); }
-// requests.request(method, url[, data[, headers]])
-static Value builtin_requests_request(Interpreter&, const std::vector<Value>& args){ if(args.size()<2||args.size()>4) throw RuntimeError("requests.request expects (method, url[, data[, headers]])"); std::string method = std::get<std::string>(args[0].data); std::string url = std::get<std::string>(args[1].data); std::string body; std::unordered_map<std::string,std::string> hdrs; if(args.size()>=3){ if(auto s=std::get_if<std::string>(&args[2].data)) body=*s; else throw RuntimeError("requests.request data must be string"); } if(args.size()==4){ auto d = std::get_if<Dict>(&args[3].data); if(!d) throw RuntimeError("requests.request headers must be dict"); for(const auto& kv : *d){ if(std::holds_alternative<std::string>(kv.second.data)) hdrs[kv.first] = std::get<std::string>(kv.second.data); } }
-auto resp = http_request(method, url, body, hdrs); return Value(resp); }
-
-// Parse a line of input into a list: list_input(prompt[, sep[, type]]) where type in {"auto","int","float","str"}
-static Value builtin_list_input(Interpreter&, const std::vector<Value>& args){ if(args.size()<1||args.size()>3) throw RuntimeError("list_input expects (prompt[, sep[, type]])"); if(!std::holds_alternative<std::string>(args[0].data)) throw RuntimeError("list_input prompt must be string"); std::string prompt = std::get<std::string>(args[0].data); std::string sep; std::string typ = "auto"; if(args.size()>=2){ if(!std::holds_alternative<std::string>(args[1].data)) throw RuntimeError("list_input sep must be string"); sep = std::get<std::string>(args[1].data);} if(args.size()==3){ if(!std::holds_alternative<std::string>(args[2].data)) throw RuntimeError("list_input type must be string"); typ = std::get<std::string>(args[2].data);} std::cout<<prompt; std::cout.flush(); std::string line; std::getline(std::cin, line); // auto sep if empty
-    if(sep.empty()){ if(line.find(',')!=std::string::npos) sep = ","; else sep = ""; }
-    List out;
-    auto trim = [](std::string s){ size_t i=0; while(i<s.size() && std::isspace((unsigned char)s[i])) i++; size_t j=s.size(); while(j>i && std::isspace((unsigned char)s[j-1])) j--; return s.substr(i,j-i); };
-    auto castVal = [&](const std::string& s)->Value{
-        if(typ=="str") return Value(s);
-        if(typ=="int") { try{ return Value((double)std::stoll(s)); } catch(...) { throw RuntimeError("list_input: invalid int"); } }
-        if(typ=="float") { try{ return Value(std::stod(s)); } catch(...) { throw RuntimeError("list_input: invalid float"); } }
-        // auto
-        try{ size_t pos=0; double v = std::stod(s, &pos); if(pos==s.size()) return Value(v); } catch(...){}
-        return Value(s);
-    };
-    if(sep.empty()){
-        std::istringstream iss(line); std::string tok; while(iss>>tok){ tok = trim(tok); out.push_back(castVal(tok)); }
-    } else {
-        size_t pos=0; while(true){ size_t n=line.find(sep, pos); if(n==std::string::npos){ std::string tok = trim(line.substr(pos)); if(!tok.empty()) out.push_back(castVal(tok)); break; } std::string tok = trim(line.substr(pos, n-pos)); if(!tok.empty()) out.push_back(castVal(tok)); pos = n + sep.size(); }
-    }
-    return Value(out);
-}
-
-// Filesystem builtins
-static Value builtin_fs_read_text(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("fs.read_text expects (path)"); std::string p = std::get<std::string>(args[0].data); std::ifstream in(p, std::ios::binary); if(!in) throw RuntimeError("fs.read_text: cannot open file"); std::ostringstream ss; ss<<in.rdbuf(); return Value(ss.str()); }
-static Value builtin_fs_write_text(Interpreter&, const std::vector<Value>& args){ if(args.size()!=2) throw RuntimeError("fs.write_text expects (path, text)"); std::string p = std::get<std::string>(args[0].data); std::string t = std::get<std::string>(args[1].data); std::ofstream out(p, std::ios::binary); if(!out) throw RuntimeError("fs.write_text: cannot open file"); out<<t; return Value(true); }
-static Value builtin_fs_exists(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("fs.exists expects (path)"); std::string p = std::get<std::string>(args[0].data); return Value((bool)std::filesystem::exists(p)); }
-static Value builtin_fs_listdir(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("fs.listdir expects (path)"); std::string p = std::get<std::string>(args[0].data); List out; for(auto& de: std::filesystem::directory_iterator(p)){ out.push_back(Value(de.path().filename().string())); } return Value(out); }
-static Value builtin_fs_mkdirs(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("fs.mkdirs expects (path)"); std::string p = std::get<std::string>(args[0].data); std::filesystem::create_directories(p); return Value(true); }
-static Value builtin_fs_remove(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("fs.remove expects (path)"); std::string p = std::get<std::string>(args[0].data); uintmax_t n=0; std::error_code ec; if(std::filesystem::is_directory(p, ec)) n = std::filesystem::remove_all(p, ec); else { bool ok = std::filesystem::remove(p, ec); n = ok?1:0; } if(ec) throw RuntimeError("fs.remove failed"); return Value((double)n); }
-
-// Content.get: http(s) via WinHTTP; file:// or local path via filesystem
-static Value builtin_content_get(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("content.get expects (source)"); std::string src = std::get<std::string>(args[0].data); Dict resp; resp["source"] = Value(src);
-    auto starts_with = [](const std::string& s, const char* p){ return s.rfind(p,0)==0; };
-    try{
-        if(starts_with(src, "http://") || starts_with(src, "https://") || starts_with(src, "file://")){
-Dict r = http_request("GET", src, std::string(), {});
-            resp["ok"] = Value(true); resp["status"] = r["status"]; resp["text"] = r["text"]; resp["type"] = Value(starts_with(src, "file://")? std::string("file"): std::string("http"));
-            return Value(resp);
-        }
-        // local path fallback
-        if(std::filesystem::exists(src)){
-            std::ifstream in(src, std::ios::binary); if(!in) throw RuntimeError("content.get: cannot open file"); std::ostringstream ss; ss<<in.rdbuf(); resp["ok"] = Value(true); resp["status"] = Value((double)200); resp["text"] = Value(ss.str()); resp["type"] = Value(std::string("file")); return Value(resp);
-        }
-        resp["ok"] = Value(false); resp["status"] = Value((double)404); resp["error"] = Value(std::string("not found")); return Value(resp);
-    } catch(const RuntimeError& e){ resp["ok"] = Value(false); resp["status"] = Value((double)500); resp["error"] = Value(std::string(e.what())); return Value(resp); }
-}
-
-// C execution: compile and run C code with gcc (MinGW) on Windows
-static Value builtin_c_run(Interpreter&, const std::vector<Value>& args){
-    if(args.size()<1 || args.size()>2) throw RuntimeError("c.run expects (code[, args_list])");
-    if(!std::holds_alternative<std::string>(args[0].data)) throw RuntimeError("c.run code must be string");
-    std::string code = std::get<std::string>(args[0].data);
-    std::vector<std::string> runArgs;
-    if(args.size()==2){
-        auto lst = std::get_if<List>(&args[1].data);
-        if(!lst) throw RuntimeError("c.run args must be list of strings");
-        for(const auto& v: *lst){ if(!std::holds_alternative<std::string>(v.data)) throw RuntimeError("c.run args must be strings"); runArgs.push_back(std::get<std::string>(v.data)); }
-    }
-    // Write temp file
-    auto tmpdir = std::filesystem::temp_directory_path();
-#ifdef _WIN32
-    std::string base = (tmpdir / std::filesystem::path("adascript_c_" + std::to_string(::GetCurrentProcessId()) + "_" + std::to_string(::GetTickCount64()))).string();
-    std::string exefile = base + ".exe";
-#else
-    auto now = std::chrono::steady_clock::now().time_since_epoch();
-    long long ticks = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
-    std::string base = (tmpdir / std::filesystem::path("adascript_c_" + std::to_string((long long)getpid()) + "_" + std::to_string(ticks))).string();
-    std::string exefile = base; // no extension needed on Linux
-#endif
-    std::string cfile = base + ".c";
-    {
-        std::ofstream out(cfile, std::ios::binary);
-        if(!out) throw RuntimeError("c.run: cannot create temp .c file");
-        out<<code;
-    }
-    // Compile with gcc
-    std::ostringstream cc;
-    cc<<"gcc \""<<cfile<<"\" -O2 -s -o \""<<exefile<<"\"";
-    int rc_compile = std::system(cc.str().c_str());
-    Dict result; result["exe"] = Value(exefile); result["compile_status"] = Value((double)rc_compile);
-    if(rc_compile!=0){ result["ok"] = Value(false); return Value(result); }
-    // Run the exe; allow it to print to console directly
-    std::ostringstream runCmd;
-    runCmd<<'"'<<exefile<<'"';
-    for(const auto& a: runArgs){ runCmd<<" \""<<a<<"\""; }
-    int rc_run = std::system(runCmd.str().c_str());
-    result["run_status"] = Value((double)rc_run); result["ok"] = Value(true);
-    return Value(result);
-}
-
-// Server stub
-static Value builtin_server_serve(Interpreter&, const std::vector<Value>& args){ throw RuntimeError("server.serve: not implemented in this build"); }
-
-// Native module loader: native.load(path_to_dll_or_so) -> true
-#ifdef _WIN32
-  #include <windows.h>
-#else
-  #include <dlfcn.h>
-#endif
-static Value builtin_native_load(Interpreter& ip, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("native.load expects (path)"); if(!std::holds_alternative<std::string>(args[0].data)) throw RuntimeError("native.load path must be string"); std::string path = std::get<std::string>(args[0].data);
-    // Bridge: registration function that registers native string fns into ip.globals
-    struct Thunk { static Value wrap(AdaScript_NativeStringFn f, void* u, Interpreter& ip, const std::vector<Value>& a){ std::vector<std::string> ss; ss.reserve(a.size()); for(auto& v: a){ std::ostringstream oss; if(auto s=std::get_if<std::string>(&v.data)) oss<<*s; else if(auto n=std::get_if<double>(&v.data)) oss<<*n; else if(auto b=std::get_if<bool>(&v.data)) oss<<(*b?"true":"false"); else if(std::holds_alternative<std::monostate>(v.data)) oss<<"null"; else oss<<"<"<<v.typeName()<<">"; ss.push_back(oss.str()); }
-            std::vector<const char*> cargs; cargs.reserve(ss.size()); for(auto& s: ss) cargs.push_back(s.c_str()); char* out = f(u, cargs.data(), (int)cargs.size()); std::string res = out? std::string(out) : std::string(""); if(out) std::free(out); return Value(res); } };
-    // Provide a C function pointer that forwards to the lambda above
-    struct RegCtx { Interpreter* ip; } ctx{ &ip };
-    auto reg_lambda = [&](const char* name, int arity, AdaScript_NativeStringFn fn, void* user){ auto nf = std::make_shared<NativeFunction>(std::string(name), arity, [fn,user](Interpreter& ip2, const std::vector<Value>& a)->Value{ return Thunk::wrap(fn, user, ip2, a); }); ip.globals->define(name, Value(nf)); };
-    // Static trampoline to match AdaScript_RegisterFn
-    struct RegBridge { static void call(void* vctx, const char* name, int arity, AdaScript_NativeStringFn fn, void* user){ RegCtx* c = (RegCtx*)vctx; Interpreter& ip3 = *c->ip; auto nf = std::make_shared<NativeFunction>(std::string(name), arity, [fn,user](Interpreter& ip2, const std::vector<Value>& a)->Value{ return Thunk::wrap(fn, user, ip2, a); }); ip3.globals->define(name, Value(nf)); } };
-#ifdef _WIN32
-    HMODULE h = LoadLibraryA(path.c_str()); if(!h) throw RuntimeError("native.load: failed to load library");
-    auto init = (AdaScript_ModuleInitFn)GetProcAddress(h, "AdaScript_ModuleInit"); if(!init){ FreeLibrary(h); throw RuntimeError("native.load: AdaScript_ModuleInit not found"); }
-#else
-    void* h = dlopen(path.c_str(), RTLD_NOW); if(!h) throw RuntimeError(std::string("native.load: ")+ dlerror());
-    auto init = (AdaScript_ModuleInitFn)dlsym(h, "AdaScript_ModuleInit"); if(!init){ dlclose(h); throw RuntimeError("native.load: AdaScript_ModuleInit not found"); }
-#endif
-    // Build a function pointer for registration
-    auto c_reg = +[](const char* name, int arity, AdaScript_NativeStringFn fn, void* user){ /* placeholder, replaced by bound with context */ };
-    // Instead, we pass a context via host_ctx and use a bridge that captures ctx
-    // But since AdaScript_RegisterFn doesn't accept context, we provide a thunk via function-static storage
-    // Simpler: provide a small global that stores the active context only during init
-    // Use function-static pointer instead of nested static class for portability
-    static RegCtx* g_active_regctx = nullptr;
-    g_active_regctx = &ctx;
-    auto reg_fn = +[](const char* name, int arity, AdaScript_NativeStringFn fn, void* user){ RegCtx* c = g_active_regctx; RegBridge::call(c, name, arity, fn, user); };
-    int rc = init((AdaScript_RegisterFn)reg_fn, (void*)&ip); if(rc!=0) throw RuntimeError("native.load: init returned error");
-    g_active_regctx = nullptr;
-    return Value(true);
-}
-
-// Process execution: proc.exec(cmd) -> {status, out}
-static Value builtin_proc_exec(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("proc.exec expects (cmd)"); if(!std::holds_alternative<std::string>(args[0].data)) throw RuntimeError("proc.exec cmd must be string"); std::string cmd = std::get<std::string>(args[0].data);
-#ifdef _WIN32
-    std::string full = "cmd /C " + cmd + " 2>&1";
-    FILE* pipe = _popen(full.c_str(), "rt");
-    if(!pipe) throw RuntimeError("proc.exec: failed to start process");
-#else
-    std::string full = cmd + " 2>&1";
-    FILE* pipe = popen(full.c_str(), "r");
-    if(!pipe) throw RuntimeError("proc.exec: failed to start process");
-#endif
-    std::string out; char buf[4096]; while(true){ size_t n = fread(buf, 1, sizeof(buf), pipe); if(n==0) break; out.append(buf, n); }
-#ifdef _WIN32
-    int rc = _pclose(pipe);
-#else
-    int rc = pclose(pipe);
-#endif
-    Dict d; d["status"] = Value((double)rc); d["out"] = Value(out); return Value(d);
-}
-
-Interpreter::Interpreter(const std::filesystem::path& entry_dir){ current_dir = entry_dir; globals->define("print", Value(std::make_shared<NativeFunction>("print", -1, builtin_print))); globals->define("len", Value(std::make_shared<NativeFunction>("len", 1, builtin_len))); globals->define("input", Value(std::make_shared<NativeFunction>("input", 0, builtin_input))); globals->define("map", Value(std::make_shared<NativeFunction>("map", 2, builtin_map))); globals->define("sqrt_bs", Value(std::make_shared<NativeFunction>("sqrt_bs", 1, builtin_sqrt_bs))); globals->define("range", Value(std::make_shared<NativeFunction>("range", -1, builtin_range))); globals->define("int", Value(std::make_shared<NativeFunction>("int", 1, builtin_int))); globals->define("float", Value(std::make_shared<NativeFunction>("float", 1, builtin_float))); globals->define("str", Value(std::make_shared<NativeFunction>("str", 1, builtin_str))); globals->define("split", Value(std::make_shared<NativeFunction>("split", -1, builtin_split))); globals->define("join", Value(std::make_shared<NativeFunction>("join", 2, builtin_join)));
-    // math helpers
-    static auto builtin_abs = [](Interpreter&, const std::vector<Value>& args)->Value{ if(args.size()!=1) throw RuntimeError("abs expects 1 arg"); if(auto n=std::get_if<double>(&args[0].data)) return Value(std::abs(*n)); throw RuntimeError("abs expects number"); };
-    globals->define("abs", Value(std::make_shared<NativeFunction>("abs", 1, builtin_abs)));
-    // container helpers
-    globals->define("has", Value(std::make_shared<NativeFunction>("has", 2, builtin_has)));
-    // input helpers
-    globals->define("list_input", Value(std::make_shared<NativeFunction>("list_input", -1, builtin_list_input)));
-    // namespaced style requests get/post via dict
-    Dict requests; requests["get"] = Value(std::make_shared<NativeFunction>("requests.get", 1, builtin_requests_get)); requests["post"] = Value(std::make_shared<NativeFunction>("requests.post", -1, builtin_requests_post)); requests["request"] = Value(std::make_shared<NativeFunction>("requests.request", -1, builtin_requests_request)); globals->define("requests", Value(requests));
-    // filesystem namespace
-    Dict fs; fs["read_text"] = Value(std::make_shared<NativeFunction>("fs.read_text", 1, builtin_fs_read_text)); fs["write_text"] = Value(std::make_shared<NativeFunction>("fs.write_text", 2, builtin_fs_write_text)); fs["exists"] = Value(std::make_shared<NativeFunction>("fs.exists", 1, builtin_fs_exists)); fs["listdir"] = Value(std::make_shared<NativeFunction>("fs.listdir", 1, builtin_fs_listdir)); fs["mkdirs"] = Value(std::make_shared<NativeFunction>("fs.mkdirs", 1, builtin_fs_mkdirs)); fs["remove"] = Value(std::make_shared<NativeFunction>("fs.remove", 1, builtin_fs_remove)); globals->define("fs", Value(fs));
-    // content namespace
-    Dict content; content["get"] = Value(std::make_shared<NativeFunction>("content.get", 1, builtin_content_get)); globals->define("content", Value(content));
-    // c namespace (C execution)
-    Dict cns; cns["run"] = Value(std::make_shared<NativeFunction>("c.run", -1, builtin_c_run)); globals->define("c", Value(cns));
-Dict server; server["serve"] = Value(std::make_shared<NativeFunction>("server.serve", -1, builtin_server_serve)); globals->define("server", Value(server));
-    // proc namespace (command execution)
-    Dict proc; proc["exec"] = Value(std::make_shared<NativeFunction>("proc.exec", 1, builtin_proc_exec)); globals->define("proc", Value(proc));
-    // native namespace (dynamic plugin loader)
-    Dict native; native["load"] = Value(std::make_shared<NativeFunction>("native.load", 1, [](Interpreter& ip, const std::vector<Value>& a){ return builtin_native_load(ip,a);})); globals->define("native", Value(native)); }
-
-// C API for embedding
-extern "C" {
-struct AdaScriptVM { Interpreter* ip; };
-
-static char* adascript_strdup(const std::string& s){ char* p=(char*)std::malloc(s.size()+1); if(!p) return nullptr; std::memcpy(p, s.c_str(), s.size()+1); return p; }
-
-ADASCRIPT_API AdaScriptVM* AdaScript_Create(const char* entry_dir){ try{ std::filesystem::path p = entry_dir? std::filesystem::path(entry_dir) : std::filesystem::current_path(); auto vm = new AdaScriptVM{ new Interpreter(p) }; return vm; } catch(...){ return nullptr; } }
-
-ADASCRIPT_API void AdaScript_Destroy(AdaScriptVM* vm){ if(!vm) return; delete vm->ip; delete vm; }
-
-static std::string value_to_string(const Value& v){ std::ostringstream oss; if(auto n=std::get_if<double>(&v.data)) oss<<*n; else if(auto s=std::get_if<std::string>(&v.data)) oss<<*s; else if(auto b=std::get_if<bool>(&v.data)) oss<<(*b?"true":"false"); else if(std::holds_alternative<std::monostate>(v.data)) oss<<"null"; else oss<<"<"<<v.typeName()<<">"; return oss.str(); }
-
-ADASCRIPT_API int AdaScript_Eval(AdaScriptVM* vm, const char* source, const char* filename, char** error_message){ if(!vm||!source){ if(error_message) *error_message=adascript_strdup("invalid vm or source"); return 1; } try{ Lexer lx(source); auto tokens=lx.scan(); Parser ps(tokens); auto stmts=ps.parse(); if(filename){ vm->ip->current_dir = std::filesystem::path(filename).parent_path(); } vm->ip->interpret(stmts); return 0; } catch(const RuntimeError& e){ if(error_message) *error_message=adascript_strdup(e.what()); return 2; } catch(const std::exception& e){ if(error_message) *error_message=adascript_strdup(e.what()); return 3; } }
-
-ADASCRIPT_API int AdaScript_RunFile(AdaScriptVM* vm, const char* path, char** error_message){ if(!vm||!path){ if(error_message) *error_message=adascript_strdup("invalid vm or path"); return 1; } try{ std::ifstream in(path, std::ios::binary); if(!in){ if(error_message) *error_message=adascript_strdup("failed to open file"); return 2; } std::ostringstream ss; ss<<in.rdbuf(); std::string src=ss.str(); Lexer lx(src); auto tokens=lx.scan(); Parser ps(tokens); auto stmts=ps.parse(); vm->ip->current_dir = std::filesystem::path(path).parent_path(); vm->ip->interpret(stmts); return 0; } catch(const RuntimeError& e){ if(error_message) *error_message=adascript_strdup(e.what()); return 3; } catch(const std::exception& e){ if(error_message) *error_message=adascript_strdup(e.what()); return 4; } }
-
-ADASCRIPT_API char* AdaScript_Call(AdaScriptVM* vm, const char* func_name, const char* const* args, int argc, char** error_message){ if(!vm||!func_name){ if(error_message) *error_message=adascript_strdup("invalid vm or func_name"); return nullptr; } try{ Value* vptr = vm->ip->globals->getPtr(func_name); if(!vptr) throw RuntimeError(std::string("Undefined function: ")+func_name); std::vector<Value> av; av.reserve((size_t)argc); for(int i=0;i<argc;i++){ av.emplace_back(std::string(args[i]?args[i]:"")); }
-    Value ret;
-    if(auto nf = std::get_if<std::shared_ptr<NativeFunction>>(&vptr->data)){
-        ret = (*nf)->call(*vm->ip, av);
-    } else if(auto uf = std::get_if<std::shared_ptr<Function>>(&vptr->data)){
-        ret = (*uf)->call(*vm->ip, av);
-    } else if(auto kc = std::get_if<std::shared_ptr<Class>>(&vptr->data)){
-        ret = (*kc)->call(*vm->ip, av);
-    } else {
-        throw RuntimeError("Target is not callable");
-    }
-    std::string out = value_to_string(ret); return adascript_strdup(out);
-  } catch(const RuntimeError& e){ if(error_message) *error_message=adascript_strdup(e.what()); return nullptr; } catch(const std::exception& e){ if(error_message) *error_message=adascript_strdup(e.what()); return nullptr; } }
-
-struct _NativeThunk { AdaScript_NativeStringFn fn; void* user; };
-
-ADASCRIPT_API int AdaScript_RegisterNativeStringFn(AdaScriptVM* vm, const char* name, int arity, AdaScript_NativeStringFn fn, void* user_data){ if(!vm||!name||!fn) return 1; try{ auto thunk = std::make_shared<_NativeThunk>(); thunk->fn = fn; thunk->user = user_data; auto wrapper = std::make_shared<NativeFunction>(std::string(name), arity, [thunk](Interpreter&, const std::vector<Value>& args)->Value{
-      std::vector<std::string> sargs; sargs.reserve(args.size()); for(const auto& v: args){ sargs.push_back(value_to_string(v)); }
-      std::vector<const char*> cargs; cargs.reserve(sargs.size()); for(const auto& s: sargs){ cargs.push_back(s.c_str()); }
-      char* res = thunk->fn(thunk->user, cargs.data(), (int)cargs.size());
-      std::string out = res? std::string(res) : std::string("");
-      if(res) std::free(res);
-      return Value(out);
-    });
-    vm->ip->globals->define(name, Value(wrapper));
-    return 0;
-  } catch(...){ return 2; } }
-
-ADASCRIPT_API void AdaScript_FreeString(char* s){ if(s) std::free(s); }
-} // extern "C"
-
-// Main
-#ifndef ADASCRIPT_NO_MAIN
-int main(int argc, char** argv){ std::ios::sync_with_stdio(false); std::cin.tie(nullptr);
-    if(argc<2){ std::cerr<<"Usage: adascript [--built-ins-location <dir>] <file.ad>\n"; return 1; }
-    // Parse options
-    int argi = 1; std::string script;
-    std::string builtinsLoc;
-    while(argi < argc){ std::string a = argv[argi]; if(a == "--built-ins-location"){ if(argi+1>=argc){ std::cerr<<"Missing value for --built-ins-location\n"; return 1; } builtinsLoc = argv[++argi]; argi++; continue; } else { script = a; argi++; break; } }
-    if(script.empty()){ std::cerr<<"Missing script file\n"; return 1; }
-    std::ifstream in(script, std::ios::binary); if(!in){ std::cerr<<"Failed to open: "<<script<<"\n"; return 1; }
-    std::ostringstream ss; ss<<in.rdbuf(); std::string src = ss.str();
-    try{
-        Lexer lx(src); auto tokens = lx.scan(); Parser ps(tokens); auto stmts = ps.parse(); std::filesystem::path entry = std::filesystem::path(script).parent_path(); Interpreter ip(entry);
-        // Resolve builtins directory: either provided or alongside executable (../builtins)
-        if(!builtinsLoc.empty()){
-            ip.builtins_dir = builtinsLoc;
-        } else {
-            try{
-                std::filesystem::path exe = std::filesystem::absolute(argv[0]);
-                std::filesystem::path exeDir = exe.parent_path();
-                std::vector<std::filesystem::path> candidates = {
-                    exeDir / "builtins",
-                    exeDir.parent_path() / "builtins",
-                    exeDir.parent_path() / "dist" / "windows" / "builtins",
-                    std::filesystem::current_path() / "builtins"
-                };
-                for(const auto& cand : candidates){
-                    if(std::filesystem::exists(cand)) { ip.builtins_dir = cand.string(); break; }
-                }
-            } catch(...){ /* ignore */ }
-        }
-        ip.interpret(stmts);
-    } catch(const RuntimeError& e){ std::cerr<<"Error: "<<e.what()<<"\n"; return 1; }
-    return 0; }
-#endif
-
+/*
+AdaScript
+(C) 2025 Afif Ali Saadman, Chief Author of AdaScript
+License: LGPL
+*/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <variant>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <unordered_set>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+#include <mutex>
+#include <string_view>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <exception>
+#include <charconv>
+#include <thread>
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <csignal>
+#include <condition_variable>
+#endif
+#ifndef _WIN32
+  #ifndef ADASCRIPT_NO_CURL
+    #include <curl/curl.h>
+    #include <mutex>
+  #endif
+#endif
+#include "AdaScript.h"
+
+// Forward declarations
+struct Value;
+struct Environment;
+struct Expr;
+struct Stmt;
+struct Proto;
+class Interpreter;
+
+using Ptr = std::shared_ptr<void>;
+
+// Interned name. Identifiers and property names are interned once (by the lexer, or when natives are registered);
+// a Symbol points at the canonical copy, so comparing or hashing one is a single word operation. The table is
+// process-wide and only grows, so Symbols stay valid across interpreters and threads.
+class Symbol {
+    const std::string* s;
+    static const std::string* intern(std::string_view v){ static std::mutex mu; static std::unordered_set<std::string> table;
+        std::lock_guard<std::mutex> lock(mu); return &*table.emplace(v).first; }
+public:
+    Symbol(){ static const std::string* empty = intern({}); s = empty; }
+    Symbol(std::string_view v): s(intern(v)) {}
+    Symbol(const std::string& v): s(intern(v)) {}
+    Symbol(const char* v): s(intern(v)) {}
+    const std::string& str() const { return *s; }
+    bool operator==(Symbol o) const { return s==o.s; }
+    bool operator!=(Symbol o) const { return s!=o.s; }
+    bool operator==(const char* o) const { return *s==o; } // by content, without interning o
+    size_t hash() const { return std::hash<const void*>()(s); }
+};
+template<> struct std::hash<Symbol> { size_t operator()(Symbol v) const noexcept { return v.hash(); } };
+inline std::string operator+(const std::string& a, Symbol b){ return a + b.str(); }
+inline std::string operator+(const char* a, Symbol b){ return a + b.str(); }
+
+// Heap objects reachable from a Value carry an intrusive reference count, so a handle is a single pointer.
+// The count is not atomic: objects belong to the interpreter that created them. Immortal objects are the exception:
+// their count is never written, so interpreters on different threads can share them.
+struct Object { static constexpr uint32_t kImmortal = 0xFFFFFFFFu; // never counted or freed (see literalString)
+    uint32_t refs = 0; bool gcTracked = false; Object() = default; Object(const Object&) {} Object& operator=(const Object&){ return *this; } virtual ~Object() = default; };
+
+// Handle to an Object subclass. It stores the Object* so copies and destruction work while T is still incomplete.
+template<typename T> class Ref {
+    Object* o = nullptr;
+    void retain() const { if(o && o->refs != Object::kImmortal) ++o->refs; }
+    void release(){ if(o && o->refs != Object::kImmortal && --o->refs==0) delete o; }
+public:
+    Ref() = default;
+    Ref(std::nullptr_t) {}
+    explicit Ref(T* p): o(p) { retain(); }
+    Ref(const Ref& r): o(r.o) { retain(); }
+    Ref(Ref&& r) noexcept: o(r.o) { r.o = nullptr; }
+    Ref& operator=(Ref r) noexcept { std::swap(o, r.o); return *this; }
+    ~Ref(){ release(); }
+    T* get() const { return static_cast<T*>(o); }
+    Object* object() const { return o; }
+    T* operator->() const { return get(); }
+    T& operator*() const { return *get(); }
+    explicit operator bool() const { return o!=nullptr; }
+    bool operator==(const Ref& r) const { return o==r.o; }
+    bool operator!=(const Ref& r) const { return o!=r.o; }
+};
+template<typename T, typename... A> Ref<T> makeRef(A&&... a){ return Ref<T>(new T(std::forward<A>(a)...)); }
+
+// Value type. Numbers, bools and null are immediate; strings, lists, dicts, functions, classes and instances are
+// refcounted heap objects shared by reference: copying a Value never copies the string or container.
+using List = std::vector<Value>;
+using Dict = std::unordered_map<std::string, Value>;
+
+struct StrObj : Object { const std::string s; // immutable
+    explicit StrObj(std::string v, bool immortal=false); ~StrObj() override; size_t bytes() const { return sizeof(StrObj) + s.size(); } };
+struct ListObj;
+struct DictObj;
+struct Function; // user-defined
+struct NativeFunction; // builtin
+struct Class;
+struct Instance;
+struct NativeObject; // instance of a type implemented in C++
+
+using ValueData = std::variant<std::monostate, bool, double, Ref<StrObj>, Ref<ListObj>, Ref<DictObj>,
+                               Ref<Function>, Ref<NativeFunction>, Ref<Class>, Ref<Instance>, Ref<NativeObject>>;
+
+struct Value {
+    ValueData data;
+
+    Value() : data(std::monostate{}) {}
+    Value(bool b) : data(b) {}
+    Value(double n) : data(n) {}
+    Value(std::string s) : data(makeRef<StrObj>(std::move(s))) {}
+    Value(const char* s) : Value(std::string(s)) {}
+    Value(List l);
+    Value(Dict d);
+    template<typename T> Value(Ref<T> r) : data(std::move(r)) {}
+
+    List* asList() const;
+    Dict* asDict() const;
+    const std::string* asString() const { auto p = std::get_if<Ref<StrObj>>(&data); return p? &(*p)->s : nullptr; }
+    bool isString() const { return std::holds_alternative<Ref<StrObj>>(data); }
+    const std::string& str() const; // throws RuntimeError unless this is a string
+
+    bool isNull() const { return std::holds_alternative<std::monostate>(data); }
+    std::string typeName() const {
+        if (std::holds_alternative<std::monostate>(data)) return "null";
+        if (std::holds_alternative<bool>(data)) return "bool";
+        if (std::holds_alternative<double>(data)) return "number";
+        if (std::holds_alternative<Ref<StrObj>>(data)) return "string";
+        if (std::holds_alternative<Ref<ListObj>>(data)) return "list";
+        if (std::holds_alternative<Ref<DictObj>>(data)) return "dict";
+        if (std::holds_alternative<Ref<Function>>(data)) return "function";
+        if (std::holds_alternative<Ref<NativeFunction>>(data)) return "native";
+        if (std::holds_alternative<Ref<Class>>(data)) return "class";
+        if (std::holds_alternative<Ref<Instance>>(data)) return "instance";
+        if (std::holds_alternative<Ref<NativeObject>>(data)) return "instance"; // native containers stand in for script classes
+        return "unknown";
+    }
+};
+static_assert(sizeof(Value)==16, "Value should stay a 16-byte tagged handle");
+
+// String literals of parsed code are interned, immortal StrObjs. Copying one out of the AST touches no refcount, so
+// parsed modules and programs can be shared by interpreters on different threads. They are never freed: the table
+// grows only with distinct literal texts.
+static Value literalString(const std::string& s){ static std::mutex mu; static std::unordered_map<std::string, StrObj*> table;
+    std::lock_guard<std::mutex> lock(mu); StrObj*& o = table[s]; if(!o) o = new StrObj(s, true); return Value(Ref<StrObj>(o)); }
+
+// Cycle collector. Reference counting frees most objects as soon as they become unreachable; objects that can take
+// part in a cycle (lists, dicts, functions, classes, instances, environments) are additionally tracked in three
+// generations. A collection uses trial deletion: references held by other tracked objects are subtracted from each
+// refcount, and whatever is not reachable from an object with an outside reference is garbage. No root scan is
+// needed, so Values held on the C++ stack or captured by native functions are always treated as live.
+using GcVisit = void(*)(Object*, void*);
+struct GcLink { GcLink* prev = this; GcLink* next = this; };
+struct GcObject : Object, GcLink {
+    int64_t gcRefs = 0; uint8_t gen = 0; uint8_t gcState = 0;
+    explicit GcObject(size_t bytes = 0); // 'bytes': storage charged to the heap along with the object
+    GcObject(const GcObject&): GcObject() {}
+    ~GcObject() override;
+    virtual void traverse(GcVisit visit, void* ctx) = 0; // report every Object this one references
+    virtual void clearRefs() = 0;                         // drop those references (breaks a garbage cycle)
+};
+inline void gcTraverse(const Value& v, GcVisit visit, void* ctx){
+    std::visit([&](const auto& x){ using T = std::decay_t<decltype(x)>; if constexpr (!std::is_same_v<T, std::monostate> && !std::is_same_v<T, bool> && !std::is_same_v<T, double>){ if(x) visit(x.object(), ctx); } }, v.data); }
+
+struct GcHeap {
+    static constexpr int kGenerations = 3;
+    struct Generation { GcLink head; int threshold; int count = 0; uint64_t collections = 0; };
+    // gen 0 counts allocations minus frees since its last collection; older generations count collections of the
+    // next younger one, as in CPython
+    Generation gens[kGenerations] = {{{}, 700}, {{}, 10}, {{}, 10}};
+    bool enabled = true, collecting = false;
+    uint64_t allocated = 0, freed = 0, collected = 0; size_t tracked = 0;
+    // Approximate bytes held by this heap's strings, containers and objects, and the cap on it (0: none). Allocations
+    // past the cap first run a full collection, then fail with a RuntimeError.
+    size_t bytes = 0, byteLimit = 0;
+    static constexpr size_t kObjectBytes = 96; // charged per tracked object, a typical instance or environment
+    void charge(size_t n);
+    void discharge(size_t n){ bytes -= std::min(bytes, n); }
+
+    // Each thread has its own heap and objects never migrate between threads; a thread that runs script code on
+    // behalf of another (server.serve workers, under a lock) adopts that thread's heap with GcHeapScope
+    static GcHeap*& active(){ thread_local GcHeap own; thread_local GcHeap* heap = &own; return heap; }
+    static GcHeap& current(){ return *active(); }
+    ~GcHeap(){ teardown(); }
+    void teardown(); // frees what the heap still tracks when its owner (a VM or a thread) goes away
+
+    // Takes an object out of collection for good: it is frozen into a snapshot and freed by it (see Snapshot)
+    void untrack(GcObject* o);
+    static void unlink(GcLink* l){ l->prev->next = l->next; l->next->prev = l->prev; l->prev = l->next = l; }
+    static void append(GcLink* list, GcLink* l){ l->prev = list->prev; l->next = list; list->prev->next = l; list->prev = l; }
+    static void splice(GcLink* from, GcLink* to){ if(from->next == from) return; from->next->prev = to->prev; to->prev->next = from->next; from->prev->next = to; to->prev = from->prev; from->prev = from->next = from; }
+
+    void maybeCollect(){
+        if(!enabled || collecting || gens[0].count < gens[0].threshold) return;
+        int g = 0; while(g+1 < kGenerations && gens[g+1].count + 1 >= gens[g+1].threshold) ++g; // oldest generation due
+        collect(g);
+    }
+
+    // Collects generations 0..g and returns the number of objects freed
+    size_t collect(int g){
+        enum : uint8_t { Idle, Collecting, Tentative };
+        collecting = true;
+        GcLink young; for(int i=0;i<=g;++i) splice(&gens[i].head, &young);
+        for(GcLink* l = young.next; l != &young; l = l->next){ auto o = static_cast<GcObject*>(l); o->gcRefs = o->refs; o->gcState = Collecting; }
+        // subtract references that come from objects in this collection
+        for(GcLink* l = young.next; l != &young; l = l->next) static_cast<GcObject*>(l)->traverse([](Object* c, void*){
+            if(c->gcTracked){ auto o = static_cast<GcObject*>(c); if(o->gcState == Collecting) --o->gcRefs; } }, nullptr);
+        // objects left with outside references are live, and so is everything they reach
+        GcLink unreachable;
+        for(GcLink* l = young.next; l != &young;){
+            auto o = static_cast<GcObject*>(l);
+            // read next only after traversing: objects rescued here are appended to the tail, possibly right after o
+            if(o->gcRefs > 0){ o->traverse([](Object* c, void* yv){ if(!c->gcTracked) return; auto r = static_cast<GcObject*>(c);
+                if(r->gcState == Tentative){ unlink(r); append(static_cast<GcLink*>(yv), r); r->gcState = Collecting; r->gcRefs = 1; }
+                else if(r->gcState == Collecting && r->gcRefs == 0) r->gcRefs = 1; }, &young); l = l->next; }
+            else { GcLink* next = l->next; unlink(l); append(&unreachable, l); o->gcState = Tentative; l = next; }
+        }
+        int older = g+1 < kGenerations? g+1 : g;
+        for(GcLink* l = young.next; l != &young; l = l->next){ auto o = static_cast<GcObject*>(l); o->gcState = Idle; o->gen = (uint8_t)older; }
+        splice(&young, &gens[older].head);
+        // keep the garbage alive while its references are cleared, then let refcounting free it
+        std::vector<Ref<GcObject>> garbage;
+        for(GcLink* l = unreachable.next; l != &unreachable; l = l->next){ auto o = static_cast<GcObject*>(l); o->gcState = Idle; o->gen = (uint8_t)older; garbage.emplace_back(o); }
+        splice(&unreachable, &gens[older].head);
+        for(auto& o: garbage) o->clearRefs();
+        size_t n = garbage.size(); garbage.clear();
+        for(int i=0;i<=g;++i){ gens[i].count = 0; gens[i].collections++; }
+        if(g+1 < kGenerations) gens[g+1].count++;
+        collected += n; collecting = false;
+        return n;
+    }
+};
+struct GcHeapScope {
+    GcHeap* saved;
+    explicit GcHeapScope(GcHeap& h): saved(GcHeap::active()) { GcHeap::active() = &h; }
+    ~GcHeapScope(){ GcHeap::active() = saved; }
+    GcHeapScope(const GcHeapScope&) = delete; GcHeapScope& operator=(const GcHeapScope&) = delete;
+};
+// Suspends automatic collection while native code builds a large fresh tree (e.g. json.parse): such a tree holds no
+// cycles, and collecting halfway through would only traverse objects that are all still referenced
+struct GcPause {
+    GcHeap& heap; bool saved;
+    GcPause(): heap(GcHeap::current()), saved(heap.enabled) { heap.enabled = false; }
+    ~GcPause(){ heap.enabled = saved; }
+    GcPause(const GcPause&) = delete; GcPause& operator=(const GcPause&) = delete;
+};
+
+// Garbage cycles are collected. Survivors are referenced from outside the heap (an unreleased value handle, a value
+// kept by native code): their references are dropped, which frees cycles among them, and whatever is still alive is
+// untracked, so releasing it later never touches this heap, or debits another thread's.
+inline void GcHeap::teardown(){ if(!tracked) return; GcHeapScope hs(*this); enabled = false; collect(kGenerations-1);
+    std::vector<Ref<GcObject>> rest;
+    for(auto& g: gens) for(GcLink* l = g.head.next; l != &g.head; l = l->next){ auto o = static_cast<GcObject*>(l); if(o->refs != Object::kImmortal) rest.emplace_back(o); }
+    for(auto& o: rest) o->clearRefs();
+    rest.clear();
+    for(auto& g: gens) while(g.head.next != &g.head) untrack(static_cast<GcObject*>(g.head.next)); }
+
+// Charging may run a collection, which is only safe before 'this' is tracked: untracked, a fresh object with no
+// references yet can't be mistaken for garbage
+inline GcObject::GcObject(size_t bytes){ auto& h = GcHeap::current(); h.charge(GcHeap::kObjectBytes + bytes); h.maybeCollect(); gcTracked = true; GcHeap::append(&h.gens[0].head, this); h.gens[0].count++; h.allocated++; h.tracked++; }
+inline void GcHeap::untrack(GcObject* o){ unlink(o); if(o->gen==0 && gens[0].count > 0) gens[0].count--; tracked--; discharge(kObjectBytes); o->gcTracked = false; }
+inline GcObject::~GcObject(){ if(!gcTracked) return; auto& h = GcHeap::current(); GcHeap::unlink(this); if(gen==0 && h.gens[0].count > 0) h.gens[0].count--; h.freed++; h.tracked--; h.discharge(GcHeap::kObjectBytes); }
+inline StrObj::StrObj(std::string v, bool immortal): s(std::move(v)) { if(immortal) refs = kImmortal; else GcHeap::current().charge(bytes()); }
+inline StrObj::~StrObj(){ if(refs != kImmortal) GcHeap::current().discharge(bytes()); }
+
+// Containers charge their storage to the heap: when created, and through account() after growing in place
+struct ListObj : GcObject { List items; size_t charged; explicit ListObj(List l): GcObject(storage(l)), items(std::move(l)), charged(storage(items)) {}
+    ~ListObj() override { if(gcTracked) GcHeap::current().discharge(charged); }
+    static size_t storage(const List& l){ return l.capacity()*sizeof(Value); }
+    void account(){ size_t n = storage(items); if(n > charged){ GcHeap::current().charge(n - charged); charged = n; } }
+    void traverse(GcVisit visit, void* ctx) override { for(const auto& v: items) gcTraverse(v, visit, ctx); }
+    void clearRefs() override { List().swap(items); } };
+struct DictObj : GcObject { Dict items; size_t charged; explicit DictObj(Dict d): GcObject(storage(d)), items(std::move(d)), charged(storage(items)) {}
+    ~DictObj() override { if(gcTracked) GcHeap::current().discharge(charged); }
+    static size_t storage(const Dict& d){ return d.size()*(sizeof(Dict::value_type) + 16) + d.bucket_count()*sizeof(void*); }
+    void account(){ size_t n = storage(items); if(n > charged){ GcHeap::current().charge(n - charged); charged = n; } }
+    void traverse(GcVisit visit, void* ctx) override { for(const auto& kv: items) gcTraverse(kv.second, visit, ctx); }
+    void clearRefs() override { Dict().swap(items); } };
+inline Value::Value(List l) : data(makeRef<ListObj>(std::move(l))) {}
+inline Value::Value(Dict d) : data(makeRef<DictObj>(std::move(d))) {}
+inline List* Value::asList() const { auto p = std::get_if<Ref<ListObj>>(&data); return p? &(*p)->items : nullptr; }
+inline Dict* Value::asDict() const { auto p = std::get_if<Ref<DictObj>>(&data); return p? &(*p)->items : nullptr; }
+
+struct RuntimeError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+inline void GcHeap::charge(size_t n){ if(byteLimit && bytes + n > byteLimit){ if(enabled && !collecting) collect(kGenerations-1);
+        if(bytes + n > byteLimit) throw RuntimeError("Memory limit exceeded (" + std::to_string(byteLimit) + " bytes)"); } bytes += n; }
+
+// Console output is shared by every interpreter in the process: each message is written whole under one lock, so
+// lines from VMs on different threads never interleave
+static void writeConsole(std::ostream& os, const std::string& s){ static std::mutex mu; std::lock_guard<std::mutex> lock(mu); os<<s; os.flush(); }
+
+inline const std::string& Value::str() const { if(auto s = asString()) return *s; throw RuntimeError("Expected string, got "+typeName()); }
+
+// Lexer
+enum class TokenType {
+    // Single-char
+    LEFT_PAREN, RIGHT_PAREN, LEFT_BRACE, RIGHT_BRACE,
+    LEFT_BRACKET, RIGHT_BRACKET,
+    COMMA, DOT, SEMICOLON, COLON,
+    PLUS, MINUS, STAR, SLASH, PERCENT,
+    BANG, EQUAL, LESS, GREATER,
+
+    // Two-char
+    BANG_EQUAL, EQUAL_EQUAL, LESS_EQUAL, GREATER_EQUAL,
+    AND_AND, OR_OR,
+
+    // Literals
+    IDENTIFIER, STRING, NUMBER,
+
+    // Keywords
+    LET, FUNC, CLASS, RETURN, IF, ELSE, WHILE, FOR, TRUE, FALSE, NULL_T,
+    THIS, STRUCT, UNION, NEW, IMPORT, IN, BREAK, CONTINUE,
+    // Textual operators
+    NOT_KW, AND_KW, OR_KW, EQUALS_KW,
+
+    END_OF_FILE
+};
+
+struct Token { TokenType type; std::string lexeme; int line; int col; Symbol sym{}; }; // sym: interned lexeme of identifiers
+
+struct Lexer {
+    std::string src; size_t start=0, current=0; int line=1, col=1;
+    std::vector<Token> tokens;
+
+    explicit Lexer(std::string s): src(std::move(s)) {}
+
+    static bool isAlpha(char c){return std::isalpha((unsigned char)c)||c=='_';}
+    static bool isAlnum(char c){return isAlpha(c)||std::isdigit((unsigned char)c);}    
+    bool isAtEnd() const { return current >= src.size(); }
+    char advance(){ char c=src[current++]; if(c=='\n'){line++; col=1;} else col++; return c;}
+    bool match(char expected){ if(isAtEnd()||src[current]!=expected) return false; current++; col++; return true; }
+    char peek() const { return isAtEnd()? '\0': src[current];}
+    char peekNext() const { return (current+1>=src.size())? '\0': src[current+1];}
+    void add(TokenType t){ tokens.push_back({t, src.substr(start, current-start), line, col}); }
+
+    void string(){ int l = line, c = col - 1; while(!isAtEnd() && peek()!='"'){ advance(); }
+        if(isAtEnd()){ throw RuntimeError("Unterminated string starting at line "+std::to_string(l)+", col "+std::to_string(c)); } advance(); // closing quote
+        std::string value = src.substr(start+1, (current-1)-(start+1));
+        tokens.push_back({TokenType::STRING, value, line, col}); }
+    void number(){ while(std::isdigit((unsigned char)peek())) advance(); if(peek()=='.' && std::isdigit((unsigned char)peekNext())){ advance(); while(std::isdigit((unsigned char)peek())) advance(); }
+        tokens.push_back({TokenType::NUMBER, src.substr(start, current-start), line, col}); }
+void identifier(){ while(isAlnum(peek())) advance(); std::string text = src.substr(start, current-start);
+        static std::unordered_map<std::string, TokenType> kw = {
+            {"let",TokenType::LET},{"func",TokenType::FUNC},{"class",TokenType::CLASS},{"return",TokenType::RETURN},
+            {"if",TokenType::IF},{"else",TokenType::ELSE},{"while",TokenType::WHILE},{"for",TokenType::FOR},
+            {"true",TokenType::TRUE},{"false",TokenType::FALSE},{"null",TokenType::NULL_T},{"this",TokenType::THIS},{"break",TokenType::BREAK},{"continue",TokenType::CONTINUE},
+            {"struct",TokenType::STRUCT},{"union",TokenType::UNION},{"new",TokenType::NEW},
+            {"import",TokenType::IMPORT},{"in",TokenType::IN},
+            // textual operators mapped to dedicated token types
+            {"not",TokenType::NOT_KW},{"and",TokenType::AND_KW},{"or",TokenType::OR_KW},{"equals",TokenType::EQUALS_KW}
+        };
+        auto it=kw.find(text); if(it!=kw.end()) tokens.push_back({it->second,text,line,col}); else tokens.push_back({TokenType::IDENTIFIER,text,line,col,Symbol(text)}); }
+
+    std::vector<Token> scan(){
+        while(!isAtEnd()){
+            start=current; char c=advance();
+            switch(c){
+                case '(': add(TokenType::LEFT_PAREN); break;
+                case ')': add(TokenType::RIGHT_PAREN); break;
+                case '{': add(TokenType::LEFT_BRACE); break;
+                case '}': add(TokenType::RIGHT_BRACE); break;
+                case '[': add(TokenType::LEFT_BRACKET); break;
+                case ']': add(TokenType::RIGHT_BRACKET); break;
+                case ',': add(TokenType::COMMA); break;
+                case '.': add(TokenType::DOT); break;
+                case ';': add(TokenType::SEMICOLON); break;
+                case ':': add(TokenType::COLON); break;
+                case '+': add(TokenType::PLUS); break;
+                case '-': add(TokenType::MINUS); break;
+                case '*': add(TokenType::STAR); break;
+                case '%': add(TokenType::PERCENT); break;
+                case '!': add(match('=')?TokenType::BANG_EQUAL:TokenType::BANG); break;
+                case '=': add(match('=')?TokenType::EQUAL_EQUAL:TokenType::EQUAL); break;
+                case '<': add(match('=')?TokenType::LESS_EQUAL:TokenType::LESS); break;
+                case '>': add(match('=')?TokenType::GREATER_EQUAL:TokenType::GREATER); break;
+                case '/': if(match('/')){ while(peek()!='\n' && !isAtEnd()) advance(); } else add(TokenType::SLASH); break;
+                case '&': if(match('&')) add(TokenType::AND_AND); else throw RuntimeError("Unexpected '&'"); break;
+                case '|': if(match('|')) add(TokenType::OR_OR); else throw RuntimeError("Unexpected '|'"); break;
+                case ' ': case '\r': case '\t': /* skip */ break;
+                case '\n': /* handled in advance */ break;
+                case '"': string(); break;
+                default:
+                    if(std::isdigit((unsigned char)c)) number();
+                    else if(isAlpha(c)) identifier();
+                    else throw RuntimeError("Unexpected character");
+            }
+        }
+        tokens.push_back({TokenType::END_OF_FILE, "", line, col});
+        return tokens;
+    }
+};
+
+// AST definitions (minimal)
+// Where a name lives, filled in by the Resolver: 'depth' Environment hops up, then 'slot'; slot -1 means the globals table
+struct Binding { int depth=0; int slot=-1; bool isGlobal() const { return slot<0; } };
+
+// Inline cache of a property site: up to four (shape id -> field slot | Method + method index) entries.
+// Entries are packed into one word so a reader never sees a half-written entry.
+struct PropertyCache { enum : uint32_t { Method = 0x80000000u };
+    std::atomic<uint64_t> entries[4];
+    PropertyCache(){ for(auto& e: entries) e.store(0, std::memory_order_relaxed); }
+    bool find(uint32_t shape, uint32_t& hit) const { for(const auto& e: entries){ uint64_t v = e.load(std::memory_order_relaxed); if((uint32_t)(v>>32)==shape){ hit = (uint32_t)v; return true; } } return false; }
+    void add(uint32_t shape, uint32_t hit){ uint64_t v = (uint64_t)shape<<32 | hit;
+        for(auto& e: entries) if(e.load(std::memory_order_relaxed)==0){ e.store(v, std::memory_order_relaxed); return; }
+        entries[shape&3].store(v, std::memory_order_relaxed); } // megamorphic: evict
+};
+
+struct Expr { virtual ~Expr()=default; };
+struct Stmt { virtual ~Stmt()=default; };
+using ExprPtr = std::shared_ptr<Expr>;
+using StmtPtr = std::shared_ptr<Stmt>;
+
+struct LiteralExpr : Expr { Value value; explicit LiteralExpr(Value v): value(std::move(v)){} };
+struct VarExpr : Expr { Symbol name; Binding at; explicit VarExpr(Symbol n): name(n){} };
+struct AssignExpr : Expr { Symbol name; ExprPtr value; Binding at; AssignExpr(Symbol n, ExprPtr v): name(n), value(std::move(v)){} };
+struct BinaryExpr : Expr { ExprPtr left; Token op; ExprPtr right; BinaryExpr(ExprPtr l, Token o, ExprPtr r): left(std::move(l)), op(std::move(o)), right(std::move(r)){} };
+struct UnaryExpr : Expr { Token op; ExprPtr right; UnaryExpr(Token o, ExprPtr r): op(std::move(o)), right(std::move(r)){} };
+struct GroupingExpr : Expr { ExprPtr expr; explicit GroupingExpr(ExprPtr e): expr(std::move(e)){} };
+struct CallExpr : Expr { ExprPtr callee; std::vector<ExprPtr> args; CallExpr(ExprPtr c, std::vector<ExprPtr>a): callee(std::move(c)), args(std::move(a)){} };
+struct GetExpr : Expr { ExprPtr object; Symbol name; PropertyCache cache; GetExpr(ExprPtr o, Symbol n): object(std::move(o)), name(n){} };
+struct SetExpr : Expr { ExprPtr object; Symbol name; ExprPtr value; PropertyCache cache; SetExpr(ExprPtr o,Symbol n,ExprPtr v):object(std::move(o)),name(n),value(std::move(v)){} };
+struct IndexExpr : Expr { ExprPtr object; ExprPtr index; IndexExpr(ExprPtr o, ExprPtr i): object(std::move(o)), index(std::move(i)){} };
+struct SetIndexExpr : Expr { ExprPtr object; ExprPtr index; ExprPtr value; SetIndexExpr(ExprPtr o, ExprPtr i, ExprPtr v): object(std::move(o)), index(std::move(i)), value(std::move(v)){} };
+
+struct ExprStmt : Stmt { ExprPtr expr; explicit ExprStmt(ExprPtr e): expr(std::move(e)){} };
+struct LetStmt : Stmt { Symbol name; ExprPtr initializer; Binding at; LetStmt(Symbol n, ExprPtr i): name(n), initializer(std::move(i)){} };
+struct BlockStmt : Stmt { std::vector<StmtPtr> stmts; int frameSize=0; // >0: runs in its own Environment (see Resolver)
+    explicit BlockStmt(std::vector<StmtPtr> s): stmts(std::move(s)){} };
+struct IfStmt : Stmt { ExprPtr cond; StmtPtr thenB; std::optional<StmtPtr> elseB; IfStmt(ExprPtr c, StmtPtr t, std::optional<StmtPtr> e): cond(std::move(c)), thenB(std::move(t)), elseB(std::move(e)){} };
+struct WhileStmt : Stmt { ExprPtr cond; StmtPtr body; WhileStmt(ExprPtr c, StmtPtr b): cond(std::move(c)), body(std::move(b)){} };
+struct ReturnStmt : Stmt { std::optional<ExprPtr> value; explicit ReturnStmt(std::optional<ExprPtr> v): value(std::move(v)){} };
+struct BreakStmt : Stmt {};
+struct ContinueStmt : Stmt {};
+
+struct FunctionStmt : Stmt { Symbol name; std::vector<std::string> params; std::shared_ptr<BlockStmt> body; Binding at; int frameSize=0; };
+struct ClassStmt : Stmt { Symbol name; std::unordered_map<Symbol, std::shared_ptr<FunctionStmt>> methods; Binding at; };
+struct StructStmt : Stmt { Symbol name; std::vector<std::string> fields; Binding at; };
+struct UnionStmt : Stmt { Symbol name; std::vector<std::string> tags; Binding at; };
+struct ForStmt : Stmt { Symbol var; ExprPtr iterable; StmtPtr body; Binding at; ForStmt(Symbol v, ExprPtr it, StmtPtr b): var(v), iterable(std::move(it)), body(std::move(b)){} };
+struct ImportStmt : Stmt { std::string path; explicit ImportStmt(std::string p): path(std::move(p)){} };
+struct MultiAssignStmt : Stmt { std::vector<Symbol> names; ExprPtr value; std::vector<Binding> at; MultiAssignStmt(std::vector<Symbol> n, ExprPtr v): names(std::move(n)), value(std::move(v)){} };
+struct MultiLetStmt : Stmt { std::vector<Symbol> names; std::vector<Binding> at; explicit MultiLetStmt(std::vector<Symbol> n): names(std::move(n)){} };
+
+// Parser (simplified)
+struct Parser {
+    const std::vector<Token>& tokens; size_t current=0; int loopDepth=0; // enclosing loops of the current function
+    explicit Parser(const std::vector<Token>& ts): tokens(ts) {}
+
+    bool isAtEnd() const { return peek().type==TokenType::END_OF_FILE; }
+    const Token& peek() const { return tokens[current]; }
+    const Token& previous() const { return tokens[current-1]; }
+    bool check(TokenType t) const { return !isAtEnd() && peek().type==t; }
+    const Token& advance(){ if(!isAtEnd()) current++; return previous(); }
+    bool match(std::initializer_list<TokenType> types){ for(auto t: types){ if(check(t)){ advance(); return true; } } return false; }
+const Token& consume(TokenType t, const char* msg){ if(check(t)) return advance();
+        std::ostringstream emsg; emsg<<msg<<" at line "<<peek().line<<", col "<<peek().col; throw RuntimeError(emsg.str()); }
+
+    std::vector<StmtPtr> parse(){ std::vector<StmtPtr> stmts; while(!isAtEnd()) stmts.push_back(declaration()); return stmts; }
+
+    StmtPtr declaration(){
+        if(match({TokenType::LET})) return letDecl();
+        if(match({TokenType::FUNC})) return funcDecl();
+        if(match({TokenType::CLASS})) return classDecl();
+        if(match({TokenType::STRUCT})) return structDecl();
+        if(match({TokenType::UNION})) return unionDecl();
+        if(match({TokenType::IMPORT})) return importStmt();
+        return statement();
+    }
+
+    StmtPtr letDecl(){
+        // Support: let a;  let a = expr;  let a,b,c = expr;
+        std::vector<Symbol> names;
+        names.push_back(consume(TokenType::IDENTIFIER, "Expected variable name").lexeme);
+        while(match({TokenType::COMMA})){
+            names.push_back(consume(TokenType::IDENTIFIER, "Expected variable name").lexeme);
+        }
+        if(match({TokenType::EQUAL})){
+            auto init = expression();
+            consume(TokenType::SEMICOLON, "Expected ';'");
+            if(names.size()==1) return std::make_shared<LetStmt>(names[0], init);
+            return std::make_shared<MultiAssignStmt>(std::move(names), init);
+        }
+        // No initializer -> define as null
+        consume(TokenType::SEMICOLON, "Expected ';'");
+        if(names.size()==1) return std::make_shared<LetStmt>(names[0], std::make_shared<LiteralExpr>(Value()));
+        return std::make_shared<MultiLetStmt>(std::move(names));
+    }
+
+    std::shared_ptr<FunctionStmt> functionBody(std::string name){
+        consume(TokenType::LEFT_PAREN, "Expected '('"); std::vector<std::string> params; if(!check(TokenType::RIGHT_PAREN)){ do{ params.push_back(consume(TokenType::IDENTIFIER, "Expected parameter name").lexeme);} while(match({TokenType::COMMA})); }
+        consume(TokenType::RIGHT_PAREN, "Expected ')'");
+        int outerLoops = loopDepth; loopDepth = 0; auto body = block(); loopDepth = outerLoops;
+        auto f = std::make_shared<FunctionStmt>(); f->name = std::move(name); f->params = std::move(params); f->body = body; return f;
+    }
+
+    StmtPtr funcDecl(){ auto name = consume(TokenType::IDENTIFIER, "Expected function name").lexeme; auto f = functionBody(name); return std::static_pointer_cast<Stmt>(f); }
+
+    StmtPtr classDecl(){ auto name = consume(TokenType::IDENTIFIER, "Expected class name").lexeme; consume(TokenType::LEFT_BRACE, "Expected '{'"); std::unordered_map<Symbol, std::shared_ptr<FunctionStmt>> methods; while(!check(TokenType::RIGHT_BRACE)){
+            consume(TokenType::FUNC, "Expected method"); auto mname = consume(TokenType::IDENTIFIER, "Expected method name").lexeme; auto m = functionBody(mname); methods[mname]=m; }
+        consume(TokenType::RIGHT_BRACE, "Expected '}'"); auto cls = std::make_shared<ClassStmt>(); cls->name = name; cls->methods = std::move(methods); return cls; }
+
+    StmtPtr structDecl(){ auto name = consume(TokenType::IDENTIFIER, "Expected struct name").lexeme; consume(TokenType::LEFT_BRACE, "Expected '{'"); std::vector<std::string> fields; while(!check(TokenType::RIGHT_BRACE)){
+            fields.push_back(consume(TokenType::IDENTIFIER, "Expected field name").lexeme); consume(TokenType::SEMICOLON, "Expected ';' after field"); }
+        consume(TokenType::RIGHT_BRACE, "Expected '}'"); auto st = std::make_shared<StructStmt>(); st->name = name; st->fields = std::move(fields); return st; }
+
+    StmtPtr unionDecl(){ auto name = consume(TokenType::IDENTIFIER, "Expected union name").lexeme; consume(TokenType::LEFT_BRACE, "Expected '{'"); std::vector<std::string> tags; while(!check(TokenType::RIGHT_BRACE)){
+            tags.push_back(consume(TokenType::IDENTIFIER, "Expected tag name").lexeme); consume(TokenType::SEMICOLON, "Expected ';' after tag"); }
+        consume(TokenType::RIGHT_BRACE, "Expected '}'"); auto un = std::make_shared<UnionStmt>(); un->name = name; un->tags = std::move(tags); return un; }
+
+StmtPtr statement(){
+        if(match({TokenType::IF})) return ifStmt();
+        if(match({TokenType::WHILE})) return whileStmt();
+        if(match({TokenType::FOR})) return forStmt();
+        if(match({TokenType::LEFT_BRACE})) return block();
+        if(match({TokenType::RETURN})){
+            std::optional<ExprPtr> val;
+            if(!check(TokenType::SEMICOLON)) val = expression();
+            consume(TokenType::SEMICOLON, "Expected ';'");
+            return std::make_shared<ReturnStmt>(val);
+        }
+        if(match({TokenType::BREAK, TokenType::CONTINUE})){ auto kw = previous();
+            if(loopDepth==0){ std::ostringstream emsg; emsg<<"'"<<kw.lexeme<<"' outside of a loop at line "<<kw.line<<", col "<<kw.col; throw RuntimeError(emsg.str()); }
+            consume(TokenType::SEMICOLON, "Expected ';'");
+            if(kw.type==TokenType::BREAK){ return std::make_shared<BreakStmt>(); } return std::make_shared<ContinueStmt>();
+        }
+        // Multi-assign like: a, b, c = expr;
+        if(check(TokenType::IDENTIFIER)){
+            size_t save = current;
+            std::vector<Symbol> names;
+            names.push_back(advance().lexeme);
+            if(check(TokenType::COMMA)){
+                while(match({TokenType::COMMA})){
+                    names.push_back(consume(TokenType::IDENTIFIER, "Expected identifier in multi-assign").lexeme);
+                }
+                consume(TokenType::EQUAL, "Expected '=' in multi-assign");
+                auto rhs = expression();
+                consume(TokenType::SEMICOLON, "Expected ';'");
+                return std::make_shared<MultiAssignStmt>(std::move(names), rhs);
+            }
+            current = save; // rollback if not actually a multi-assign
+        }
+        auto e = expression(); consume(TokenType::SEMICOLON, "Expected ';'"); return std::make_shared<ExprStmt>(e);
+    }
+
+    std::shared_ptr<BlockStmt> block(){
+        if(previous().type!=TokenType::LEFT_BRACE) consume(TokenType::LEFT_BRACE, "Expected '{'");
+        std::vector<StmtPtr> stmts; while(!check(TokenType::RIGHT_BRACE)) stmts.push_back(declaration());
+        consume(TokenType::RIGHT_BRACE, "Expected '}'"); return std::make_shared<BlockStmt>(std::move(stmts));
+    }
+
+    StmtPtr ifStmt(){ consume(TokenType::LEFT_PAREN, "Expected '('"); auto cond = expression(); consume(TokenType::RIGHT_PAREN, "Expected ')'"); auto thenB = statement(); std::optional<StmtPtr> elseB; if(match({TokenType::ELSE})) elseB = statement(); return std::make_shared<IfStmt>(cond, thenB, elseB); }
+    StmtPtr whileStmt(){ consume(TokenType::LEFT_PAREN, "Expected '('"); auto cond = expression(); consume(TokenType::RIGHT_PAREN, "Expected ')'"); auto body = loopBody(); return std::make_shared<WhileStmt>(cond, body); }
+    StmtPtr forStmt(){ consume(TokenType::LEFT_PAREN, "Expected '('"); auto nameTok = consume(TokenType::IDENTIFIER, "Expected loop variable"); consume(TokenType::IN, "Expected 'in'"); auto iter = expression(); consume(TokenType::RIGHT_PAREN, "Expected ')'"); auto body = loopBody(); return std::make_shared<ForStmt>(nameTok.lexeme, iter, body); }
+    StmtPtr loopBody(){ ++loopDepth; auto body = statement(); --loopDepth; return body; }
+    StmtPtr importStmt(){
+        // Support: import "path"; or import builtins/some_lib.ad;
+        if(check(TokenType::STRING)){
+            auto pathTok = advance();
+            consume(TokenType::SEMICOLON, "Expected ';'");
+            return std::make_shared<ImportStmt>(pathTok.lexeme);
+        }
+        // Parse bare path segments: IDENT ('/' IDENT)* ('.' IDENT)?
+        std::ostringstream p;
+        p << consume(TokenType::IDENTIFIER, "Expected path after import").lexeme;
+        while(match({TokenType::SLASH})){
+            p << '/';
+            p << consume(TokenType::IDENTIFIER, "Expected identifier after '/'").lexeme;
+        }
+        if(match({TokenType::DOT})){
+            p << '.';
+            p << consume(TokenType::IDENTIFIER, "Expected extension after '.'").lexeme;
+        }
+        consume(TokenType::SEMICOLON, "Expected ';'");
+        return std::make_shared<ImportStmt>(p.str());
+    }
+
+    ExprPtr expression(){ return assignment(); }
+
+    ExprPtr assignment(){ auto expr = orExpr(); if(match({TokenType::EQUAL})){
+            auto equals = previous(); auto value = assignment(); if(auto v = std::dynamic_pointer_cast<VarExpr>(expr)) return std::make_shared<AssignExpr>(v->name, value);
+            if(auto g = std::dynamic_pointer_cast<GetExpr>(expr)) return std::make_shared<SetExpr>(g->object, g->name, value);
+            if(auto ix = std::dynamic_pointer_cast<IndexExpr>(expr)) return std::make_shared<SetIndexExpr>(ix->object, ix->index, value);
+            throw RuntimeError("Invalid assignment target"); }
+        return expr; }
+
+ExprPtr orExpr(){ auto expr = andExpr(); while(match({TokenType::OR_OR, TokenType::OR_KW})){
+            Token op = previous(); if(op.type==TokenType::OR_KW){ Token norm = op; norm.type = TokenType::OR_OR; op = norm; }
+            auto right = andExpr(); expr = std::make_shared<BinaryExpr>(expr, op, right); }
+        return expr; }
+ExprPtr andExpr(){ auto expr = equality(); while(match({TokenType::AND_AND, TokenType::AND_KW})){
+            Token op = previous(); if(op.type==TokenType::AND_KW){ Token norm = op; norm.type = TokenType::AND_AND; op = norm; }
+            auto right = equality(); expr = std::make_shared<BinaryExpr>(expr, op, right); }
+        return expr; }
+ExprPtr equality(){ auto expr = comparison(); while(match({TokenType::BANG_EQUAL, TokenType::EQUAL_EQUAL, TokenType::EQUALS_KW})){
+            Token op = previous(); if(op.type==TokenType::EQUALS_KW){ Token norm = op; norm.type = TokenType::EQUAL_EQUAL; op = norm; }
+            auto right = comparison(); expr = std::make_shared<BinaryExpr>(expr, op, right); }
+        return expr; }
+    ExprPtr comparison(){ auto expr = term(); while(match({TokenType::LESS,TokenType::LESS_EQUAL,TokenType::GREATER,TokenType::GREATER_EQUAL})){
+            Token op = previous(); auto right = term(); expr = std::make_shared<BinaryExpr>(expr, op, right); }
+        return expr; }
+    ExprPtr term(){ auto expr = factor(); while(match({TokenType::PLUS,TokenType::MINUS})){
+            Token op = previous(); auto right = factor(); expr = std::make_shared<BinaryExpr>(expr, op, right); }
+        return expr; }
+    ExprPtr factor(){ auto expr = unary(); while(match({TokenType::STAR,TokenType::SLASH,TokenType::PERCENT})){
+            Token op = previous(); auto right = unary(); expr = std::make_shared<BinaryExpr>(expr, op, right); }
+        return expr; }
+ExprPtr unary(){ if(match({TokenType::BANG, TokenType::MINUS, TokenType::NOT_KW})){
+            Token op = previous(); // normalize NOT_KW to BANG semantics
+            if(op.type==TokenType::NOT_KW){ Token norm = op; norm.type = TokenType::BANG; op = norm; }
+            auto right = unary(); return std::make_shared<UnaryExpr>(op, right); }
+        return call(); }
+
+    ExprPtr call(){ auto expr = primary(); while(true){ if(match({TokenType::LEFT_PAREN})){
+                std::vector<ExprPtr> args; if(!check(TokenType::RIGHT_PAREN)){ do{ args.push_back(expression()); } while(match({TokenType::COMMA})); }
+                consume(TokenType::RIGHT_PAREN, "Expected ')'"); expr = std::make_shared<CallExpr>(expr, args);
+            } else if(match({TokenType::DOT})){
+                auto name = consume(TokenType::IDENTIFIER, "Expected property name after '.'").sym; expr = std::make_shared<GetExpr>(expr, name);
+            } else if(match({TokenType::LEFT_BRACKET})){
+                auto idx = expression(); consume(TokenType::RIGHT_BRACKET, "Expected ']'"); expr = std::make_shared<IndexExpr>(expr, idx);
+            } else break; }
+        return expr; }
+
+    ExprPtr primary(){ if(match({TokenType::FALSE})) return std::make_shared<LiteralExpr>(Value(false));
+        if(match({TokenType::TRUE})) return std::make_shared<LiteralExpr>(Value(true));
+        if(match({TokenType::NULL_T})) return std::make_shared<LiteralExpr>(Value());
+        if(match({TokenType::THIS})) return std::make_shared<VarExpr>("this");
+        if(match({TokenType::NUMBER})) return std::make_shared<LiteralExpr>(Value(std::stod(previous().lexeme)));
+        if(match({TokenType::STRING})) return std::make_shared<LiteralExpr>(literalString(previous().lexeme));
+        if(match({TokenType::LEFT_PAREN})) { auto e = expression(); consume(TokenType::RIGHT_PAREN, "Expected ')'"); return std::make_shared<GroupingExpr>(e);}        
+        if(match({TokenType::LEFT_BRACKET})){
+            std::vector<ExprPtr> elems; if(!check(TokenType::RIGHT_BRACKET)){ do{ elems.push_back(expression()); } while(match({TokenType::COMMA})); }
+            consume(TokenType::RIGHT_BRACKET, "Expected ']'");
+            // Represent list literal as CallExpr on a special marker handled in interpreter
+            auto marker = std::make_shared<VarExpr>("__list_literal__"); return std::make_shared<CallExpr>(marker, elems);
+        }
+        if(match({TokenType::LEFT_BRACE})){
+            // dict literal: { "k": v, ... }
+            std::vector<ExprPtr> kv; if(!check(TokenType::RIGHT_BRACE)){
+                do{ auto keyTok = consume(TokenType::STRING, "Expected string key in dict literal"); consume(TokenType::COLON, "Expected ':'"); kv.push_back(std::make_shared<LiteralExpr>(literalString(keyTok.lexeme))); kv.push_back(expression()); } while(match({TokenType::COMMA}));
+            }
+            consume(TokenType::RIGHT_BRACE, "Expected '}'"); auto marker = std::make_shared<VarExpr>("__dict_literal__"); return std::make_shared<CallExpr>(marker, kv);
+        }
+        if(match({TokenType::IDENTIFIER})) return std::make_shared<VarExpr>(previous().sym);
+        std::ostringstream emsg; emsg<<"Expected expression at line "<<peek().line<<", col "<<peek().col; throw RuntimeError(emsg.str()); }
+};
+
+// Whole stream into one string, sized up front when the stream can seek (no ostringstream double copy)
+static std::string readAll(std::istream& in){ std::string out; in.seekg(0, std::ios::end); std::streamoff size = in.tellg(); in.seekg(0, std::ios::beg);
+    if(size > 0 && in){ out.resize((size_t)size); in.read(out.data(), size); out.resize((size_t)in.gcount()); if(in) return out; in.clear(); }
+    else in.clear();
+    char chunk[64*1024]; while(in.read(chunk, sizeof chunk) || in.gcount()) out.append(chunk, (size_t)in.gcount()); return out; }
+
+// Module cache: a parsed module is stored as a compact binary AST (<cache dir>/<hash of path>.adc) so later runs skip
+// lexing and parsing. The file records the source's size and FNV-1a hash, and an entry is used only when the source
+// read on this run has the same ones; mtimes are not trusted, so a checkout or `touch` that leaves the content alone
+// still hits.
+// Names are stored once in a string table. Resolution results (Bindings, frame sizes) are not stored; the Resolver
+// runs on every load as it does after parsing.
+namespace adc {
+constexpr char kMagic[4] = {'A', 'D', 'C', '\0'};
+constexpr uint32_t kVersion = 2; // bump when the AST or this encoding changes
+enum class Tag : uint8_t { None, Literal, Var, Assign, Binary, Unary, Grouping, Call, Get, Set, Index, SetIndex,
+    ExprS, Let, Block, If, While, Return, Break, Continue, Function, Class, Struct, Union, For, Import, MultiAssign, MultiLet };
+enum class Lit : uint8_t { Null, False, True, Number, String };
+struct SourceInfo { uint64_t size = 0; int64_t mtime = 0; uint64_t hash = 0; }; // mtime is only used by in-process images
+
+inline uint64_t fnv1a(std::string_view s){ uint64_t h = 1469598103934665603ull; for(unsigned char c: s){ h ^= c; h *= 1099511628211ull; } return h; }
+
+struct Writer {
+    std::string body; std::vector<const std::string*> strs; std::unordered_map<std::string_view, uint32_t> index;
+    void u8(uint8_t v){ body += (char)v; }
+    void var(uint64_t v){ while(v >= 0x80){ body += (char)(v | 0x80); v >>= 7; } body += (char)v; }
+    void raw(const void* p, size_t n){ body.append((const char*)p, n); }
+    void str(const std::string& s){ auto it = index.find(s); if(it == index.end()){ it = index.emplace(s, (uint32_t)strs.size()).first; strs.push_back(&s); } var(it->second); }
+    void token(const Token& t){ u8((uint8_t)t.type); str(t.lexeme); var((uint64_t)t.line); var((uint64_t)t.col); }
+    void names(const std::vector<Symbol>& v){ var(v.size()); for(auto n: v) str(n.str()); }
+    void strings(const std::vector<std::string>& v){ var(v.size()); for(const auto& s: v) str(s); }
+    void exprs(const std::vector<ExprPtr>& v){ var(v.size()); for(const auto& x: v) expr(x); }
+    void expr(const ExprPtr& e){ const Expr* x = e.get();
+        if(!x) u8((uint8_t)Tag::None);
+        else if(auto p = dynamic_cast<const LiteralExpr*>(x)){ u8((uint8_t)Tag::Literal); const Value& v = p->value;
+            if(v.isNull()) u8((uint8_t)Lit::Null); else if(auto b = std::get_if<bool>(&v.data)) u8((uint8_t)(*b? Lit::True : Lit::False));
+            else if(auto n = std::get_if<double>(&v.data)){ u8((uint8_t)Lit::Number); raw(n, sizeof *n); }
+            else if(auto s = v.asString()){ u8((uint8_t)Lit::String); str(*s); }
+            else throw RuntimeError("module cache: unsupported literal"); }
+        else if(auto p = dynamic_cast<const VarExpr*>(x)){ u8((uint8_t)Tag::Var); str(p->name.str()); }
+        else if(auto p = dynamic_cast<const AssignExpr*>(x)){ u8((uint8_t)Tag::Assign); str(p->name.str()); expr(p->value); }
+        else if(auto p = dynamic_cast<const BinaryExpr*>(x)){ u8((uint8_t)Tag::Binary); expr(p->left); token(p->op); expr(p->right); }
+        else if(auto p = dynamic_cast<const UnaryExpr*>(x)){ u8((uint8_t)Tag::Unary); token(p->op); expr(p->right); }
+        else if(auto p = dynamic_cast<const GroupingExpr*>(x)){ u8((uint8_t)Tag::Grouping); expr(p->expr); }
+        else if(auto p = dynamic_cast<const CallExpr*>(x)){ u8((uint8_t)Tag::Call); expr(p->callee); exprs(p->args); }
+        else if(auto p = dynamic_cast<const GetExpr*>(x)){ u8((uint8_t)Tag::Get); expr(p->object); str(p->name.str()); }
+        else if(auto p = dynamic_cast<const SetExpr*>(x)){ u8((uint8_t)Tag::Set); expr(p->object); str(p->name.str()); expr(p->value); }
+        else if(auto p = dynamic_cast<const IndexExpr*>(x)){ u8((uint8_t)Tag::Index); expr(p->object); expr(p->index); }
+        else if(auto p = dynamic_cast<const SetIndexExpr*>(x)){ u8((uint8_t)Tag::SetIndex); expr(p->object); expr(p->index); expr(p->value); }
+        else throw RuntimeError("module cache: unknown expression node"); }
+    void function(const FunctionStmt& f){ str(f.name.str()); strings(f.params); stmt(f.body); }
+    void stmt(const StmtPtr& s){ const Stmt* x = s.get();
+        if(!x) u8((uint8_t)Tag::None);
+        else if(auto p = dynamic_cast<const ExprStmt*>(x)){ u8((uint8_t)Tag::ExprS); expr(p->expr); }
+        else if(auto p = dynamic_cast<const LetStmt*>(x)){ u8((uint8_t)Tag::Let); str(p->name.str()); expr(p->initializer); }
+        else if(auto p = dynamic_cast<const BlockStmt*>(x)){ u8((uint8_t)Tag::Block); var(p->stmts.size()); for(const auto& c: p->stmts) stmt(c); }
+        else if(auto p = dynamic_cast<const IfStmt*>(x)){ u8((uint8_t)Tag::If); expr(p->cond); stmt(p->thenB); stmt(p->elseB? *p->elseB : nullptr); }
+        else if(auto p = dynamic_cast<const WhileStmt*>(x)){ u8((uint8_t)Tag::While); expr(p->cond); stmt(p->body); }
+        else if(auto p = dynamic_cast<const ReturnStmt*>(x)){ u8((uint8_t)Tag::Return); expr(p->value? *p->value : nullptr); }
+        else if(dynamic_cast<const BreakStmt*>(x)) u8((uint8_t)Tag::Break);
+        else if(dynamic_cast<const ContinueStmt*>(x)) u8((uint8_t)Tag::Continue);
+        else if(auto p = dynamic_cast<const FunctionStmt*>(x)){ u8((uint8_t)Tag::Function); function(*p); }
+        else if(auto p = dynamic_cast<const ClassStmt*>(x)){ u8((uint8_t)Tag::Class); str(p->name.str()); var(p->methods.size()); for(const auto& m: p->methods){ str(m.first.str()); function(*m.second); } }
+        else if(auto p = dynamic_cast<const StructStmt*>(x)){ u8((uint8_t)Tag::Struct); str(p->name.str()); strings(p->fields); }
+        else if(auto p = dynamic_cast<const UnionStmt*>(x)){ u8((uint8_t)Tag::Union); str(p->name.str()); strings(p->tags); }
+        else if(auto p = dynamic_cast<const ForStmt*>(x)){ u8((uint8_t)Tag::For); str(p->var.str()); expr(p->iterable); stmt(p->body); }
+        else if(auto p = dynamic_cast<const ImportStmt*>(x)){ u8((uint8_t)Tag::Import); str(p->path); }
+        else if(auto p = dynamic_cast<const MultiAssignStmt*>(x)){ u8((uint8_t)Tag::MultiAssign); names(p->names); expr(p->value); }
+        else if(auto p = dynamic_cast<const MultiLetStmt*>(x)){ u8((uint8_t)Tag::MultiLet); names(p->names); }
+        else throw RuntimeError("module cache: unknown statement node"); }
+    // Header, string table, then the statements
+    std::string file(const std::vector<StmtPtr>& stmts, const SourceInfo& src){
+        var(stmts.size()); for(const auto& s: stmts) stmt(s);
+        std::string out(kMagic, 4); auto put = [&](const auto& v){ out.append((const char*)&v, sizeof v); };
+        std::string table; std::swap(table, body); var(strs.size()); for(auto s: strs){ var(s->size()); body += *s; } body += table;
+        put(kVersion); put(src.size); put(src.hash); put(fnv1a(body)); out += body; return out; }
+};
+
+struct Reader {
+    const char* p; const char* e; std::vector<std::string> strs; std::vector<Symbol> syms; std::vector<bool> interned;
+    Reader(const char* b, const char* end): p(b), e(end) {}
+    [[noreturn]] static void bad(){ throw RuntimeError("module cache: corrupt file"); }
+    uint8_t u8(){ if(p >= e) bad(); return (uint8_t)*p++; }
+    uint64_t var(){ uint64_t v = 0; for(int shift = 0; shift < 64; shift += 7){ uint8_t b = u8(); v |= (uint64_t)(b & 0x7F) << shift; if(!(b & 0x80)) return v; } bad(); }
+    size_t count(){ uint64_t n = var(); if(n > (uint64_t)(e - p)) bad(); return (size_t)n; } // every element takes at least a byte
+    const std::string& str(){ uint64_t i = var(); if(i >= strs.size()) bad(); return strs[i]; }
+    Symbol sym(){ uint64_t i = var(); if(i >= strs.size()) bad(); if(!interned[i]){ syms[i] = Symbol(strs[i]); interned[i] = true; } return syms[i]; }
+    void table(){ size_t n = count(); strs.reserve(n); for(size_t i=0;i<n;i++){ size_t len = count(); strs.emplace_back(p, len); p += len; } syms.resize(n); interned.assign(n, false); }
+    Token token(){ Token t; t.type = (TokenType)u8(); if(t.type > TokenType::END_OF_FILE) bad(); t.lexeme = str(); t.line = (int)var(); t.col = (int)var(); return t; }
+    std::vector<Symbol> names(){ std::vector<Symbol> v(count()); for(auto& n: v) n = sym(); return v; }
+    std::vector<std::string> strings(){ std::vector<std::string> v(count()); for(auto& s: v) s = str(); return v; }
+    std::vector<ExprPtr> exprs(){ std::vector<ExprPtr> v(count()); for(auto& x: v) x = expr(); return v; }
+    ExprPtr expr(){
+        switch((Tag)u8()){
+            case Tag::None: return nullptr;
+            case Tag::Literal: switch((Lit)u8()){
+                case Lit::Null: return std::make_shared<LiteralExpr>(Value());
+                case Lit::False: return std::make_shared<LiteralExpr>(Value(false));
+                case Lit::True: return std::make_shared<LiteralExpr>(Value(true));
+                case Lit::Number: { double d; if(e - p < (ptrdiff_t)sizeof d) bad(); std::memcpy(&d, p, sizeof d); p += sizeof d; return std::make_shared<LiteralExpr>(Value(d)); }
+                case Lit::String: return std::make_shared<LiteralExpr>(literalString(str()));
+                default: bad(); }
+            case Tag::Var: return std::make_shared<VarExpr>(sym());
+            case Tag::Assign: { auto n = sym(); return std::make_shared<AssignExpr>(n, expr()); }
+            case Tag::Binary: { auto l = expr(); auto op = token(); return std::make_shared<BinaryExpr>(l, op, expr()); }
+            case Tag::Unary: { auto op = token(); return std::make_shared<UnaryExpr>(op, expr()); }
+            case Tag::Grouping: return std::make_shared<GroupingExpr>(expr());
+            case Tag::Call: { auto c = expr(); return std::make_shared<CallExpr>(c, exprs()); }
+            case Tag::Get: { auto o = expr(); return std::make_shared<GetExpr>(o, sym()); }
+            case Tag::Set: { auto o = expr(); auto n = sym(); return std::make_shared<SetExpr>(o, n, expr()); }
+            case Tag::Index: { auto o = expr(); return std::make_shared<IndexExpr>(o, expr()); }
+            case Tag::SetIndex: { auto o = expr(); auto i = expr(); return std::make_shared<SetIndexExpr>(o, i, expr()); }
+            default: bad(); } }
+    std::shared_ptr<FunctionStmt> function(){ auto f = std::make_shared<FunctionStmt>(); f->name = sym(); f->params = strings();
+        f->body = std::dynamic_pointer_cast<BlockStmt>(stmt()); if(!f->body) bad(); return f; }
+    StmtPtr stmt(){
+        switch((Tag)u8()){
+            case Tag::None: return nullptr;
+            case Tag::ExprS: return std::make_shared<ExprStmt>(expr());
+            case Tag::Let: { auto n = sym(); return std::make_shared<LetStmt>(n, expr()); }
+            case Tag::Block: { std::vector<StmtPtr> v(count()); for(auto& s: v) s = stmt(); return std::make_shared<BlockStmt>(std::move(v)); }
+            case Tag::If: { auto c = expr(); auto t = stmt(); std::optional<StmtPtr> el; if(auto s = stmt()) el = s; return std::make_shared<IfStmt>(c, t, el); }
+            case Tag::While: { auto c = expr(); return std::make_shared<WhileStmt>(c, stmt()); }
+            case Tag::Return: { std::optional<ExprPtr> v; if(auto x = expr()) v = x; return std::make_shared<ReturnStmt>(v); }
+            case Tag::Break: return std::make_shared<BreakStmt>();
+            case Tag::Continue: return std::make_shared<ContinueStmt>();
+            case Tag::Function: return function();
+            case Tag::Class: { auto c = std::make_shared<ClassStmt>(); c->name = sym(); size_t n = count(); for(size_t i=0;i<n;i++){ auto m = sym(); c->methods[m] = function(); } return c; }
+            case Tag::Struct: { auto s = std::make_shared<StructStmt>(); s->name = sym(); s->fields = strings(); return s; }
+            case Tag::Union: { auto u = std::make_shared<UnionStmt>(); u->name = sym(); u->tags = strings(); return u; }
+            case Tag::For: { auto v = sym(); auto it = expr(); return std::make_shared<ForStmt>(v, it, stmt()); }
+            case Tag::Import: return std::make_shared<ImportStmt>(str());
+            case Tag::MultiAssign: { auto n = names(); return std::make_shared<MultiAssignStmt>(std::move(n), expr()); }
+            case Tag::MultiLet: return std::make_shared<MultiLetStmt>(names());
+            default: bad(); } }
+};
+
+// magic, version, source size and hash, then the hash of everything after the header
+constexpr size_t kHeaderSize = 4 + sizeof(uint32_t) + 3*sizeof(uint64_t);
+inline bool header(const std::string& file, SourceInfo& out){ if(file.size() < kHeaderSize || std::memcmp(file.data(), kMagic, 4) != 0) return false;
+    const char* p = file.data() + 4; uint32_t version; std::memcpy(&version, p, sizeof version); p += sizeof version; if(version != kVersion) return false;
+    std::memcpy(&out.size, p, sizeof out.size); p += sizeof out.size; std::memcpy(&out.hash, p, sizeof out.hash); return true; }
+inline std::vector<StmtPtr> decode(const std::string& file){ uint64_t sum; std::memcpy(&sum, file.data() + kHeaderSize - sizeof sum, sizeof sum);
+    if(fnv1a(std::string_view(file).substr(kHeaderSize)) != sum) Reader::bad();
+    Reader r(file.data() + kHeaderSize, file.data() + file.size()); r.table();
+    std::vector<StmtPtr> stmts(r.count()); for(auto& s: stmts) s = r.stmt(); if(r.p != r.e) Reader::bad(); return stmts; }
+} // namespace adc
+
+// The cache directory has to be private: anyone who can write entries there decides what code later runs. A missing
+// directory is created 0700; an existing one must be a real directory owned by this user that no one else can write.
+// Returns false when the cache should stay off.
+static bool privateCacheDir(const std::filesystem::path& dir){ std::error_code ec;
+#ifndef _WIN32
+    std::filesystem::create_directories(dir.parent_path(), ec);
+    if(::mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) return false;
+    struct stat st; if(::lstat(dir.c_str(), &st) != 0) return false;
+    return S_ISDIR(st.st_mode) && st.st_uid == ::geteuid() && !(st.st_mode & (S_IWGRP | S_IWOTH));
+#else
+    std::filesystem::create_directories(dir, ec); return std::filesystem::is_directory(dir, ec); // under the per-user profile
+#endif
+}
+// Per-user cache directories: $XDG_CACHE_HOME/adascript/<name> or ~/.cache/adascript/<name> (%LOCALAPPDATA% on
+// Windows). Empty, which turns that cache off, when there is no home directory to use.
+static std::filesystem::path userCacheDir(const char* name){
+#ifdef _WIN32
+    if(const char* d = std::getenv("LOCALAPPDATA"); d && *d) return std::filesystem::path(d) / "adascript" / name;
+#else
+    if(const char* d = std::getenv("XDG_CACHE_HOME"); d && *d == '/') return std::filesystem::path(d) / "adascript" / name;
+    if(const char* h = std::getenv("HOME"); h && *h) return std::filesystem::path(h) / ".cache" / "adascript" / name;
+#endif
+    return {}; }
+
+// Reads and parses a module, through the cache in 'cacheDir' when one is set (checked by privateCacheDir). The source
+// is always read: an entry is used only when its recorded size and hash match it. Cache problems (unwritable
+// directory, stale or corrupt entries) only fall back to parsing.
+static std::vector<StmtPtr> loadModule(const std::filesystem::path& file, const std::filesystem::path& cacheDir){
+    namespace fs = std::filesystem; std::error_code ec;
+    std::ifstream in(file, std::ios::binary); if(!in) throw RuntimeError("import: cannot open "+file.string());
+    std::string text = readAll(in);
+    auto parse = [&]{ Lexer lx(text); auto toks = lx.scan(); Parser ps(toks); return ps.parse(); };
+    if(cacheDir.empty()) return parse();
+    auto abs = fs::absolute(file, ec).lexically_normal().string(); if(ec) return parse();
+    char name[32]; std::snprintf(name, sizeof name, "%016llx.adc", (unsigned long long)adc::fnv1a(abs)); fs::path entry = cacheDir / name;
+    adc::SourceInfo src; src.size = text.size(); src.hash = adc::fnv1a(text);
+    if(std::ifstream c{entry, std::ios::binary}){ std::string cached = readAll(c); adc::SourceInfo have;
+        if(adc::header(cached, have) && have.size==src.size && have.hash==src.hash){ try{ return adc::decode(cached); } catch(const RuntimeError&){} } }
+    auto stmts = parse();
+    // (re)write the entry, to a temporary name first so readers never see half a file
+    try{ std::string out = adc::Writer().file(stmts, src);
+        fs::path tmp = entry; tmp += "." + std::to_string((unsigned long long)std::chrono::steady_clock::now().time_since_epoch().count() ^ std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        { std::ofstream o(tmp, std::ios::binary | std::ios::trunc); o.write(out.data(), (std::streamsize)out.size()); if(!o) throw RuntimeError("module cache: write failed"); }
+        fs::rename(tmp, entry, ec); if(ec) fs::remove(tmp, ec);
+    } catch(const RuntimeError&){}
+    return stmts; }
+
+// Resolver: runs after Parser::parse and binds every variable declaration and reference to a (depth, slot) pair.
+// Block scopes are flattened into their function's frame, so normally only calls create Environments (a method's 'this'
+// is slot 0 of its own frame); names declared at script top level stay in the hashed globals table. A block that
+// declares a local captured by a nested function keeps an Environment of its own, created each time the block runs,
+// so closures made in different loop iterations see their own copy of it.
+class Resolver {
+public:
+    // Returns the number of frame slots the script needs for locals of its nested blocks
+    static int resolveScript(const std::vector<StmtPtr>& stmts){
+        Resolver r; FnState st; st.isScript = true; r.fs = &st;
+        r.beginScope(stmts); // scope 0 of a script is the global scope
+        for(auto& s: stmts) r.stmt(s);
+        return st.frameSize;
+    }
+
+private:
+    struct Local { Symbol name; int scope; int slot; bool captured=false; }; // captured: referenced from a nested function
+    struct FnState {
+        FnState* enclosing = nullptr; bool isScript = false; bool isBlock = false; int frameSize=0; // isBlock: a block's own Environment
+        std::vector<Local> locals;
+        std::vector<std::unordered_set<Symbol>> scopes; // names each open scope declares (for forward references)
+    };
+    FnState* fs = nullptr;
+
+    static void collectDecls(const StmtPtr& s, std::unordered_set<Symbol>& out){
+        if(auto p=std::dynamic_pointer_cast<LetStmt>(s)) out.insert(p->name);
+        else if(auto p=std::dynamic_pointer_cast<FunctionStmt>(s)) out.insert(p->name);
+        else if(auto p=std::dynamic_pointer_cast<ClassStmt>(s)) out.insert(p->name);
+        else if(auto p=std::dynamic_pointer_cast<StructStmt>(s)) out.insert(p->name);
+        else if(auto p=std::dynamic_pointer_cast<UnionStmt>(s)) out.insert(p->name);
+        else if(auto p=std::dynamic_pointer_cast<ForStmt>(s)) out.insert(p->var);
+        else if(auto p=std::dynamic_pointer_cast<MultiAssignStmt>(s)) out.insert(p->names.begin(), p->names.end());
+        else if(auto p=std::dynamic_pointer_cast<MultiLetStmt>(s)) out.insert(p->names.begin(), p->names.end());
+    }
+    void beginScope(const std::vector<StmtPtr>& stmts){ std::unordered_set<Symbol> decls; for(auto& s: stmts) collectDecls(s, decls); fs->scopes.push_back(std::move(decls)); }
+    // Returns whether a nested function captured one of the closing scope's locals
+    bool endScope(){ int cur = (int)fs->scopes.size()-1; auto& ls = fs->locals;
+        bool captured = std::any_of(ls.begin(), ls.end(), [cur](const Local& l){ return l.scope==cur && l.captured; }); ls.erase(std::remove_if(ls.begin(), ls.end(), [cur](const Local& l){ return l.scope>=cur; }), ls.end()); fs->scopes.pop_back(); return captured; }
+
+    // 'let' semantics: redefining a name in the same scope reuses its slot
+    Binding declare(Symbol n){
+        if(fs->isScript && fs->scopes.size()==1) return Binding{};
+        int cur = (int)fs->scopes.size()-1; for(auto& l: fs->locals) if(l.name==n && l.scope==cur) return Binding{0, l.slot};
+        int slot = fs->frameSize++; fs->locals.push_back({n, cur, slot}); return Binding{0, slot};
+    }
+
+    Binding lookup(Symbol n){
+        int depth = 0; bool inFunction = true; // still within the function being resolved (its block Environments included)
+        for(FnState* s=fs; s; s=s->enclosing, ++depth){
+            Local* best = nullptr; for(auto& l: s->locals) if(l.name==n && (!best || l.scope>=best->scope)) best=&l;
+            if(best){ if(!inFunction) best->captured = true; return Binding{depth, best->slot}; }
+            if(inFunction){ if(!s->isBlock) inFunction = false; continue; }
+            // A nested function may refer to a name its enclosing function declares further down (e.g. mutually recursive helpers)
+            for(int sc=(int)s->scopes.size()-1; sc>=0; --sc){
+                if(s->isScript && sc==0) break;
+                if(s->scopes[sc].count(n)){ int slot = s->frameSize++; s->locals.push_back({n, sc, slot, true}); return Binding{depth, slot}; }
+            }
+        }
+        return Binding{};
+    }
+
+    void function(FunctionStmt& f, bool method){
+        FnState st; st.enclosing = fs;
+        FnState* saved = fs; fs = &st;
+        beginScope(f.body->stmts); // parameters and top-level body statements share one scope
+        int first = method? 1 : 0; if(method) st.locals.push_back({"this", 0, 0});
+        for(size_t i=0;i<f.params.size();++i) st.locals.push_back({f.params[i], 0, first+(int)i});
+        st.frameSize = first+(int)f.params.size();
+        for(auto& s: f.body->stmts) stmt(s);
+        fs = saved;
+        f.frameSize = st.frameSize;
+    }
+
+    // Resolves a block flattened into the current frame; if that leaves a local captured, resolves it again with an
+    // Environment of its own. The first pass's slots are given back unless a nested function took a later one meanwhile.
+    void block(BlockStmt& b){
+        b.frameSize = 0; int before = fs->frameSize;
+        beginScope(b.stmts); for(auto& x: b.stmts) stmt(x);
+        if(!endScope()) return;
+        if(std::none_of(fs->locals.begin(), fs->locals.end(), [before](const Local& l){ return l.slot>=before; })) fs->frameSize = before;
+        FnState st; st.enclosing = fs; st.isBlock = true;
+        FnState* saved = fs; fs = &st;
+        beginScope(b.stmts); for(auto& x: b.stmts) stmt(x);
+        fs = saved;
+        b.frameSize = st.frameSize;
+    }
+
+    void stmt(const StmtPtr& s){
+        if(auto p=std::dynamic_pointer_cast<BlockStmt>(s)) block(*p);
+        else if(auto p=std::dynamic_pointer_cast<LetStmt>(s)){ expr(p->initializer); p->at = declare(p->name); }
+        else if(auto p=std::dynamic_pointer_cast<ExprStmt>(s)) expr(p->expr);
+        else if(auto p=std::dynamic_pointer_cast<IfStmt>(s)){ expr(p->cond); stmt(p->thenB); if(p->elseB) stmt(*p->elseB); }
+        else if(auto p=std::dynamic_pointer_cast<WhileStmt>(s)){ expr(p->cond); stmt(p->body); }
+        else if(auto p=std::dynamic_pointer_cast<ForStmt>(s)){ expr(p->iterable); p->at = declare(p->var); stmt(p->body); }
+        else if(auto p=std::dynamic_pointer_cast<ReturnStmt>(s)){ if(p->value) expr(*p->value); }
+        else if(auto p=std::dynamic_pointer_cast<FunctionStmt>(s)){ p->at = declare(p->name); function(*p, false); }
+        else if(auto p=std::dynamic_pointer_cast<ClassStmt>(s)){ for(auto& kv: p->methods) function(*kv.second, true); p->at = declare(p->name); }
+        else if(auto p=std::dynamic_pointer_cast<StructStmt>(s)) p->at = declare(p->name);
+        else if(auto p=std::dynamic_pointer_cast<UnionStmt>(s)) p->at = declare(p->name);
+        else if(auto p=std::dynamic_pointer_cast<MultiAssignStmt>(s)){ expr(p->value); p->at.clear(); for(auto& n: p->names) p->at.push_back(declare(n)); }
+        else if(auto p=std::dynamic_pointer_cast<MultiLetStmt>(s)){ p->at.clear(); for(auto& n: p->names) p->at.push_back(declare(n)); }
+    }
+
+    void expr(const ExprPtr& e){
+        if(auto p=std::dynamic_pointer_cast<VarExpr>(e)) p->at = lookup(p->name);
+        else if(auto p=std::dynamic_pointer_cast<AssignExpr>(e)){ expr(p->value); p->at = lookup(p->name); }
+        else if(auto p=std::dynamic_pointer_cast<GroupingExpr>(e)) expr(p->expr);
+        else if(auto p=std::dynamic_pointer_cast<UnaryExpr>(e)) expr(p->right);
+        else if(auto p=std::dynamic_pointer_cast<BinaryExpr>(e)){ expr(p->left); expr(p->right); }
+        else if(auto p=std::dynamic_pointer_cast<CallExpr>(e)){ expr(p->callee); for(auto& a: p->args) expr(a); }
+        else if(auto p=std::dynamic_pointer_cast<GetExpr>(e)) expr(p->object);
+        else if(auto p=std::dynamic_pointer_cast<SetExpr>(e)){ expr(p->object); expr(p->value); }
+        else if(auto p=std::dynamic_pointer_cast<IndexExpr>(e)){ expr(p->object); expr(p->index); }
+        else if(auto p=std::dynamic_pointer_cast<SetIndexExpr>(e)){ expr(p->index); expr(p->value); expr(p->object); }
+    }
+};
+
+// Parsed and resolved code that interpreters on different threads can run at once: nothing in it is modified after
+// it is built (Bindings are filled in, string literals are immortal, inline caches are atomic). Imported modules are
+// kept as images shared by every interpreter in the process, replaced when the file's size or mtime changes.
+struct ModuleImage { adc::SourceInfo src; std::vector<StmtPtr> stmts; int frameSize = 0;
+    mutable std::once_flag compileOnce; mutable std::shared_ptr<Proto> script; // for the bytecode engine, compiled on first use
+    const std::shared_ptr<Proto>& bytecode() const; };
+static std::shared_ptr<const ModuleImage> moduleImage(const std::filesystem::path& file, const std::filesystem::path& cacheDir){
+    static std::mutex mu; static std::unordered_map<std::string, std::shared_ptr<const ModuleImage>> images;
+    namespace fs = std::filesystem; std::error_code ec; adc::SourceInfo src;
+    src.size = (uint64_t)fs::file_size(file, ec); if(!ec) src.mtime = (int64_t)fs::last_write_time(file, ec).time_since_epoch().count();
+    if(!ec){ std::lock_guard<std::mutex> lock(mu); auto it = images.find(file.string()); if(it != images.end() && it->second->src.size == src.size && it->second->src.mtime == src.mtime) return it->second; }
+    // load outside the lock; when two threads race on a new module, both images are equivalent and the later one wins
+    auto img = std::make_shared<ModuleImage>(); img->src = src; img->stmts = loadModule(file, cacheDir); img->frameSize = Resolver::resolveScript(img->stmts);
+    if(!ec){ std::lock_guard<std::mutex> lock(mu); images[file.string()] = img; }
+    return img; }
+
+// Environments
+struct Environment : GcObject {
+    Ref<Environment> parent;
+    std::unordered_map<Symbol, Value> values;
+    std::vector<Value> slots; // resolved locals of a call frame (see Resolver); 'values' holds globals
+    explicit Environment(Ref<Environment> p=nullptr): parent(std::move(p)) {}
+    void traverse(GcVisit visit, void* ctx) override { if(parent) visit(parent.object(), ctx); for(const auto& kv: values) gcTraverse(kv.second, visit, ctx); for(const auto& v: slots) gcTraverse(v, visit, ctx); }
+    void clearRefs() override { parent = nullptr; std::unordered_map<Symbol, Value>().swap(values); std::vector<Value>().swap(slots); }
+    Environment* ancestor(int depth){ Environment* e=this; while(depth-- > 0) e=e->parent.get(); return e; }
+    Value& at(const Binding& b){ return ancestor(b.depth)->slots[b.slot]; }
+    void define(Symbol name, Value v){ values[name]=std::move(v); }
+    bool assign(Symbol name, Value v){ auto it=values.find(name); if(it!=values.end()){ it->second=std::move(v); return true; } if(parent) return parent->assign(name, std::move(v)); return false; }
+    Value get(Symbol name){ auto it=values.find(name); if(it!=values.end()) return it->second; if(parent) return parent->get(name); throw RuntimeError("Undefined variable: "+name.str()); }
+    Value* getPtr(Symbol name){ auto it=values.find(name); if(it!=values.end()) return &it->second; if(parent) return parent->getPtr(name); return nullptr; }
+};
+
+// Callable types
+struct Callable { virtual ~Callable() = default; virtual int arity() const =0; virtual Value call(Interpreter&, const std::vector<Value>&)=0; };
+
+struct Proto; // compiled function body (bytecode engine)
+
+struct Function : Callable, GcObject { std::vector<std::string> params; std::shared_ptr<BlockStmt> body; Ref<Environment> closure; bool isInit=false; std::string name; int frameSize=0; std::shared_ptr<Proto> proto;
+    bool isMethod=false; Value boundThis; // methods receive 'this' in slot 0 of their frame, ahead of the params
+    Function(Symbol n,std::vector<std::string> p,std::shared_ptr<BlockStmt> b,Ref<Environment> c,bool init=false): params(std::move(p)), body(std::move(b)), closure(std::move(c)), isInit(init), name(n.str()) {}
+    int arity() const override { return (int)params.size(); }
+    // Method binding: a copy that remembers its receiver (only materialised when a method is used as a value)
+    Ref<Function> bind(const Value& self) const { auto f = makeRef<Function>(name, params, body, closure, isInit); f->frameSize = frameSize; f->proto = proto; f->isMethod = true; f->boundThis = self; return f; }
+    Value call(Interpreter& ip, const std::vector<Value>& args) override { return invoke(ip, boundThis, args); }
+    Value invoke(Interpreter&, const Value& self, const std::vector<Value>& args); // 'self' is ignored unless isMethod
+    void traverse(GcVisit visit, void* ctx) override { if(closure) visit(closure.object(), ctx); gcTraverse(boundThis, visit, ctx); }
+    void clearRefs() override { closure = nullptr; boundThis = Value(); } };
+
+// Untracked by the cycle collector: values captured by 'fn' count as outside references
+struct NativeFunction : Callable, Object { std::string name; int fixedArity; std::function<Value(Interpreter&, const std::vector<Value>&)> fn;
+    Ref<NativeFunction> method; Value receiver; // set for a native method read as a value (Interpreter::bindNative), which 'fn' closes over
+    NativeFunction(std::string n,int a,std::function<Value(Interpreter&,const std::vector<Value>&)> f): name(std::move(n)), fixedArity(a), fn(std::move(f)){} int arity() const override { return fixedArity; } Value call(Interpreter& ip, const std::vector<Value>& args) override { return fn(ip,args);} };
+
+// Hidden classes: a Shape maps field names to slot indices. Adding a field moves an instance to the child shape for
+// that name, so instances initialised alike (typically by 'init') share one layout and one shape id.
+struct Shape { const uint32_t id; std::unordered_map<Symbol, int> index; std::unordered_map<Symbol, std::unique_ptr<Shape>> transitions;
+    explicit Shape(const Shape* parent=nullptr): id(nextId()) { if(parent) index = parent->index; }
+    static uint32_t nextId(){ static std::atomic<uint32_t> n{1}; return n.fetch_add(1, std::memory_order_relaxed); } // ids are never reused, so caches need no invalidation
+    int slotOf(Symbol n) const { auto it=index.find(n); return it!=index.end()? it->second : -1; }
+    Shape* with(Symbol n){ auto& t = transitions[n]; if(!t){ t = std::make_unique<Shape>(this); t->index.emplace(n, (int)index.size()); } return t.get(); }
+};
+
+struct Class : Callable, GcObject { std::string name; std::unordered_map<Symbol, Ref<Function>> methods; int ar= -1;
+    Shape rootShape; int slotHint=0;   // new instances reserve room for the widest layout seen so far
+    std::vector<Function*> methodTable; std::unordered_map<Symbol, int> methodIndex; // dense numbering for inline caches
+    Class(Symbol n, std::unordered_map<Symbol, Ref<Function>> m): name(n.str()){ setMethods(std::move(m)); }
+    void setMethods(std::unordered_map<Symbol, Ref<Function>> m){ methods = std::move(m); methodTable.clear(); methodIndex.clear();
+        for(auto& kv: methods){ kv.second->isMethod = true; methodIndex[kv.first] = (int)methodTable.size(); methodTable.push_back(kv.second.get()); } }
+    int arity() const override { return ar; } Value call(Interpreter&, const std::vector<Value>&) override; Ref<Function> findMethod(Symbol n){ auto it=methods.find(n); if(it!=methods.end()) return it->second; return nullptr; }
+    int methodSlot(Symbol n) const { auto it=methodIndex.find(n); return it!=methodIndex.end()? it->second : -1; }
+    void traverse(GcVisit visit, void* ctx) override { for(const auto& kv: methods) if(kv.second) visit(kv.second.object(), ctx); }
+    void clearRefs() override { methodTable.clear(); methodIndex.clear(); std::unordered_map<Symbol, Ref<Function>>().swap(methods); } };
+
+struct Instance : GcObject { Ref<Class> klass; Shape* shape; std::vector<Value> slots; // field values, laid out by 'shape'
+    explicit Instance(Ref<Class> k): klass(std::move(k)), shape(&klass->rootShape){ slots.reserve(klass->slotHint); }
+    Value* field(Symbol n){ int i = shape->slotOf(n); return i<0? nullptr : &slots[i]; }
+    Value& defineField(Symbol n){ if(Value* v = field(n)) return *v; shape = shape->with(n); slots.emplace_back();
+        if((int)slots.size() > klass->slotHint){ klass->slotHint = (int)slots.size(); } return slots.back(); }
+    void traverse(GcVisit visit, void* ctx) override { if(klass) visit(klass.object(), ctx); for(const auto& v: slots) gcTraverse(v, visit, ctx); }
+    void clearRefs() override { klass = nullptr; std::vector<Value>().swap(slots); } };
+
+// Host objects: instances of types implemented in C++ (e.g. the native containers). Methods are native functions in
+// a per-type table that take the receiver as their first argument, so obj.m(args) needs no bound function.
+using ValueCopy = std::function<Value(const Value&)>;
+struct NativeType { std::string name; std::unordered_map<Symbol, Ref<NativeFunction>> methods;
+    bool (*next)(NativeObject&, Value&) = nullptr; // iterable in for-in when set: yields values until it returns false
+    // copies an object for a VM snapshot, passing each contained value through 'copy'; types without it can't be captured
+    Ref<NativeObject> (*clone)(NativeObject&, const ValueCopy& copy) = nullptr;
+    explicit NativeType(std::string n): name(std::move(n)) {}
+    // types are process-wide statics used by every interpreter, so their method functions are immortal
+    void add(const char* m, int arity, Value(*fn)(Interpreter&, const std::vector<Value>&)){ auto f = new NativeFunction(name+"."+m, arity, fn); f->refs = Object::kImmortal; methods[Symbol(m)] = Ref<NativeFunction>(f); }
+    const Ref<NativeFunction>* findMethod(Symbol n) const { auto it=methods.find(n); return it!=methods.end()? &it->second : nullptr; } };
+struct NativeObject : GcObject { const NativeType& type; explicit NativeObject(const NativeType& t): type(t) {} };
+
+// Bytecode: each instruction is an opcode, a small operand (scope depth / argc) and a 32-bit argument
+enum class OpCode : uint8_t {
+    CONST, NIL, TRUE_, FALSE_, POP,
+    GET_LOCAL, SET_LOCAL, DEF_LOCAL,          // depth, slot
+    GET_GLOBAL, SET_GLOBAL, DEF_GLOBAL,       // name index
+    GET_PROP, SET_PROP, GET_INDEX, SET_INDEX,
+    SET_INDEX_LOCAL, SET_INDEX_GLOBAL, SET_INDEX_PROP, // xs[i]=v, g[i]=v, obj.f[i]=v
+    ADD, SUB, MUL, DIV, MOD, EQ, NE, LT, LE, GT, GE, NOT, NEG, TRUTHY,
+    JUMP, JUMP_IF_FALSE, JUMP_IF_TRUE,        // absolute targets; conditional jumps pop the condition
+    LOOP,                                     // jump back to a loop head, where resource limits are checked
+    CALL, LIST, DICT, CLOSURE, CLASS, IMPORT, UNPACK,
+    GET_METHOD, INVOKE,                       // obj.m(args): GET_METHOD leaves (method, receiver) or (callee, nil) for INVOKE
+    ITER_PREP, ITER_NEXT,                     // for-in: ITER_NEXT pushes the next element or jumps to arg
+    ENTER_BLOCK, LEAVE_BLOCK,                 // a block with captured locals: push an Environment of arg slots / pop arg of them
+    RETURN                                    // depth: block Environments open above the frame's own
+};
+
+struct Instr { OpCode op; uint8_t depth; uint16_t cache; int32_t arg; }; // 'cache' indexes Proto::caches for property ops
+
+struct ClassProto;
+
+struct Proto {
+    Symbol name; std::vector<std::string> params; bool isInit=false;
+    std::vector<Instr> code;
+    std::vector<Value> constants;                   // number and string literals
+    std::vector<Symbol> names;                      // globals, properties and import paths
+    std::vector<std::shared_ptr<Proto>> protos;     // nested functions
+    std::vector<std::shared_ptr<ClassProto>> classes;
+    mutable std::deque<PropertyCache> caches;       // inline caches of GET_PROP / SET_PROP / GET_METHOD sites
+    int numSlots=0;                                 // params occupy slots [0, params.size()), after 'this' in methods
+};
+
+struct ClassProto { Symbol name; std::vector<std::shared_ptr<Proto>> methods; };
+
+// Dispatch-loop VM over Protos; frames keep locals in Environment::slots so closures can capture them
+struct VM {
+    struct CallFrame { const Proto* proto; const Instr* pc; size_t base; Ref<Environment> env; Ref<Function> fn; };
+    Interpreter& ip;
+    std::vector<Value> stack;
+    std::vector<CallFrame> frames;
+    int scripts = 0; // frames running a script or module body rather than a call; not counted as call depth
+    explicit VM(Interpreter& i): ip(i) {}
+    void runScript(const std::shared_ptr<Proto>& script);
+    Value call(const Ref<Function>& fn, const Value& self, const std::vector<Value>& args);
+private:
+    void pushFrame(Ref<Function> fn, const Value& self, const Value* args, int argc, size_t pop);
+    Value run(size_t entryFrames);
+};
+
+// Interpreter
+// Completion status of a statement; 'return' leaves its value in Interpreter::returnValue
+enum class Exec : uint8_t { Normal, Return, Break, Continue };
+
+class Interpreter {
+public:
+    Ref<Environment> globals = makeRef<Environment>();
+    Ref<Environment> env = globals;
+    std::filesystem::path current_dir;
+    std::filesystem::path builtins_dir; // optional root for builtins
+    std::unordered_set<std::string> loaded_files;
+    std::filesystem::path module_cache_dir; // parsed imports are cached here when set (see loadModule)
+
+    bool use_bytecode = false; // --engine bytecode / AdaScript_SetEngine; the tree walker stays the default
+    VM vm{*this};
+    std::shared_ptr<struct HttpClient> http; // requests.* connection pool, created by the first request
+    struct HttpServer* server = nullptr;     // the running server.serve, for server.stop()
+    AdaScriptVM* host = nullptr;             // the embedding C API VM, whose value stack typed native callbacks use
+
+    // Resource limits (AdaScript_SetLimits, --max-ops etc.; 0 means none). The heap cap lives on the GcHeap. Loop
+    // back-edges and calls count down 'budget'; when it runs out, checkLimits() looks at the interrupt flag, the
+    // operation count and the deadline, then refills it. A check therefore costs one decrement on the hot paths, and an
+    // interrupt is seen within kCheckEvery operations.
+    struct Limits { uint64_t ops = 0; int depth = 0; double seconds = 0; } limits;
+    static constexpr int64_t kCheckEvery = 1024;
+    int64_t budget = kCheckEvery, refill = kCheckEvery; uint64_t opsUsed = 0;
+    std::chrono::steady_clock::time_point deadline;
+    std::atomic<bool> interrupted{false}; // set from any thread by AdaScript_Interrupt
+    int callDepth = 0;                    // tree-walker calls in progress; the bytecode VM counts its frames
+    void tick(){ if(--budget <= 0) checkLimits(); }
+    void checkLimits();
+    void startRun(); // a top-level run begins: fresh operation count and deadline
+    // Without a depth limit, calls still stop at kDefaultMaxDepth on both engines, with the error the tree walker's native
+    // stack check raises: the bytecode VM keeps frames on the heap and would otherwise recurse until memory runs out.
+    // On an 8 MB stack the tree walker gets past 2000 calls even when each body nests loops, so the cap trips first there
+    // too; a smaller stack (or a body nested much deeper) can still stop it earlier with the same error.
+    static constexpr int kDefaultMaxDepth = 2000;
+    void checkDepth(){ int d = callDepth + (int)vm.frames.size() - vm.scripts;
+        if(limits.depth){ if(d >= limits.depth) throw RuntimeError("Call depth limit exceeded (" + std::to_string(limits.depth) + ")"); }
+        else if(d >= kDefaultMaxDepth) throw RuntimeError("Stack overflow: calls nested too deeply"); }
+    static void checkNativeStack();
+
+    explicit Interpreter(const std::filesystem::path& entry_dir);
+    explicit Interpreter(const struct Snapshot& snap); // starts from a copy of a snapshot's globals, without re-registering builtins
+    void interpret(const std::vector<StmtPtr>& stmts){ try{ runProgram(stmts); } catch(const RuntimeError& e){ writeConsole(std::cerr, std::string("Runtime error: ") + e.what() + "\n"); }}
+    void runProgram(const std::vector<StmtPtr>& stmts); // resolve, then run at global scope on the selected engine
+    void runImage(const ModuleImage& image);              // run resolved, possibly shared code at global scope
+    void runTree(const std::vector<StmtPtr>& stmts, int frameSize);
+
+    // Declarations bind either a frame slot or a global name
+    void define(const Binding& at, Symbol name, Value v){ if(at.isGlobal()) globals->define(name, std::move(v)); else env->slots[at.slot] = std::move(v); }
+
+    Value returnValue; // set by 'return' while Exec::Return propagates to Function::call
+
+    // exec
+Exec execute(const StmtPtr& stmt){ if(auto p=std::dynamic_pointer_cast<BlockStmt>(stmt)){ // block scopes are resolved statically
+            if(p->frameSize){ auto local = makeRef<Environment>(env); local->slots.resize(p->frameSize); return execBlock(p, local); } // it has captured locals
+            for(auto& s: p->stmts){ Exec st = execute(s); if(st!=Exec::Normal) return st; } }
+        else if(auto p=std::dynamic_pointer_cast<LetStmt>(stmt)){ auto v = evaluate(p->initializer); define(p->at, p->name, v); }
+        else if(auto p=std::dynamic_pointer_cast<ExprStmt>(stmt)){ (void)evaluate(p->expr); }
+        else if(auto p=std::dynamic_pointer_cast<IfStmt>(stmt)){ if(isTruthy(evaluate(p->cond))) return execute(p->thenB); else if(p->elseB) return execute(*p->elseB); }
+        else if(auto p=std::dynamic_pointer_cast<WhileStmt>(stmt)){ while(isTruthy(evaluate(p->cond))){ tick(); Exec st = execute(p->body); if(st==Exec::Break) break; if(st==Exec::Return) return st; } }
+        else if(auto p=std::dynamic_pointer_cast<ForStmt>(stmt)){ return execFor(p); }
+        else if(auto p=std::dynamic_pointer_cast<ReturnStmt>(stmt)){ returnValue = p->value? evaluate(*p->value) : Value(); return Exec::Return; }
+        else if(std::dynamic_pointer_cast<BreakStmt>(stmt)){ return Exec::Break; }
+        else if(std::dynamic_pointer_cast<ContinueStmt>(stmt)){ return Exec::Continue; }
+        else if(auto p=std::dynamic_pointer_cast<FunctionStmt>(stmt)){ auto f = makeRef<Function>(p->name, p->params, p->body, env, false); f->frameSize = p->frameSize; define(p->at, p->name, Value(f)); }
+        else if(auto p=std::dynamic_pointer_cast<ClassStmt>(stmt)){ std::unordered_map<Symbol, Ref<Function>> methods; for(auto& kv: p->methods){ auto f = makeRef<Function>(kv.first, kv.second->params, kv.second->body, env, kv.first=="init"); f->frameSize = kv.second->frameSize; methods[kv.first]=f; } auto k = makeRef<Class>(p->name, methods); define(p->at, p->name, Value(k)); }
+        else if(auto p=std::dynamic_pointer_cast<StructStmt>(stmt)){ // store struct metadata as a Class without methods; instances created via Class call
+            auto k = makeRef<Class>(p->name, std::unordered_map<Symbol, Ref<Function>>{}); define(p->at, p->name, Value(k)); }
+        else if(auto p=std::dynamic_pointer_cast<UnionStmt>(stmt)){ auto k = makeRef<Class>(p->name, std::unordered_map<Symbol, Ref<Function>>{}); define(p->at, p->name, Value(k)); }
+        else if(auto p=std::dynamic_pointer_cast<ImportStmt>(stmt)){ execImport(p->path); }
+        else if(auto q = std::dynamic_pointer_cast<MultiAssignStmt>(stmt)){
+            Value rv = evaluate(q->value);
+            auto lst = rv.asList();
+            if(!lst) throw RuntimeError("Right-hand side of multi-assign must be a list");
+            if(lst->size() != q->names.size()) throw RuntimeError("Multi-assign length mismatch");
+            for(size_t i=0;i<q->names.size();++i) define(q->at[i], q->names[i], (*lst)[i]);
+        }
+        else if(auto ml = std::dynamic_pointer_cast<MultiLetStmt>(stmt)){
+            for(size_t i=0;i<ml->names.size();++i) define(ml->at[i], ml->names[i], Value());
+        }
+        else { throw RuntimeError("Unknown statement type"); }
+        return Exec::Normal; }
+
+    Exec execBlock(const std::shared_ptr<BlockStmt>& block, Ref<Environment> newEnv){ auto prev = env; env = newEnv; Exec st = Exec::Normal;
+        try{ for(auto&s: block->stmts){ st = execute(s); if(st!=Exec::Normal) break; } } catch(...) { env = prev; throw; } env = prev; return st; }
+
+    Exec execFor(const std::shared_ptr<ForStmt>& fs){ Value it = evaluate(fs->iterable); auto setVar = [&](const Value& v){ define(fs->at, fs->var, v); };
+        // body status: stop the loop on break/return, keep going on continue
+        auto body = [&](Exec& st){ tick(); st = execute(fs->body); if(st==Exec::Continue) st = Exec::Normal; return st==Exec::Normal; };
+        Exec st = Exec::Normal;
+        // Containers are shared, so the body may mutate them: walk lists by index and dicts over a key snapshot
+        if(auto l = it.asList()){ for(size_t i=0;i<l->size();++i){ setVar((*l)[i]); if(!body(st)) break; } }
+        else if(auto d = it.asDict()){ List keys; keys.reserve(d->size()); for(const auto& kv : *d) keys.push_back(Value(kv.first)); for(const auto& k : keys){ setVar(k); if(!body(st)) break; } }
+        else if(auto s = it.asString()){ for(char ch: *s){ std::string one(1, ch); setVar(Value(one)); if(!body(st)) break; } }
+        else if(auto o = std::get_if<Ref<NativeObject>>(&it.data); o && (*o)->type.next){ Value v; while((*o)->type.next(**o, v)){ setVar(v); if(!body(st)) break; } }
+        else throw RuntimeError("for 'in' expects list, dict, string, or an iterable object");
+        return st==Exec::Return? st : Exec::Normal; }
+
+void execImport(const std::string& rawPath){ using namespace std::filesystem; path p(rawPath);
+        if(p.extension().empty()) p.replace_extension(".ad");
+        path full;
+        // Special handling for builtins location, e.g. import "builtins/..."
+        std::string raw = rawPath;
+        if(!builtins_dir.empty() && (raw.rfind("builtins/", 0)==0 || raw.rfind("builtins\\", 0)==0)){
+            // Compute sub path under builtins and ensure .ad extension if missing
+            path sub = raw.substr(raw.find('/')!=std::string::npos? raw.find('/')+1 : raw.find('\\')+1);
+            path subp(sub);
+            if(subp.extension().empty()) subp.replace_extension(".ad");
+            full = (builtins_dir / subp).lexically_normal();
+        } else {
+            full = (current_dir / p).lexically_normal();
+        }
+        std::string key = full.string(); if(loaded_files.count(key)) return; loaded_files.insert(key);
+        auto image = moduleImage(full, module_cache_dir); auto prevDir = current_dir; current_dir = full.parent_path();
+        // modules run at global scope regardless of where the import statement appears
+        try{ runImage(*image); } catch(...) { current_dir = prevDir; throw; } current_dir = prevDir; }
+
+    Value evaluate(const ExprPtr& expr){
+        if(auto p=std::dynamic_pointer_cast<LiteralExpr>(expr)) return p->value;
+        if(auto p=std::dynamic_pointer_cast<VarExpr>(expr)) { if(!p->at.isGlobal()) return env->at(p->at); auto it = globals->values.find(p->name); if(it!=globals->values.end()) return it->second; return Value(); }
+        if(auto p=std::dynamic_pointer_cast<AssignExpr>(expr)){ auto v = evaluate(p->value); if(!p->at.isGlobal()){ env->at(p->at) = v; return v; } if(!globals->assign(p->name, v)) throw RuntimeError("Undefined variable: "+p->name); return v; }
+        if(auto p=std::dynamic_pointer_cast<GroupingExpr>(expr)) return evaluate(p->expr);
+        if(auto p=std::dynamic_pointer_cast<UnaryExpr>(expr)) return evalUnary(p->op, evaluate(p->right));
+        if(auto p=std::dynamic_pointer_cast<BinaryExpr>(expr)){
+            // Implement short-circuit for logical AND/OR
+            if(p->op.type==TokenType::AND_AND || p->op.type==TokenType::AND_KW){
+                Token op = p->op; if(op.type==TokenType::AND_KW){ Token norm=op; norm.type=TokenType::AND_AND; op=norm; }
+                Value left = evaluate(p->left);
+                if(!isTruthy(left)) return Value(false);
+                Value right = evaluate(p->right);
+                return evalBinary(left, op, right);
+            }
+            if(p->op.type==TokenType::OR_OR || p->op.type==TokenType::OR_KW){
+                Token op = p->op; if(op.type==TokenType::OR_KW){ Token norm=op; norm.type=TokenType::OR_OR; op=norm; }
+                Value left = evaluate(p->left);
+                if(isTruthy(left)) return Value(true);
+                Value right = evaluate(p->right);
+                return evalBinary(left, op, right);
+            }
+            return evalBinary(evaluate(p->left), p->op, evaluate(p->right));
+        }
+        if(auto p=std::dynamic_pointer_cast<CallExpr>(expr)) return evalCall(p);
+        if(auto p=std::dynamic_pointer_cast<GetExpr>(expr)) return evalGet(p);
+        if(auto p=std::dynamic_pointer_cast<SetExpr>(expr)) return evalSet(p);
+        if(auto p=std::dynamic_pointer_cast<IndexExpr>(expr)) return evalIndex(p);
+        if(auto p=std::dynamic_pointer_cast<SetIndexExpr>(expr)) return evalSetIndex(p);
+        throw RuntimeError("Unknown expression");
+    }
+
+    static bool isTruthy(const Value& v){ if(std::holds_alternative<std::monostate>(v.data)) return false; if(auto b=std::get_if<bool>(&v.data)) return *b; if(auto n=std::get_if<double>(&v.data)) return *n!=0; return true; }
+
+    Value evalUnary(const Token& op, const Value& r){ switch(op.type){ case TokenType::BANG: return Value(!isTruthy(r)); case TokenType::MINUS: {
+                if(auto n=std::get_if<double>(&r.data)){ return Value(-*n); } throw RuntimeError("Unary '-' on non-number"); }
+            default: throw RuntimeError("Invalid unary op"); }}
+
+    Value evalBinary(const Value& l, const Token& op, const Value& r){ return evalBinary(l, op.type, r); }
+    Value evalBinary(const Value& l, TokenType op, const Value& r){ auto num = [&](const Value& v)->double{ if(auto n=std::get_if<double>(&v.data)) return *n; throw RuntimeError("Expected number"); };
+        switch(op){
+            case TokenType::PLUS: {
+                if(std::holds_alternative<double>(l.data) && std::holds_alternative<double>(r.data)) return Value(num(l)+num(r));
+                if(l.isString() || r.isString()) {
+                    std::ostringstream oss; if(auto ls=l.asString()) oss<<*ls; else if(auto ln=std::get_if<double>(&l.data)) oss<<*ln; else oss<<"[obj]";
+                    if(auto rs=r.asString()) oss<<*rs; else if(auto rn=std::get_if<double>(&r.data)) oss<<*rn; else oss<<"[obj]";
+                    return Value(oss.str());
+                }
+                throw RuntimeError("'+' needs numbers or strings"); }
+            case TokenType::MINUS: return Value(num(l)-num(r));
+            case TokenType::STAR: return Value(num(l)*num(r));
+            case TokenType::SLASH: { double d=num(r); if(d==0) throw RuntimeError("Division by zero"); return Value(num(l)/d);}            
+            case TokenType::PERCENT: { double d=num(r); if(d==0) throw RuntimeError("Modulo by zero"); return Value(fmod(num(l), d)); }
+            case TokenType::EQUAL_EQUAL: return Value(equal(l,r));
+            case TokenType::BANG_EQUAL: return Value(!equal(l,r));
+            case TokenType::LESS: return Value(num(l)<num(r));
+            case TokenType::LESS_EQUAL: return Value(num(l)<=num(r));
+            case TokenType::GREATER: return Value(num(l)>num(r));
+            case TokenType::GREATER_EQUAL: return Value(num(l)>=num(r));
+            case TokenType::AND_AND: return Value(isTruthy(l) && isTruthy(r));
+            case TokenType::OR_OR: return Value(isTruthy(l) || isTruthy(r));
+            default: throw RuntimeError("Invalid binary op");
+        }
+    }
+
+    static bool equal(const Value& a, const Value& b){ if(a.data.index()!=b.data.index()) return false; if(std::holds_alternative<std::monostate>(a.data)) return true; if(auto pb=std::get_if<bool>(&a.data)) return *pb==std::get<bool>(b.data); if(auto pn=std::get_if<double>(&a.data)) return *pn==std::get<double>(b.data); if(auto ps=a.asString()) return *ps==b.str();
+        // reference types compare by identity
+        return std::visit([&](const auto& x)->bool{ using T = std::decay_t<decltype(x)>; if constexpr (std::is_same_v<T, std::monostate> || std::is_same_v<T, bool> || std::is_same_v<T, double> || std::is_same_v<T, Ref<StrObj>>) return false; else return x==std::get<T>(b.data); }, a.data); }
+
+    Value evalCall(const std::shared_ptr<CallExpr>& c){
+        // list and dict literal markers
+        if(auto v=std::dynamic_pointer_cast<VarExpr>(c->callee)){
+            if(v->name=="__list_literal__"){ List lst; for(auto &e: c->args) lst.push_back(evaluate(e)); return Value(lst);}            
+            if(v->name=="__dict_literal__"){ Dict d; for(size_t i=0;i<c->args.size();i+=2){ auto k = evaluate(c->args[i]); auto val = evaluate(c->args[i+1]); d[k.str()] = val; } return Value(d);}        }
+        // obj.m(args): resolve the member through the site's cache and invoke it without materialising a bound method
+        if(auto g=std::dynamic_pointer_cast<GetExpr>(c->callee)){
+            Value obj = evaluate(g->object);
+            if(auto inst = std::get_if<Ref<Instance>>(&obj.data)){
+                Value* field; Function* method; lookupMember(**inst, g->name, &g->cache, field, method);
+                if(!field && !method) throw RuntimeError("Undefined property: "+g->name);
+                Value cal = field? *field : Value();
+                std::vector<Value> evaluated = evalArgs(c->args);
+                return method? method->invoke(*this, obj, evaluated) : callValue(cal, evaluated);
+            }
+            if(auto no = std::get_if<Ref<NativeObject>>(&obj.data)){
+                auto m = (*no)->type.findMethod(g->name); if(!m) throw RuntimeError((*no)->type.name+" has no property: "+g->name);
+                std::vector<Value> evaluated; evaluated.reserve(c->args.size()+1); evaluated.push_back(obj); for(auto& a: c->args) evaluated.push_back(evaluate(a));
+                return (*m)->call(*this, evaluated);
+            }
+            Value cal = getProperty(obj, g->name, &g->cache);
+            return callValue(cal, evalArgs(c->args));
+        }
+        Value cal = evaluate(c->callee);
+        return callValue(cal, evalArgs(c->args));
+    }
+
+    std::vector<Value> evalArgs(const std::vector<ExprPtr>& args){ std::vector<Value> out; out.reserve(args.size()); for(auto& a: args) out.push_back(evaluate(a)); return out; }
+
+    // Shared by both engines: invoke any callable value
+    Value callValue(const Value& cal, const std::vector<Value>& args){
+        if(auto nf = std::get_if<Ref<NativeFunction>>(&cal.data)) return (*nf)->call(*this, args);
+        if(auto uf = std::get_if<Ref<Function>>(&cal.data)) return (*uf)->call(*this, args);
+        if(auto kc = std::get_if<Ref<Class>>(&cal.data)) return (*kc)->call(*this, args);
+        throw RuntimeError("Can only call functions/classes");
+    }
+
+    Value evalGet(const std::shared_ptr<GetExpr>& g){ return getProperty(evaluate(g->object), g->name, &g->cache); }
+
+    // Finds 'name' on an instance as a field slot or else a class method, consulting and filling the site cache 'ic'
+    static void lookupMember(Instance& inst, Symbol name, PropertyCache* ic, Value*& field, Function*& method){
+        field = nullptr; method = nullptr; uint32_t hit;
+        if(ic && ic->find(inst.shape->id, hit)){ if(hit & PropertyCache::Method) method = inst.klass->methodTable[hit & ~PropertyCache::Method]; else field = &inst.slots[hit]; return; }
+        if(int i = inst.shape->slotOf(name); i>=0){ field = &inst.slots[i]; if(ic) ic->add(inst.shape->id, (uint32_t)i); return; }
+        if(int m = inst.klass->methodSlot(name); m>=0){ method = inst.klass->methodTable[m]; if(ic) ic->add(inst.shape->id, PropertyCache::Method | (uint32_t)m); }
+    }
+
+    Value getProperty(const Value& obj, Symbol name, PropertyCache* ic=nullptr){ if(auto inst = std::get_if<Ref<Instance>>(&obj.data)){
+            Value* field; Function* method; lookupMember(**inst, name, ic, field, method);
+            if(field){ return *field; } if(method) return Value(method->bind(obj)); // bind this
+            throw RuntimeError("Undefined property: "+name);
+        }
+        if(auto no = std::get_if<Ref<NativeObject>>(&obj.data)){
+            if(auto m = (*no)->type.findMethod(name)) return Value(bindNative(*m, obj));
+            throw RuntimeError((*no)->type.name+" has no property: "+name);
+        }
+        if(auto d = obj.asDict()){
+            auto it = d->find(name.str()); if(it!=d->end()) return it->second; throw RuntimeError("Dict has no key: "+name);
+        }
+        if(auto s = obj.asString()){
+            // Provide string methods: split
+            if(name == "split"){
+                std::string base = *s;
+                auto fn = makeRef<NativeFunction>("string.split", -1, [base](Interpreter&, const std::vector<Value>& args)->Value{
+                    // emulate split(base, sep?)
+                    std::string sep;
+                    if(args.size()==1){ if(args[0].isString()) sep = args[0].str(); else throw RuntimeError("split sep must be string"); }
+                    else if(args.size()>1) throw RuntimeError("split expects at most 1 arg");
+                    // Reuse split logic
+                    if(sep.empty()){
+                        std::istringstream iss(base); std::string tok; List out; while(iss>>tok){ out.push_back(Value(tok)); } return Value(out);
+                    } else {
+                        List out; size_t pos=0; while(true){ size_t n=base.find(sep, pos); if(n==std::string::npos){ out.push_back(Value(base.substr(pos))); break; } out.push_back(Value(base.substr(pos, n-pos))); pos = n + sep.size(); } return Value(out);
+                    }
+                });
+                return Value(fn);
+            }
+            throw RuntimeError("String has no property: "+name);
+        }
+        throw RuntimeError("Only instances, dicts, or strings have properties");
+    }
+
+    // A native method read as a value closes over its receiver
+    static Ref<NativeFunction> bindNative(const Ref<NativeFunction>& m, const Value& self){
+        auto f = makeRef<NativeFunction>(m->name, m->fixedArity, [m, self](Interpreter& ip, const std::vector<Value>& args){ std::vector<Value> a; a.reserve(args.size()+1); a.push_back(self); a.insert(a.end(), args.begin(), args.end()); return m->call(ip, a); });
+        f->method = m; f->receiver = self; return f; }
+
+    Value evalSet(const std::shared_ptr<SetExpr>& s){ auto obj = evaluate(s->object); Value v = evaluate(s->value); return setProperty(obj, s->name, v, &s->cache); }
+
+    // Stores to existing fields go through the cache; a new field transitions the instance to a wider shape
+    Value setProperty(Value obj, Symbol name, const Value& v, PropertyCache* ic=nullptr){ if(auto inst = std::get_if<Ref<Instance>>(&obj.data)){
+            Instance& in = **inst; uint32_t hit;
+            if(ic && ic->find(in.shape->id, hit) && !(hit & PropertyCache::Method)){ in.slots[hit] = v; return v; }
+            if(int i = in.shape->slotOf(name); i>=0){ in.slots[i] = v; if(ic) ic->add(in.shape->id, (uint32_t)i); return v; }
+            in.defineField(name) = v; return v; }
+        if(auto d = std::get_if<Ref<DictObj>>(&obj.data)){
+            (*d)->items[name.str()]=v; (*d)->account(); return v; }
+        throw RuntimeError("Only instances or dicts support set");
+    }
+
+    Value evalIndex(const std::shared_ptr<IndexExpr>& ix){ auto obj = evaluate(ix->object); auto idx = evaluate(ix->index); return getIndex(obj, idx); }
+
+    Value getIndex(const Value& obj, const Value& idx){ if(auto lst = obj.asList()){
+            int i = (int)std::get<double>(idx.data); if(i<0 || i>=(int)lst->size()) throw RuntimeError("List index out of range"); return (*lst)[i]; }
+        if(auto d = obj.asDict()){
+            auto key = idx.str(); auto it=d->find(key); if(it==d->end()) throw RuntimeError("Key not found"); return it->second; }
+        throw RuntimeError("Indexing supported on list/dict"); }
+
+    // Store into a list (assigning one past the end appends) or dict held in 'slot'
+    static Value assignIndex(Value& slot, const Value& idxv, const Value& val, const char* notIndexable){
+        if(auto l = std::get_if<Ref<ListObj>>(&slot.data)){ List* lst = &(*l)->items;
+            int i = (int)std::get<double>(idxv.data); if(i<0) throw RuntimeError("List index out of range"); if(i==(int)lst->size()) { lst->push_back(val); (*l)->account(); return val; } if(i>=(int)lst->size()) throw RuntimeError("List index out of range"); (*lst)[i]=val; return val;
+        }
+        if(auto d = std::get_if<Ref<DictObj>>(&slot.data)){
+            auto key = idxv.str(); (*d)->items[key]=val; (*d)->account(); return val;
+        }
+        throw RuntimeError(notIndexable);
+    }
+
+    // this.field[i] = v / dict.prop[i] = v; returns false when base is neither instance nor dict
+    bool assignIndexOnProperty(Value base, Symbol name, const Value& idxv, const Value& val){
+        if(auto inst = std::get_if<Ref<Instance>>(&base.data)){
+            assignIndex((*inst)->defineField(name), idxv, val, "Index assignment on non-indexable field"); return true;
+        }
+        if(auto d = base.asDict()){
+            assignIndex((*d)[name.str()], idxv, val, "Index assignment on non-indexable dict property"); return true;
+        }
+        return false;
+    }
+
+Value evalSetIndex(const std::shared_ptr<SetIndexExpr>& sx){ auto idxv = evaluate(sx->index); auto val = evaluate(sx->value);
+        // Handle instance field or dict property: this.field[i] = v
+        if(auto ge = std::dynamic_pointer_cast<GetExpr>(sx->object)){
+            Value base = evaluate(ge->object);
+            if(assignIndexOnProperty(std::move(base), ge->name, idxv, val)) return val;
+        }
+        // Handle variable list: xs[i] = v
+        if(auto ve = std::dynamic_pointer_cast<VarExpr>(sx->object)){
+            Value* slot = ve->at.isGlobal()? globals->getPtr(ve->name) : &env->at(ve->at);
+            if(!slot) throw RuntimeError("Undefined variable: "+ve->name);
+            return assignIndex(*slot, idxv, val, "Index assignment on non-indexable variable");
+        }
+        // Fallback: any other expression yielding a list/dict (shared, so the store persists)
+        Value obj = evaluate(sx->object);
+        return assignIndex(obj, idxv, val, "Index assignment supported on list/dict"); }
+};
+
+// Function call impl
+Value Function::invoke(Interpreter& ip, const Value& self, const std::vector<Value>& args){ if(proto) return ip.vm.call(Ref<Function>(this), self, args); if((int)args.size()!=arity()) throw RuntimeError("Arity mismatch");
+    Interpreter::checkNativeStack(); ip.checkDepth(); ip.tick(); struct Depth { int& d; explicit Depth(int& x): d(x) { ++d; } ~Depth(){ --d; } } depth(ip.callDepth); auto local = makeRef<Environment>(closure); local->slots.resize(frameSize);
+    size_t first = 0; if(isMethod) local->slots[first++] = self; for(size_t i=0;i<params.size();++i) local->slots[first+i] = args[i];
+    Exec st = ip.execBlock(body, local); if(isInit) return self; if(st==Exec::Return) return std::move(ip.returnValue); return Value(); }
+
+static uintptr_t stackFloor(); // see the platform section below
+
+void Interpreter::startRun(){ opsUsed = 0; refill = budget = limits.ops? (int64_t)std::min<uint64_t>(kCheckEvery, limits.ops + 1) : kCheckEvery;
+    if(limits.seconds > 0) deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(limits.seconds));
+    interrupted.store(false, std::memory_order_relaxed); }
+
+void Interpreter::checkLimits(){ opsUsed += (uint64_t)(refill - budget);
+    // once a limit trips, every later check fails too, so natives that catch errors (server handlers) stop as well
+    refill = budget = 1;
+    if(interrupted.load(std::memory_order_relaxed)) throw RuntimeError("Interrupted");
+    if(limits.ops && opsUsed > limits.ops) throw RuntimeError("Operation limit exceeded (" + std::to_string(limits.ops) + " operations)");
+    if(limits.seconds > 0 && std::chrono::steady_clock::now() >= deadline) throw RuntimeError("Time limit exceeded (" + std::to_string((long long)std::llround(limits.seconds*1000)) + " ms)");
+    refill = budget = limits.ops? (int64_t)std::min<uint64_t>(kCheckEvery, limits.ops - opsUsed + 1) : kCheckEvery; }
+
+void Interpreter::checkNativeStack(){ char probe; if((uintptr_t)&probe < stackFloor()) throw RuntimeError("Stack overflow: calls nested too deeply"); }
+
+// Class call creates instance and invokes init if exists
+Value Class::call(Interpreter& ip, const std::vector<Value>& args){ auto inst = makeRef<Instance>(Ref<Class>(this)); static const Symbol initName("init"); auto init = findMethod(initName); if(init){ if((int)args.size()!=init->arity()) throw RuntimeError("Arity mismatch in init"); (void)init->invoke(ip, Value(inst), args); }
+    return Value(inst); }
+
+// Bytecode compiler: lowers a resolved AST to Protos, turning Resolver bindings into slot or global instructions
+class Compiler {
+public:
+    static std::shared_ptr<Proto> compileScript(const std::vector<StmtPtr>& stmts, int frameSize){
+        Compiler c; auto script = std::make_shared<Proto>(); script->name = "<script>"; script->numSlots = frameSize;
+        c.proto = script.get();
+        for(auto& s: stmts) c.stmt(s);
+        c.emit(OpCode::NIL); c.emit(OpCode::RETURN);
+        return script;
+    }
+
+private:
+    Proto* proto = nullptr;
+    struct Loop { int top; bool iter; int blocks; std::vector<int> breaks; }; // innermost loop last; the parser rejects break/continue outside loops
+    std::vector<Loop> loops;
+    int blocks = 0; // block Environments open at this point of the current function
+    void leaveBlocks(int to){ if(blocks>to) emit(OpCode::LEAVE_BLOCK, 0, blocks-to); }
+    void endLoop(){ for(int j: loops.back().breaks) patch(j); loops.pop_back(); }
+
+    int emit(OpCode op, int depth=0, int arg=0){ proto->code.push_back({op, (uint8_t)depth, 0, arg}); return (int)proto->code.size()-1; }
+    // Property op with its own inline cache (sites past the 16-bit limit share the last one)
+    int emitProp(OpCode op, Symbol n){ int at = emit(op, 0, name(n)); if(proto->caches.size()<0xFFFF) proto->caches.emplace_back(); proto->code[at].cache = (uint16_t)(proto->caches.size()-1); return at; }
+    int here() const { return (int)proto->code.size(); }
+    void patch(int at){ proto->code[at].arg = here(); }
+    int constant(Value v){ proto->constants.push_back(std::move(v)); return (int)proto->constants.size()-1; }
+    int name(Symbol n){ auto& ns = proto->names; for(size_t i=0;i<ns.size();++i) if(ns[i]==n) return (int)i; ns.push_back(n); return (int)ns.size()-1; }
+
+    void define(const Binding& at, Symbol n){ if(at.isGlobal()) emit(OpCode::DEF_GLOBAL, 0, name(n)); else emit(OpCode::DEF_LOCAL, 0, at.slot); }
+    void load(const Binding& at, Symbol n){ if(at.isGlobal()) emit(OpCode::GET_GLOBAL, 0, name(n)); else emit(OpCode::GET_LOCAL, at.depth, at.slot); }
+    void store(const Binding& at, Symbol n){ if(at.isGlobal()) emit(OpCode::SET_GLOBAL, 0, name(n)); else emit(OpCode::SET_LOCAL, at.depth, at.slot); }
+
+    std::shared_ptr<Proto> function(const FunctionStmt& f, bool isInit){
+        auto fp = std::make_shared<Proto>(); fp->name = f.name; fp->params = f.params; fp->isInit = isInit; fp->numSlots = f.frameSize;
+        Proto* saved = proto; int savedBlocks = blocks; proto = fp.get(); blocks = 0;
+        for(auto& s: f.body->stmts) stmt(s);
+        emit(OpCode::NIL); emit(OpCode::RETURN);
+        proto = saved; blocks = savedBlocks;
+        return fp;
+    }
+
+    void classDecl(Symbol cname, const Binding& at, const std::unordered_map<Symbol, std::shared_ptr<FunctionStmt>>& methods){
+        auto cp = std::make_shared<ClassProto>(); cp->name = cname;
+        for(auto& kv: methods) cp->methods.push_back(function(*kv.second, kv.first=="init"));
+        proto->classes.push_back(cp);
+        emit(OpCode::CLASS, 0, (int)proto->classes.size()-1); define(at, cname);
+    }
+
+    void stmt(const StmtPtr& s){
+        if(auto p=std::dynamic_pointer_cast<BlockStmt>(s)){
+            if(p->frameSize){ emit(OpCode::ENTER_BLOCK, 0, p->frameSize); ++blocks; }
+            for(auto& x: p->stmts) stmt(x);
+            if(p->frameSize){ --blocks; emit(OpCode::LEAVE_BLOCK, 0, 1); } }
+        else if(auto p=std::dynamic_pointer_cast<LetStmt>(s)){ expr(p->initializer); define(p->at, p->name); }
+        else if(auto p=std::dynamic_pointer_cast<ExprStmt>(s)){ expr(p->expr); emit(OpCode::POP); }
+        else if(auto p=std::dynamic_pointer_cast<IfStmt>(s)){ expr(p->cond); int skip = emit(OpCode::JUMP_IF_FALSE); stmt(p->thenB);
+            if(p->elseB){ int end = emit(OpCode::JUMP); patch(skip); stmt(*p->elseB); patch(end); } else patch(skip); }
+        else if(auto p=std::dynamic_pointer_cast<WhileStmt>(s)){ int top = here(); expr(p->cond); int exit = emit(OpCode::JUMP_IF_FALSE);
+            loops.push_back({top, false, blocks, {}}); stmt(p->body); emit(OpCode::LOOP, 0, top); patch(exit); endLoop(); }
+        else if(auto p=std::dynamic_pointer_cast<ForStmt>(s)){ expr(p->iterable); emit(OpCode::ITER_PREP); int top = here(); int next = emit(OpCode::ITER_NEXT);
+            loops.push_back({top, true, blocks, {}}); define(p->at, p->var); stmt(p->body); emit(OpCode::LOOP, 0, top); patch(next); endLoop(); }
+        else if(std::dynamic_pointer_cast<BreakStmt>(s)){ // a for-in loop keeps (iterable, index) on the stack; drop them on the way out
+            leaveBlocks(loops.back().blocks); if(loops.back().iter){ emit(OpCode::POP); emit(OpCode::POP); } loops.back().breaks.push_back(emit(OpCode::JUMP)); }
+        else if(std::dynamic_pointer_cast<ContinueStmt>(s)){ leaveBlocks(loops.back().blocks); emit(OpCode::LOOP, 0, loops.back().top); }
+        else if(auto p=std::dynamic_pointer_cast<ReturnStmt>(s)){ if(p->value) expr(*p->value); else emit(OpCode::NIL); emit(OpCode::RETURN, blocks); }
+        else if(auto p=std::dynamic_pointer_cast<FunctionStmt>(s)){ proto->protos.push_back(function(*p, false)); emit(OpCode::CLOSURE, 0, (int)proto->protos.size()-1); define(p->at, p->name); }
+        else if(auto p=std::dynamic_pointer_cast<ClassStmt>(s)){ classDecl(p->name, p->at, p->methods); }
+        else if(auto p=std::dynamic_pointer_cast<StructStmt>(s)){ classDecl(p->name, p->at, {}); }
+        else if(auto p=std::dynamic_pointer_cast<UnionStmt>(s)){ classDecl(p->name, p->at, {}); }
+        else if(auto p=std::dynamic_pointer_cast<ImportStmt>(s)){ emit(OpCode::IMPORT, 0, name(p->path)); }
+        else if(auto p=std::dynamic_pointer_cast<MultiAssignStmt>(s)){ expr(p->value); emit(OpCode::UNPACK, 0, (int)p->names.size()); for(size_t i=p->names.size(); i-- > 0;) define(p->at[i], p->names[i]); }
+        else if(auto p=std::dynamic_pointer_cast<MultiLetStmt>(s)){ for(size_t i=0;i<p->names.size();++i){ emit(OpCode::NIL); define(p->at[i], p->names[i]); } }
+        else throw RuntimeError("Unknown statement type");
+    }
+
+    void expr(const ExprPtr& e){
+        if(auto p=std::dynamic_pointer_cast<LiteralExpr>(e)){
+            if(p->value.isNull()) emit(OpCode::NIL);
+            else if(auto b=std::get_if<bool>(&p->value.data)) emit(*b? OpCode::TRUE_ : OpCode::FALSE_);
+            else emit(OpCode::CONST, 0, constant(p->value));
+        }
+        else if(auto p=std::dynamic_pointer_cast<VarExpr>(e)) load(p->at, p->name);
+        else if(auto p=std::dynamic_pointer_cast<AssignExpr>(e)){ expr(p->value); store(p->at, p->name); }
+        else if(auto p=std::dynamic_pointer_cast<GroupingExpr>(e)) expr(p->expr);
+        else if(auto p=std::dynamic_pointer_cast<UnaryExpr>(e)){ expr(p->right);
+            if(p->op.type==TokenType::BANG) emit(OpCode::NOT); else if(p->op.type==TokenType::MINUS) emit(OpCode::NEG); else throw RuntimeError("Invalid unary op"); }
+        else if(auto p=std::dynamic_pointer_cast<BinaryExpr>(e)) binary(*p);
+        else if(auto p=std::dynamic_pointer_cast<CallExpr>(e)){
+            if(auto v=std::dynamic_pointer_cast<VarExpr>(p->callee)){
+                if(v->name=="__list_literal__"){ for(auto& a: p->args) expr(a); emit(OpCode::LIST, 0, (int)p->args.size()); return; }
+                if(v->name=="__dict_literal__"){ for(auto& a: p->args) expr(a); emit(OpCode::DICT, 0, (int)p->args.size()/2); return; }
+            }
+            if(auto g=std::dynamic_pointer_cast<GetExpr>(p->callee)){ expr(g->object); emitProp(OpCode::GET_METHOD, g->name); for(auto& a: p->args) expr(a); emit(OpCode::INVOKE, 0, (int)p->args.size()); return; }
+            expr(p->callee); for(auto& a: p->args) expr(a); emit(OpCode::CALL, 0, (int)p->args.size());
+        }
+        else if(auto p=std::dynamic_pointer_cast<GetExpr>(e)){ expr(p->object); emitProp(OpCode::GET_PROP, p->name); }
+        else if(auto p=std::dynamic_pointer_cast<SetExpr>(e)){ expr(p->object); expr(p->value); emitProp(OpCode::SET_PROP, p->name); }
+        else if(auto p=std::dynamic_pointer_cast<IndexExpr>(e)){ expr(p->object); expr(p->index); emit(OpCode::GET_INDEX); }
+        else if(auto p=std::dynamic_pointer_cast<SetIndexExpr>(e)){
+            // same evaluation order as the tree walker: index, value, then the container
+            expr(p->index); expr(p->value);
+            if(auto ge=std::dynamic_pointer_cast<GetExpr>(p->object)){ expr(ge->object); emit(OpCode::SET_INDEX_PROP, 0, name(ge->name)); }
+            else if(auto ve=std::dynamic_pointer_cast<VarExpr>(p->object)){ if(ve->at.isGlobal()) emit(OpCode::SET_INDEX_GLOBAL, 0, name(ve->name)); else emit(OpCode::SET_INDEX_LOCAL, ve->at.depth, ve->at.slot); }
+            else { expr(p->object); emit(OpCode::SET_INDEX); }
+        }
+        else throw RuntimeError("Unknown expression");
+    }
+
+    void binary(const BinaryExpr& b){
+        TokenType t = b.op.type;
+        if(t==TokenType::AND_AND || t==TokenType::AND_KW || t==TokenType::OR_OR || t==TokenType::OR_KW){
+            bool isAnd = (t==TokenType::AND_AND || t==TokenType::AND_KW);
+            expr(b.left); int shortCircuit = emit(isAnd? OpCode::JUMP_IF_FALSE : OpCode::JUMP_IF_TRUE);
+            expr(b.right); emit(OpCode::TRUTHY); int end = emit(OpCode::JUMP);
+            patch(shortCircuit); emit(isAnd? OpCode::FALSE_ : OpCode::TRUE_); patch(end);
+            return;
+        }
+        expr(b.left); expr(b.right);
+        switch(t){
+            case TokenType::PLUS: emit(OpCode::ADD); break;
+            case TokenType::MINUS: emit(OpCode::SUB); break;
+            case TokenType::STAR: emit(OpCode::MUL); break;
+            case TokenType::SLASH: emit(OpCode::DIV); break;
+            case TokenType::PERCENT: emit(OpCode::MOD); break;
+            case TokenType::EQUAL_EQUAL: emit(OpCode::EQ); break;
+            case TokenType::BANG_EQUAL: emit(OpCode::NE); break;
+            case TokenType::LESS: emit(OpCode::LT); break;
+            case TokenType::LESS_EQUAL: emit(OpCode::LE); break;
+            case TokenType::GREATER: emit(OpCode::GT); break;
+            case TokenType::GREATER_EQUAL: emit(OpCode::GE); break;
+            default: throw RuntimeError("Invalid binary op");
+        }
+    }
+};
+
+void Interpreter::runProgram(const std::vector<StmtPtr>& stmts){
+    int frameSize = Resolver::resolveScript(stmts);
+    if(use_bytecode){ vm.runScript(Compiler::compileScript(stmts, frameSize)); return; }
+    runTree(stmts, frameSize);
+}
+
+void Interpreter::runImage(const ModuleImage& image){ if(use_bytecode) vm.runScript(image.bytecode()); else runTree(image.stmts, image.frameSize); }
+
+const std::shared_ptr<Proto>& ModuleImage::bytecode() const { std::call_once(compileOnce, [this]{ script = Compiler::compileScript(stmts, frameSize); }); return script; }
+
+void Interpreter::runTree(const std::vector<StmtPtr>& stmts, int frameSize){
+    auto frame = makeRef<Environment>(globals); frame->slots.resize(frameSize);
+    auto prev = env; env = frame;
+    try{ for(auto& s: stmts) if(execute(s)==Exec::Return) break; } catch(...){ env = prev; throw; }
+    env = prev;
+}
+
+// VM
+void VM::runScript(const std::shared_ptr<Proto>& script){
+    auto frameEnv = makeRef<Environment>(ip.globals); frameEnv->slots.resize(script->numSlots);
+    size_t entry = frames.size();
+    frames.push_back({script.get(), script->code.data(), stack.size(), std::move(frameEnv), nullptr});
+    struct Script { int& n; explicit Script(int& x): n(x) { ++n; } ~Script(){ --n; } } counted(scripts);
+    (void)run(entry);
+}
+
+Value VM::call(const Ref<Function>& fn, const Value& self, const std::vector<Value>& args){
+    Interpreter::checkNativeStack(); // natives that call back into scripts nest VM runs on the native stack
+    size_t entry = frames.size();
+    pushFrame(fn, self, args.data(), (int)args.size(), 0);
+    return run(entry);
+}
+
+// Moves the arguments (after 'self' for methods) into a fresh frame environment, then drops 'pop' values (args + callee) from the stack
+void VM::pushFrame(Ref<Function> fn, const Value& self, const Value* args, int argc, size_t pop){
+    const Proto* p = fn->proto.get();
+    if(argc!=(int)p->params.size()) throw RuntimeError("Arity mismatch");
+    ip.checkDepth(); ip.tick();
+    auto frameEnv = makeRef<Environment>(fn->closure); frameEnv->slots.resize(p->numSlots);
+    int first = 0; if(fn->isMethod) frameEnv->slots[first++] = self;
+    for(int i=0;i<argc;++i) frameEnv->slots[first+i] = args[i];
+    stack.resize(stack.size()-pop);
+    frames.push_back({p, p->code.data(), stack.size(), std::move(frameEnv), std::move(fn)});
+}
+
+Value VM::run(size_t entry){
+    const size_t entryStack = frames[entry].base;
+    CallFrame* f = &frames.back();
+    const Proto* proto = f->proto; const Instr* pc = f->pc; Environment* env = f->env.get();
+    auto reload = [&](){ f = &frames.back(); proto = f->proto; pc = f->pc; env = f->env.get(); };
+    auto pop = [&](){ Value v = std::move(stack.back()); stack.pop_back(); return v; };
+    // Generic binary operator on the two topmost values, leaving the result in place of the left operand
+    auto binop = [&](TokenType t){ Value r = pop(); stack.back() = ip.evalBinary(stack.back(), t, r); };
+    // Calls anything that does not get a VM frame: natives, classes, tree-walker functions. The receiver slot
+    // between callee and args exists only for INVOKE.
+    auto callSlow = [&](size_t calleeAt, bool hasReceiver){
+        // native methods take their receiver as the first argument
+        bool nativeMethod = hasReceiver && !stack[calleeAt+1].isNull() && std::holds_alternative<Ref<NativeFunction>>(stack[calleeAt].data);
+        std::vector<Value> args(std::make_move_iterator(stack.begin()+calleeAt+(hasReceiver && !nativeMethod? 2 : 1)), std::make_move_iterator(stack.end()));
+        Value callee = std::move(stack[calleeAt]); Value self = hasReceiver && !nativeMethod? std::move(stack[calleeAt+1]) : Value(); stack.resize(calleeAt);
+        Value r = !self.isNull()? std::get<Ref<Function>>(callee.data)->invoke(ip, self, args) : ip.callValue(callee, args);
+        f = &frames.back(); // nested runs may have grown the frame vector
+        stack.push_back(std::move(r)); };
+    try{
+        for(;;){
+            const Instr& in = *pc++;
+            switch(in.op){
+                case OpCode::CONST: stack.push_back(proto->constants[in.arg]); break;
+                case OpCode::NIL: stack.emplace_back(); break;
+                case OpCode::TRUE_: stack.emplace_back(true); break;
+                case OpCode::FALSE_: stack.emplace_back(false); break;
+                case OpCode::POP: stack.pop_back(); break;
+                case OpCode::GET_LOCAL: stack.push_back(env->ancestor(in.depth)->slots[in.arg]); break;
+                case OpCode::SET_LOCAL: env->ancestor(in.depth)->slots[in.arg] = stack.back(); break;
+                case OpCode::DEF_LOCAL: env->ancestor(in.depth)->slots[in.arg] = pop(); break;
+                case OpCode::GET_GLOBAL: { auto& g = ip.globals->values; auto it = g.find(proto->names[in.arg]); stack.push_back(it!=g.end()? it->second : Value()); break; }
+                case OpCode::SET_GLOBAL: { const auto& n = proto->names[in.arg]; if(!ip.globals->assign(n, stack.back())) throw RuntimeError("Undefined variable: "+n); break; }
+                case OpCode::DEF_GLOBAL: ip.globals->define(proto->names[in.arg], pop()); break;
+                case OpCode::GET_PROP: { Value obj = pop(); stack.push_back(ip.getProperty(obj, proto->names[in.arg], &proto->caches[in.cache])); break; }
+                case OpCode::SET_PROP: { Value v = pop(); Value obj = pop(); stack.push_back(ip.setProperty(std::move(obj), proto->names[in.arg], v, &proto->caches[in.cache])); break; }
+                case OpCode::GET_METHOD: { Value& obj = stack.back(); const auto& n = proto->names[in.arg];
+                    if(auto inst = std::get_if<Ref<Instance>>(&obj.data)){
+                        Value* field; Function* method; Interpreter::lookupMember(**inst, n, &proto->caches[in.cache], field, method);
+                        if(method){ Value self = std::move(obj); obj = Value(Ref<Function>(method)); stack.push_back(std::move(self)); break; }
+                        if(!field) throw RuntimeError("Undefined property: "+n);
+                        obj = Value(*field);
+                    } else if(auto no = std::get_if<Ref<NativeObject>>(&obj.data)){
+                        auto m = (*no)->type.findMethod(n); if(!m) throw RuntimeError((*no)->type.name+" has no property: "+n);
+                        Value self = std::move(obj); obj = Value(*m); stack.push_back(std::move(self)); break;
+                    } else obj = ip.getProperty(Value(obj), n, &proto->caches[in.cache]);
+                    stack.emplace_back(); break; }
+                case OpCode::GET_INDEX: { Value idx = pop(); Value obj = pop(); stack.push_back(ip.getIndex(obj, idx)); break; }
+                case OpCode::SET_INDEX: { Value obj = pop(); Value v = pop(); Value idx = pop(); stack.push_back(Interpreter::assignIndex(obj, idx, v, "Index assignment supported on list/dict")); break; }
+                case OpCode::SET_INDEX_LOCAL: { Value v = pop(); Value idx = pop(); stack.push_back(Interpreter::assignIndex(env->ancestor(in.depth)->slots[in.arg], idx, v, "Index assignment on non-indexable variable")); break; }
+                case OpCode::SET_INDEX_GLOBAL: { Value v = pop(); Value idx = pop(); const auto& n = proto->names[in.arg];
+                    Value* slot = ip.globals->getPtr(n); if(!slot) throw RuntimeError("Undefined variable: "+n);
+                    stack.push_back(Interpreter::assignIndex(*slot, idx, v, "Index assignment on non-indexable variable")); break; }
+                case OpCode::SET_INDEX_PROP: { Value base = pop(); Value v = pop(); Value idx = pop(); const auto& n = proto->names[in.arg];
+                    if(!ip.assignIndexOnProperty(base, n, idx, v)){ Value tmp = ip.getProperty(base, n); Interpreter::assignIndex(tmp, idx, v, "Index assignment supported on list/dict"); }
+                    stack.push_back(std::move(v)); break; }
+                case OpCode::ADD: { auto a = std::get_if<double>(&stack[stack.size()-2].data); auto b = std::get_if<double>(&stack.back().data);
+                    if(a && b){ *a += *b; stack.pop_back(); } else binop(TokenType::PLUS); break; }
+                case OpCode::SUB: { auto a = std::get_if<double>(&stack[stack.size()-2].data); auto b = std::get_if<double>(&stack.back().data);
+                    if(a && b){ *a -= *b; stack.pop_back(); } else binop(TokenType::MINUS); break; }
+                case OpCode::MUL: { auto a = std::get_if<double>(&stack[stack.size()-2].data); auto b = std::get_if<double>(&stack.back().data);
+                    if(a && b){ *a *= *b; stack.pop_back(); } else binop(TokenType::STAR); break; }
+                case OpCode::DIV: binop(TokenType::SLASH); break;
+                case OpCode::MOD: binop(TokenType::PERCENT); break;
+                case OpCode::EQ: { Value r = pop(); stack.back() = Value(Interpreter::equal(stack.back(), r)); break; }
+                case OpCode::NE: { Value r = pop(); stack.back() = Value(!Interpreter::equal(stack.back(), r)); break; }
+                case OpCode::LT: case OpCode::LE: case OpCode::GT: case OpCode::GE: {
+                    auto a = std::get_if<double>(&stack[stack.size()-2].data); auto b = std::get_if<double>(&stack.back().data);
+                    if(!a || !b) throw RuntimeError("Expected number");
+                    bool r = in.op==OpCode::LT? *a<*b : in.op==OpCode::LE? *a<=*b : in.op==OpCode::GT? *a>*b : *a>=*b;
+                    stack.pop_back(); stack.back() = Value(r); break; }
+                case OpCode::NOT: stack.back() = Value(!Interpreter::isTruthy(stack.back())); break;
+                case OpCode::NEG: { auto n = std::get_if<double>(&stack.back().data); if(!n) throw RuntimeError("Unary '-' on non-number"); *n = -*n; break; }
+                case OpCode::TRUTHY: stack.back() = Value(Interpreter::isTruthy(stack.back())); break;
+                case OpCode::JUMP: pc = proto->code.data() + in.arg; break;
+                case OpCode::LOOP: ip.tick(); pc = proto->code.data() + in.arg; break;
+                case OpCode::JUMP_IF_FALSE: { bool t = Interpreter::isTruthy(stack.back()); stack.pop_back(); if(!t) pc = proto->code.data() + in.arg; break; }
+                case OpCode::JUMP_IF_TRUE: { bool t = Interpreter::isTruthy(stack.back()); stack.pop_back(); if(t) pc = proto->code.data() + in.arg; break; }
+                case OpCode::CALL: {
+                    size_t argc = (size_t)in.arg; size_t calleeAt = stack.size()-argc-1;
+                    f->pc = pc;
+                    if(auto uf = std::get_if<Ref<Function>>(&stack[calleeAt].data); uf && (*uf)->proto){
+                        pushFrame(*uf, (*uf)->boundThis, stack.data()+calleeAt+1, (int)argc, argc+1); reload(); break;
+                    }
+                    callSlow(calleeAt, false); break;
+                }
+                case OpCode::INVOKE: { // stack: callee, receiver (nil unless callee is an unbound method), args
+                    size_t argc = (size_t)in.arg; size_t calleeAt = stack.size()-argc-2;
+                    f->pc = pc;
+                    if(auto uf = std::get_if<Ref<Function>>(&stack[calleeAt].data); uf && (*uf)->proto){
+                        const Value& self = stack[calleeAt+1];
+                        pushFrame(*uf, self.isNull()? (*uf)->boundThis : self, stack.data()+calleeAt+2, (int)argc, argc+2); reload(); break;
+                    }
+                    callSlow(calleeAt, true); break;
+                }
+                case OpCode::LIST: { size_t n = (size_t)in.arg; List lst(std::make_move_iterator(stack.end()-n), std::make_move_iterator(stack.end())); stack.resize(stack.size()-n); stack.push_back(Value(std::move(lst))); break; }
+                case OpCode::DICT: { size_t n = (size_t)in.arg*2; Dict d; for(size_t i=stack.size()-n; i<stack.size(); i+=2) d[stack[i].str()] = stack[i+1];
+                    stack.resize(stack.size()-n); stack.push_back(Value(std::move(d))); break; }
+                case OpCode::CLOSURE: { const auto& p = proto->protos[in.arg]; auto fn = makeRef<Function>(p->name, p->params, nullptr, f->env, false); fn->proto = p; stack.push_back(Value(fn)); break; }
+                case OpCode::CLASS: { const auto& cp = *proto->classes[in.arg]; std::unordered_map<Symbol, Ref<Function>> methods;
+                    for(const auto& m: cp.methods){ auto fn = makeRef<Function>(m->name, m->params, nullptr, f->env, m->isInit); fn->proto = m; methods[m->name] = fn; }
+                    stack.push_back(Value(makeRef<Class>(cp.name, methods))); break; }
+                case OpCode::IMPORT: f->pc = pc; ip.execImport(proto->names[in.arg].str()); f = &frames.back(); break;
+                case OpCode::UNPACK: { Value rv = pop(); auto lst = rv.asList();
+                    if(!lst) throw RuntimeError("Right-hand side of multi-assign must be a list");
+                    if(lst->size()!=(size_t)in.arg) throw RuntimeError("Multi-assign length mismatch");
+                    for(const auto& v: *lst){ stack.push_back(v); } break; }
+                case OpCode::ITER_PREP: { Value& it = stack.back();
+                    if(auto d = it.asDict()){ List keys; keys.reserve(d->size()); for(const auto& kv: *d) keys.push_back(Value(kv.first)); it = Value(std::move(keys)); }
+                    else if(!it.asList() && !it.isString() && !(std::holds_alternative<Ref<NativeObject>>(it.data) && std::get<Ref<NativeObject>>(it.data)->type.next)) throw RuntimeError("for 'in' expects list, dict, string, or an iterable object");
+                    stack.emplace_back(0.0); break; }
+                case OpCode::ITER_NEXT: { double& i = std::get<double>(stack.back().data); const Value& it = stack[stack.size()-2]; size_t k = (size_t)i;
+                    Value next; bool has = false;
+                    if(auto l = it.asList()){ if(k<l->size()){ next = (*l)[k]; has = true; } }
+                    else if(auto o = std::get_if<Ref<NativeObject>>(&it.data)){ NativeObject& obj = **o; f->pc = pc; has = obj.type.next(obj, next); }
+                    else { const auto& s = it.str(); if(k<s.size()){ next = Value(std::string(1, s[k])); has = true; } }
+                    if(has){ i += 1; stack.push_back(std::move(next)); } else { stack.resize(stack.size()-2); pc = proto->code.data() + in.arg; }
+                    break; }
+                case OpCode::ENTER_BLOCK: { auto local = makeRef<Environment>(f->env); local->slots.resize(in.arg); f->env = std::move(local); env = f->env.get(); break; }
+                case OpCode::LEAVE_BLOCK: { Ref<Environment> up(env->ancestor(in.arg)); f->env = std::move(up); env = f->env.get(); break; }
+                case OpCode::RETURN: {
+                    Value result = pop();
+                    if(f->fn && f->fn->isInit) result = env->ancestor(in.depth)->slots[0];
+                    stack.resize(f->base); frames.pop_back();
+                    if(frames.size()==entry) return result;
+                    reload(); stack.push_back(std::move(result)); break;
+                }
+            }
+        }
+    } catch(...){ frames.erase(frames.begin()+entry, frames.end()); stack.resize(entryStack); throw; }
+}
+
+// Builtins
+static Value builtin_print(Interpreter&, const std::vector<Value>& args){ std::ostringstream oss; for(size_t i=0;i<args.size();++i){ const Value& v=args[i]; if(i) oss<<" "; if(auto n=std::get_if<double>(&v.data)) oss<<*n; else if(auto s=v.asString()) oss<<*s; else if(auto b=std::get_if<bool>(&v.data)) oss<<(*b?"true":"false"); else if(std::holds_alternative<std::monostate>(v.data)) oss<<"null"; else if(auto l=v.asList()){ oss<<"["; for(size_t j=0;j<l->size();++j){ if(j) oss<<", "; const Value& e=(*l)[j]; if(auto en=std::get_if<double>(&e.data)) oss<<*en; else if(auto es=e.asString()) oss<<'"'<<*es<<'"'; else oss<<"...";} oss<<"]"; } else if(auto d=v.asDict()){ oss<<"{"; size_t j=0; for(auto& kv:*d){ if(j++) oss<<", "; oss<<kv.first<<": "; const Value& e=kv.second; if(auto en=std::get_if<double>(&e.data)) oss<<*en; else if(auto es=e.asString()) oss<<'"'<<*es<<'"'; else oss<<"...";} oss<<"}"; } else { oss<<"<"<<v.typeName()<<">";} }
+    oss<<"\n"; writeConsole(std::cout, oss.str()); return Value(); }
+
+static Value builtin_len(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("len expects 1 arg"); if(auto l=args[0].asList()) return Value((double)l->size()); if(auto s=args[0].asString()) return Value((double)s->size()); if(auto d=args[0].asDict()) return Value((double)d->size()); throw RuntimeError("len on unsupported type"); }
+
+static Value builtin_input(Interpreter&, const std::vector<Value>& args){ if(args.size()>1) throw RuntimeError("input expects 0 or 1 arg"); if(args.size()==1){ if(auto s=args[0].asString()) writeConsole(std::cout, *s); else throw RuntimeError("input prompt must be string"); }
+    else writeConsole(std::cout, "");
+    std::string line; std::getline(std::cin, line); return Value(line); }
+
+static Value builtin_map(Interpreter& ip, const std::vector<Value>& args){ if(args.size()!=2) throw RuntimeError("map expects (func, list)"); auto fptr = std::get_if<Ref<Function>>(&args[0].data); auto nptr = std::get_if<Ref<NativeFunction>>(&args[0].data); auto lptr = args[1].asList(); if(!lptr) throw RuntimeError("map arg2 must be list"); List out; out.reserve(lptr->size()); for(const auto& v: *lptr){ if(fptr){ out.push_back((*fptr)->call(ip, {v})); } else if(nptr){ out.push_back((*nptr)->call(ip, {v})); } else throw RuntimeError("map arg1 must be callable"); } return Value(out); }
+
+static Value builtin_sqrt_bs(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("sqrt_bs expects 1 arg"); double x; if(auto n=std::get_if<double>(&args[0].data)) x=*n; else throw RuntimeError("sqrt_bs needs number"); if(x<0) throw RuntimeError("sqrt_bs domain error"); if(x==0) return Value(0.0); double lo=0, hi=std::max(1.0, x), mid; for(int i=0;i<100;i++){ mid=(lo+hi)/2; if(mid*mid>=x) hi=mid; else lo=mid; } return Value((lo+hi)/2); }
+
+static Value builtin_range(Interpreter&, const std::vector<Value>& args){ auto asInt=[&](const Value& v)->long long{ if(auto n=std::get_if<double>(&v.data)) return (long long)*n; throw RuntimeError("range expects numbers");}; long long start=0, stop=0, step=1; if(args.size()==1){ stop=asInt(args[0]); } else if(args.size()==2){ start=asInt(args[0]); stop=asInt(args[1]); } else if(args.size()==3){ start=asInt(args[0]); stop=asInt(args[1]); step=asInt(args[2]); if(step==0) throw RuntimeError("range step cannot be 0"); } else throw RuntimeError("range expects 1..3 args"); List out; if(step>0){ for(long long i=start;i<stop;i+=step) out.push_back(Value((double)i)); } else { for(long long i=start;i>stop;i+=step) out.push_back(Value((double)i)); } return Value(out); }
+
+// Additional builtins for casting and string/list operations
+static Value builtin_int(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("int expects 1 arg"); if(auto n=std::get_if<double>(&args[0].data)) return Value((double)(long long)(*n)); if(auto s=args[0].asString()) return Value((double)std::stoll(*s)); if(auto b=std::get_if<bool>(&args[0].data)) return Value(*b?1.0:0.0); throw RuntimeError("int() unsupported type"); }
+static Value builtin_float(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("float expects 1 arg"); if(auto n=std::get_if<double>(&args[0].data)) return Value(*n); if(auto s=args[0].asString()) return Value(std::stod(*s)); if(auto b=std::get_if<bool>(&args[0].data)) return Value(*b?1.0:0.0); throw RuntimeError("float() unsupported type"); }
+static std::string strOf(const Value& v){ if(auto s=v.asString()) return *s;
+    if(auto n=std::get_if<double>(&v.data)){ char buf[32]; std::snprintf(buf, sizeof buf, "%g", *n); return buf; } // same text as ostream's default float format
+    std::ostringstream oss; if(auto b=std::get_if<bool>(&v.data)) oss<<(*b?"true":"false"); else if(std::holds_alternative<std::monostate>(v.data)) oss<<"null"; else oss<<"<"<<v.typeName()<<">"; return oss.str(); }
+static Value builtin_str(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("str expects 1 arg"); return Value(strOf(args[0])); }
+static Value builtin_split(Interpreter&, const std::vector<Value>& args){ if(args.size()<1||args.size()>2) throw RuntimeError("split expects (string[, sep])"); if(!args[0].isString()) throw RuntimeError("split first arg must be string"); std::string s=args[0].str(); std::string sep = (args.size()==2)? args[1].str() : std::string(); List out; if(sep.empty()){ std::istringstream iss(s); std::string part; while(iss>>part) out.push_back(Value(part)); } else { size_t pos=0; while(true){ size_t n=s.find(sep, pos); if(n==std::string::npos){ out.push_back(Value(s.substr(pos))); break; } out.push_back(Value(s.substr(pos, n-pos))); pos = n+sep.size(); } } return Value(out); }
+static Value builtin_join(Interpreter&, const std::vector<Value>& args){ if(args.size()!=2) throw RuntimeError("join expects (list, sep)"); auto lst = args[0].asList(); if(!lst) throw RuntimeError("join first arg must be list of strings"); std::string sep = args[1].str(); std::ostringstream oss; for(size_t i=0;i<lst->size();++i){ if(i) oss<<sep; oss<<(*lst)[i].str(); } return Value(oss.str()); }
+static Value builtin_has(Interpreter&, const std::vector<Value>& args){ if(args.size()!=2) throw RuntimeError("has expects (dict, key)"); auto d = args[0].asDict(); if(!d) throw RuntimeError("has first arg must be dict"); auto key = args[1].str(); return Value((bool)(d->find(key)!=d->end())); }
+#ifdef _WIN32
+#include <windows.h>
+#include <winhttp.h>
+#pragma comment(lib, "winhttp.lib")
+#endif
+
+// Lowest native stack address the tree walker may use on this thread. It recurses on the native stack, so a call
+// fails with a RuntimeError once less than kStackReserve bytes are left, instead of crashing the process.
+static uintptr_t stackFloor(){ constexpr uintptr_t kStackReserve = 256*1024;
+    thread_local uintptr_t floor = [](){ uintptr_t lo = 0;
+#if defined(_WIN32)
+        ULONG_PTR l = 0, h = 0; GetCurrentThreadStackLimits(&l, &h); lo = (uintptr_t)l;
+#elif defined(__APPLE__)
+        pthread_t t = pthread_self(); lo = (uintptr_t)pthread_get_stackaddr_np(t) - pthread_get_stacksize_np(t);
+#else
+        pthread_attr_t a; if(pthread_getattr_np(pthread_self(), &a) == 0){ void* addr = nullptr; size_t size = 0; pthread_attr_getstack(&a, &addr, &size); lo = (uintptr_t)addr; pthread_attr_destroy(&a); }
+#endif
+        return lo? lo + kStackReserve : 0; }();
+    return floor; }
+
+// Receives a response body chunk by chunk instead of buffering it; returning false stops the transfer early
+using HttpSink = std::function<bool(const char*, size_t)>;
+
+// Adds one raw response header line ("Name: value", CRLF optional) to `headers`. A status line starts a new response
+// (after a redirect or 100-continue) and clears what was collected; repeated headers are joined with ", ".
+static void addHeaderLine(Dict& headers, const char* p, size_t n){
+    while(n && (p[n-1]=='\r' || p[n-1]=='\n')) n--;
+    if(n>=5 && std::memcmp(p, "HTTP/", 5)==0){ headers.clear(); return; }
+    const char* colon = (const char*)std::memchr(p, ':', n); if(!colon || colon==p) return;
+    const char* v = colon + 1; const char* end = p + n;
+    while(v<end && (*v==' ' || *v=='\t')) v++;
+    while(end>v && (end[-1]==' ' || end[-1]=='\t')) end--;
+    auto [it, fresh] = headers.try_emplace(std::string(p, colon), Value(std::string(v, end)));
+    if(!fresh){ std::string joined = it->second.str(); joined.append(", ").append(v, end); it->second = Value(std::move(joined)); }
+}
+
+#if !defined(_WIN32) && !defined(ADASCRIPT_NO_CURL)
+// File-scope libcurl write callback (C signature). Chunks go to the sink when there is one, else into `s`.
+// Exceptions from the sink cannot cross libcurl; they are parked in `err` and rethrown after the transfer.
+struct CurlBuf { std::string s; Dict headers; const HttpSink* sink = nullptr; size_t bytes = 0; bool stopped = false; std::exception_ptr err; };
+static size_t curl_write_cb(char* ptr, size_t size, size_t nmemb, void* userdata){
+    CurlBuf* b = reinterpret_cast<CurlBuf*>(userdata);
+    if(!b || !ptr) return 0;
+    size_t total = size * nmemb;
+    b->bytes += total;
+    if(!b->sink){ b->s.append(ptr, total); return total; }
+    try { if((*b->sink)(ptr, total)) return total; b->stopped = true; } catch(...) { b->err = std::current_exception(); }
+    return 0;
+}
+// Header callback: the headers dict is filled line by line while the response arrives
+static size_t curl_header_cb(char* ptr, size_t size, size_t nmemb, void* userdata){
+    CurlBuf* b = reinterpret_cast<CurlBuf*>(userdata);
+    size_t total = size * nmemb;
+    try { addHeaderLine(b->headers, ptr, total); } catch(...) { b->err = std::current_exception(); return 0; }
+    return total;
+}
+#endif
+
+// Header names compare case-insensitively
+static bool headerNameIs(const std::string& a, const char* b){ size_t n = std::strlen(b); if(a.size()!=n) return false;
+    for(size_t i=0;i<n;i++){ if(std::tolower((unsigned char)a[i])!=std::tolower((unsigned char)b[i])) return false; } return true; }
+static const Value* headerOf(const Dict& headers, const char* name){ for(const auto& kv: headers) if(headerNameIs(kv.first, name)) return &kv.second; return nullptr; }
+// Parses an IMF-fixdate ("Wed, 01 Jan 2025 00:00:00 GMT") to unix seconds; -1 if it is not one
+static int64_t parseHttpDate(const std::string& s){ char mon[4] = {0}; int d, y, hh, mm, ss;
+    if(std::sscanf(s.c_str(), "%*3s, %d %3s %d %d:%d:%d", &d, mon, &y, &hh, &mm, &ss) != 6) return -1;
+    static const char* months[] = {"Jan","Feb","Mar","Apr","May","Jun","Jul","Aug","Sep","Oct","Nov","Dec"}; int m = 0; while(m<12 && std::strcmp(months[m], mon)) m++; if(m==12) return -1;
+    // days from civil, proleptic Gregorian
+    int yy = y - (m<2); int era = (yy>=0? yy : yy-399) / 400; unsigned yoe = (unsigned)(yy - era*400); unsigned mp = (unsigned)((m+1 + 9) % 12);
+    unsigned doy = (153*mp + 2)/5 + (unsigned)d - 1; unsigned doe = yoe*365 + yoe/4 - yoe/100 + doy;
+    return ((int64_t)era*146097 + (int64_t)doe - 719468) * 86400 + hh*3600 + mm*60 + ss; }
+
+// Opt-in response cache for GETs (requests.cache): a byte-bounded LRU in memory in front of a byte-bounded directory
+// of entry files that outlives the process. Entries are keyed by method and URL and remember the request values of
+// the headers named in Vary. Freshness comes from Cache-Control max-age / no-cache / no-store, Age and Expires;
+// a stale entry with an ETag or Last-Modified is revalidated with a conditional request.
+struct HttpCache {
+    struct Entry { std::string key; double status = 200; Dict headers; Value text; size_t size = 0; int64_t expires = 0; bool noCache = false;
+        std::vector<std::pair<std::string, std::string>> vary; };
+    std::filesystem::path dir; // empty: memory only
+    size_t memoryLimit = 32u<<20, diskLimit = 256u<<20, memoryBytes = 0, diskBytes = 0;
+    uint64_t hits = 0, misses = 0, revalidated = 0, stored = 0, evicted = 0;
+    std::list<Entry> lru; std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+    struct Directives { bool noStore = false, noCache = false; int64_t maxAge = -1; };
+    static Directives directives(const Dict& headers){ Directives d; auto v = headerOf(headers, "Cache-Control"); if(!v || !v->isString()) return d;
+        std::string cc = v->str(); for(auto& ch: cc) ch = (char)std::tolower((unsigned char)ch);
+        d.noStore = cc.find("no-store")!=std::string::npos; d.noCache = cc.find("no-cache")!=std::string::npos;
+        size_t at = cc.find("max-age="); if(at!=std::string::npos && (at==0 || cc[at-1]==' ' || cc[at-1]==',')) d.maxAge = std::atoll(cc.c_str()+at+8);
+        return d; }
+    // Seconds from now the response stays fresh (<= 0: stale at once)
+    static int64_t lifetime(const Dict& headers, int64_t now){ Directives d = directives(headers); int64_t life = 0;
+        if(d.maxAge >= 0) life = d.maxAge;
+        else if(auto e = headerOf(headers, "Expires")){ int64_t at = e->isString()? parseHttpDate(e->str()) : -1; auto date = headerOf(headers, "Date"); int64_t base = date && date->isString()? parseHttpDate(date->str()) : -1; life = at<0? 0 : at - (base<0? now : base); }
+        if(auto age = headerOf(headers, "Age")) if(age->isString()) life -= std::atoll(age->str().c_str());
+        return life; }
+    static bool hasValidator(const Dict& headers){ return headerOf(headers, "ETag") || headerOf(headers, "Last-Modified"); }
+    static bool varyMatches(const Entry& e, const Dict& request){ for(const auto& [name, value]: e.vary){ auto v = headerOf(request, name.c_str()); if((v && v->isString()? v->str() : std::string()) != value) return false; } return true; }
+
+    std::filesystem::path fileOf(const std::string& key) const { uint64_t h = 1469598103934665603ull; for(unsigned char c: key){ h ^= c; h *= 1099511628211ull; }
+        char name[24]; std::snprintf(name, sizeof name, "%016llx.entry", (unsigned long long)h); return dir / name; }
+
+    // Memory tier first; a disk entry is promoted into memory. Entries share their body string, so copies are cheap.
+    std::optional<Entry> find(const std::string& key){ auto it = index.find(key);
+        if(it != index.end()){ lru.splice(lru.begin(), lru, it->second); return *it->second; }
+        Entry e; if(!load(key, e)) return std::nullopt;
+        std::error_code ec; std::filesystem::last_write_time(fileOf(key), std::filesystem::file_time_type::clock::now(), ec); // disk LRU order
+        remember(e); return e; }
+    void remember(const Entry& e){ forget(e.key); if(e.size > memoryLimit) return;
+        memoryBytes += e.size; lru.push_front(e); index[e.key] = lru.begin(); fitMemory(); }
+    void fitMemory(){ while(memoryBytes > memoryLimit){ memoryBytes -= lru.back().size; index.erase(lru.back().key); lru.pop_back(); } }
+    void forget(const std::string& key){ auto it = index.find(key); if(it==index.end()) return; memoryBytes -= it->second->size; lru.erase(it->second); index.erase(it); }
+    void store(Entry& e){ e.size = e.key.size() + e.text.str().size(); for(const auto& kv: e.headers) e.size += kv.first.size() + (kv.second.isString()? kv.second.str().size() : 0);
+        stored++; save(e); remember(e); }
+
+    // Entry files: a magic line, then length-prefixed fields, so bodies and header values need no escaping
+    void save(const Entry& e){ if(dir.empty()) return; std::filesystem::path path = fileOf(e.key), tmp = path; tmp += ".tmp"; std::error_code ec;
+        { std::ofstream out(tmp, std::ios::binary); if(!out) return;
+          auto put = [&](const std::string& s){ out << s.size() << '\n'; out.write(s.data(), (std::streamsize)s.size()); };
+          out << "adascript-http-cache 1\n"; put(e.key); put(strOf(Value(e.status))); put(std::to_string(e.expires)); put(e.noCache? "1" : "0");
+          put(std::to_string(e.vary.size())); for(const auto& [n, v]: e.vary){ put(n); put(v); }
+          put(std::to_string(e.headers.size())); for(const auto& kv: e.headers){ put(kv.first); put(kv.second.isString()? kv.second.str() : std::string()); }
+          put(e.text.str()); if(!out) { out.close(); std::filesystem::remove(tmp, ec); return; } }
+        uintmax_t before = std::filesystem::exists(path, ec)? std::filesystem::file_size(path, ec) : 0;
+        std::filesystem::rename(tmp, path, ec); if(ec){ std::filesystem::remove(tmp, ec); return; }
+        diskBytes = diskBytes - std::min<size_t>(diskBytes, (size_t)before) + (size_t)std::filesystem::file_size(path, ec);
+        if(diskBytes > diskLimit) trimDisk(); }
+    bool load(const std::string& key, Entry& e) const { if(dir.empty()) return false; std::ifstream in(fileOf(key), std::ios::binary); if(!in) return false;
+        std::string line; if(!std::getline(in, line) || line != "adascript-http-cache 1") return false;
+        bool ok = true; auto get = [&](){ size_t n = 0; std::string s; if(!(in >> n) || in.get()!='\n'){ ok = false; return s; } s.resize(n); in.read(s.data(), (std::streamsize)n); if((size_t)in.gcount()!=n) ok = false; return s; };
+        e.key = get(); if(!ok || e.key != key) return false;
+        e.status = std::atof(get().c_str()); e.expires = std::atoll(get().c_str()); e.noCache = get()=="1";
+        size_t nv = (size_t)std::atoll(get().c_str()); for(size_t i=0; ok && i<nv; i++){ std::string n = get(); e.vary.emplace_back(std::move(n), get()); }
+        size_t nh = (size_t)std::atoll(get().c_str()); for(size_t i=0; ok && i<nh; i++){ std::string n = get(); e.headers[n] = Value(get()); }
+        std::string body = get(); if(!ok) return false;
+        e.size = key.size() + body.size(); for(const auto& kv: e.headers) e.size += kv.first.size() + kv.second.str().size();
+        e.text = Value(std::move(body)); return true; }
+    // Drops the least recently used entry files until the directory is back under 90% of its limit
+    void trimDisk(){ std::error_code ec; std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files; size_t total = 0;
+        for(auto& de: std::filesystem::directory_iterator(dir, ec)){ if(de.path().extension() != ".entry") continue; total += (size_t)de.file_size(ec); files.emplace_back(de.last_write_time(ec), de.path()); }
+        std::sort(files.begin(), files.end());
+        for(auto& f: files){ if(total <= diskLimit / 10 * 9) break; size_t n = (size_t)std::filesystem::file_size(f.second, ec); if(std::filesystem::remove(f.second, ec)){ total -= std::min(total, n); evicted++; } }
+        diskBytes = total; }
+    // Entries read back from 'dir' are served as responses, so it has to pass privateCacheDir like the module cache
+    bool open(){ if(dir.empty()) return true; if(!privateCacheDir(dir)) return false; std::error_code ec;
+        diskBytes = 0; for(auto& de: std::filesystem::directory_iterator(dir, ec)) if(de.path().extension() == ".entry") diskBytes += (size_t)de.file_size(ec);
+        if(diskBytes > diskLimit){ trimDisk(); } return true; }
+    void clear(){ lru.clear(); index.clear(); memoryBytes = 0; if(dir.empty()) return; std::error_code ec;
+        for(auto& de: std::filesystem::directory_iterator(dir, ec)) if(de.path().extension() == ".entry") std::filesystem::remove(de.path(), ec);
+        diskBytes = 0; }
+};
+
+// HTTP client state of one Interpreter. With libcurl, finished easy handles are kept in a pool and all handles share
+// one DNS cache, TLS session cache and connection cache, so repeated requests to a host reuse a kept-alive connection.
+struct HttpClient {
+    size_t poolSize = 8;   // idle handles kept, and connections kept open
+    long idleTimeout = 60; // seconds an idle connection may be reused before it is closed
+    uint64_t requests = 0, connects = 0;
+    std::unique_ptr<HttpCache> cache; // set by requests.cache
+#if !defined(_WIN32) && !defined(ADASCRIPT_NO_CURL)
+    CURLSH* share = nullptr; std::vector<CURL*> idle; std::mutex locks[CURL_LOCK_DATA_LAST];
+    HttpClient(){
+        static std::once_flag curl_once; std::call_once(curl_once, [](){ curl_global_init(CURL_GLOBAL_DEFAULT); });
+        share = curl_share_init();
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, +[](CURL*, curl_lock_data d, curl_lock_access, void* u){ static_cast<HttpClient*>(u)->locks[d].lock(); });
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, +[](CURL*, curl_lock_data d, void* u){ static_cast<HttpClient*>(u)->locks[d].unlock(); });
+        curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    #if LIBCURL_VERSION_NUM >= 0x073900
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    #endif
+    }
+    ~HttpClient(){ for(CURL* h: idle) curl_easy_cleanup(h); if(share) curl_share_cleanup(share); }
+    HttpClient(const HttpClient&) = delete; HttpClient& operator=(const HttpClient&) = delete;
+
+    // CA bundle for HTTPS, probed once per process; nullptr means none was found
+    static const char* caBundle(){ static const char* ca = [](){ for(const char* p: {"/etc/ssl/certs/ca-certificates.crt", "/etc/ssl/cert.pem", "/etc/pki/tls/certs/ca-bundle.crt", "/etc/ssl/certs/ca-bundle.crt"})
+            { if(FILE* f = fopen(p, "rb")){ fclose(f); return p; } } return (const char*)nullptr; }(); return ca; }
+
+    // A handle with the options every request shares; give it back with release()
+    CURL* acquire(){ CURL* h = nullptr; if(!idle.empty()){ h = idle.back(); idle.pop_back(); curl_easy_reset(h); } else if(!(h = curl_easy_init())) return nullptr;
+        curl_easy_setopt(h, CURLOPT_SHARE, share);
+        curl_easy_setopt(h, CURLOPT_MAXCONNECTS, (long)poolSize);
+    #if LIBCURL_VERSION_NUM >= 0x074100
+        curl_easy_setopt(h, CURLOPT_MAXAGE_CONN, idleTimeout);
+    #endif
+        curl_easy_setopt(h, CURLOPT_TCP_KEEPALIVE, 1L);
+        return h; }
+    void release(CURL* h){ if(idle.size()<poolSize) idle.push_back(h); else curl_easy_cleanup(h); }
+    void trim(){ while(idle.size()>poolSize){ curl_easy_cleanup(idle.back()); idle.pop_back(); } }
+#else
+    void trim(){}
+#endif
+};
+
+static HttpClient& httpClient(Interpreter& ip){ if(!ip.http) ip.http = std::make_shared<HttpClient>(); return *ip.http; }
+
+#if !defined(_WIN32) && !defined(ADASCRIPT_NO_CURL)
+// One libcurl transfer: a pooled easy handle plus the buffers it reads and writes. It must not move once opened;
+// the destructor gives the handle back to the pool.
+struct HttpTransfer {
+    HttpClient& client; CURL* h = nullptr; CurlBuf buf; struct curl_slist* hdrs = nullptr; char errbuf[CURL_ERROR_SIZE] = {0}; std::string body;
+    explicit HttpTransfer(HttpClient& c): client(c) {}
+    ~HttpTransfer(){ if(hdrs) curl_slist_free_all(hdrs); if(h) client.release(h); }
+    HttpTransfer(const HttpTransfer&) = delete; HttpTransfer& operator=(const HttpTransfer&) = delete;
+    bool open(const std::string& method, const std::string& url, const std::string& data, const std::unordered_map<std::string, std::string>& extra_headers){
+        if(!(h = client.acquire())) return false;
+        client.requests++; body = data;
+        curl_easy_setopt(h, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(h, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(h, CURLOPT_WRITEFUNCTION, curl_write_cb);
+        curl_easy_setopt(h, CURLOPT_WRITEDATA, &buf);
+        curl_easy_setopt(h, CURLOPT_HEADERFUNCTION, curl_header_cb);
+        curl_easy_setopt(h, CURLOPT_HEADERDATA, &buf);
+        // Prefer HTTP/1.1 for broader compatibility in constrained envs
+        curl_easy_setopt(h, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+        curl_easy_setopt(h, CURLOPT_USERAGENT, "AdaScript/2.0");
+        // TLS configuration for WSL/Linux: try CA bundle, else relax verification as last resort
+        if(url.rfind("https://", 0) == 0){
+            if(const char* ca = HttpClient::caBundle()) curl_easy_setopt(h, CURLOPT_CAINFO, ca);
+            else {
+                // Fall back: disable peer/host verification (not recommended for production)
+                curl_easy_setopt(h, CURLOPT_SSL_VERIFYPEER, 0L);
+                curl_easy_setopt(h, CURLOPT_SSL_VERIFYHOST, 0L);
+            }
+        }
+        if(!body.empty()){
+            curl_easy_setopt(h, CURLOPT_POSTFIELDS, body.c_str());
+            curl_easy_setopt(h, CURLOPT_POSTFIELDSIZE, (long)body.size());
+        }
+        // Default headers for broader compatibility
+        hdrs = curl_slist_append(hdrs, "Accept: */*");
+        for(const auto& kv : extra_headers){ std::string line = kv.first + ": " + kv.second; hdrs = curl_slist_append(hdrs, line.c_str()); }
+        if(hdrs) curl_easy_setopt(h, CURLOPT_HTTPHEADER, hdrs);
+        curl_easy_setopt(h, CURLOPT_CUSTOMREQUEST, method.c_str());
+        // Avoid signals (SIGPIPE) in libcurl on Linux/WSL
+        curl_easy_setopt(h, CURLOPT_NOSIGNAL, 1L);
+        // Disable compression to avoid decoder issues in constrained envs
+        curl_easy_setopt(h, CURLOPT_ACCEPT_ENCODING, "");
+        curl_easy_setopt(h, CURLOPT_ERRORBUFFER, errbuf);
+        return true; }
+    long status() const { long code = 0; curl_easy_getinfo(h, CURLINFO_RESPONSE_CODE, &code); return code; }
+    // The response of a completed transfer: status, headers, text (or bytes with a sink), timing breakdown and sizes.
+    // Timing points are seconds from the start of the request, as curl reports them.
+    Dict response(){ Dict r; long code = status(); r["status"] = Value((double)code); r["headers"] = Value(std::move(buf.headers));
+        if(buf.sink) r["bytes"] = Value((double)buf.bytes); else { r["bytes"] = Value((double)buf.s.size()); r["text"] = Value(std::move(buf.s)); }
+        if(code == 304) r["not_modified"] = Value(true);
+        Dict timing; double t = 0;
+        for(auto [key, info]: {std::pair{"dns", CURLINFO_NAMELOOKUP_TIME}, {"connect", CURLINFO_CONNECT_TIME}, {"tls", CURLINFO_APPCONNECT_TIME}, {"first_byte", CURLINFO_STARTTRANSFER_TIME}, {"total", CURLINFO_TOTAL_TIME}}){
+            t = 0; curl_easy_getinfo(h, info, &t); timing[key] = Value(t); }
+        r["timing"] = Value(timing);
+        long headerBytes = 0; curl_easy_getinfo(h, CURLINFO_HEADER_SIZE, &headerBytes); r["header_bytes"] = Value((double)headerBytes);
+        r["sent_bytes"] = Value((double)body.size());
+        char* effective = nullptr; if(curl_easy_getinfo(h, CURLINFO_EFFECTIVE_URL, &effective)==CURLE_OK && effective) r["url"] = Value(std::string(effective));
+        return r; }
+    void countConnects(){ long n = 0; curl_easy_getinfo(h, CURLINFO_NUM_CONNECTS, &n); client.connects += (uint64_t)n; }
+    std::string error(CURLcode rc) const { return errbuf[0]? errbuf : curl_easy_strerror(rc); }
+};
+#endif
+
+// HTTP helpers using WinHTTP on Windows or libcurl elsewhere; supports http and https
+// Feeds a stream to a sink in fixed-size chunks; returns the bytes delivered
+static size_t sinkStream(std::istream& in, const HttpSink& sink){ std::vector<char> chunk(64*1024); size_t total = 0;
+    while(in){ in.read(chunk.data(), (std::streamsize)chunk.size()); size_t n = (size_t)in.gcount(); if(!n) break; total += n; if(!sink(chunk.data(), n)) break; }
+    return total; }
+
+// With a sink the body is handed over chunk by chunk and the response has `bytes` instead of `text`
+static Dict http_request(Interpreter& ip, const std::string& method, const std::string& url, const std::string& body, const std::unordered_map<std::string, std::string>& extra_headers, const HttpSink* sink = nullptr){
+    // file:// short-circuit on all platforms
+    const std::string filePrefix = "file://";
+    if(url.rfind(filePrefix, 0) == 0){
+        std::string path = url.substr(filePrefix.size());
+        std::ifstream in(path, std::ios::binary);
+        if(!in) throw RuntimeError("requests."+method+": cannot open file");
+        Dict resp; resp["status"] = Value((double)200);
+        if(sink){ resp["bytes"] = Value((double)sinkStream(in, *sink)); return resp; }
+        std::string text = readAll(in); resp["bytes"] = Value((double)text.size()); resp["text"] = Value(std::move(text)); return resp;
+    }
+#ifdef _WIN32
+    // Windows: WinHTTP
+    httpClient(ip).requests++;
+    URL_COMPONENTS uc{}; ZeroMemory(&uc, sizeof(uc));
+    wchar_t host[256]; wchar_t path[2048];
+    wchar_t scheme[16];
+    uc.dwStructSize = sizeof(uc);
+    uc.lpszHostName = host; uc.dwHostNameLength = _countof(host);
+    uc.lpszUrlPath = path; uc.dwUrlPathLength = _countof(path);
+    uc.lpszScheme = scheme; uc.dwSchemeLength = _countof(scheme);
+    if(!WinHttpCrackUrl(std::wstring(url.begin(), url.end()).c_str(), 0, 0, &uc)){
+        throw RuntimeError("requests."+method+": invalid URL");
+    }
+    bool secure = (uc.nScheme == INTERNET_SCHEME_HTTPS);
+
+    HINTERNET hSession = WinHttpOpen(L"AdaScript/2.0", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
+    if(!hSession) throw RuntimeError("requests."+method+": WinHttpOpen failed");
+    HINTERNET hConnect = WinHttpConnect(hSession, uc.lpszHostName, uc.nPort? uc.nPort : (secure? INTERNET_DEFAULT_HTTPS_PORT : INTERNET_DEFAULT_HTTP_PORT), 0);
+    if(!hConnect){ WinHttpCloseHandle(hSession); throw RuntimeError("requests."+method+": WinHttpConnect failed"); }
+
+    DWORD flags = secure? WINHTTP_FLAG_SECURE : 0;
+    HINTERNET hRequest = WinHttpOpenRequest(hConnect, std::wstring(method.begin(), method.end()).c_str(), uc.lpszUrlPath, nullptr, WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES, flags);
+    if(!hRequest){ WinHttpCloseHandle(hConnect); WinHttpCloseHandle(hSession); throw RuntimeError("requests."+method+": WinHttpOpenRequest failed"); }
+
+    // Build headers
+    std::ostringstream hdrs;
+    for(const auto& kv : extra_headers){ hdrs << kv.first << ": " << kv.second << "\r\n"; }
+    std::string hdrStr = hdrs.str();
+    std::wstring whdr(hdrStr.begin(), hdrStr.end());
+
+    const void* bodyData = body.empty()? nullptr : body.data();
+    DWORD bodySize = (DWORD)body.size();
+
+    BOOL sent = WinHttpSendRequest(hRequest,
+        whdr.empty()? WINHTTP_NO_ADDITIONAL_HEADERS : whdr.c_str(), (DWORD)-1L,
+        (LPVOID)bodyData, bodySize, bodySize, 0);
+    if(!sent){ WinHttpCloseHandle(hRequest); WinHttpCloseHandle(hConnect); WinHttpCloseHandle(hSession); throw RuntimeError("requests."+method+": WinHttpSendRequest failed"); }
+    if(!WinHttpReceiveResponse(hRequest, nullptr)){
+        WinHttpCloseHandle(hRequest); WinHttpCloseHandle(hConnect); WinHttpCloseHandle(hSession);
+        throw RuntimeError("requests."+method+": WinHttpReceiveResponse failed");
+    }
+
+    // Status code
+    DWORD statusCode = 0; DWORD size = sizeof(statusCode);
+    WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER, WINHTTP_HEADER_NAME_BY_INDEX, &statusCode, &size, WINHTTP_NO_HEADER_INDEX);
+
+    // Read body
+    std::string out; size_t bytes = 0;
+    for(;;){
+        DWORD dwSize = 0;
+        if(!WinHttpQueryDataAvailable(hRequest, &dwSize)) break;
+        if(dwSize == 0) break;
+        std::string chunk; chunk.resize(dwSize);
+        DWORD dwRead = 0;
+        if(!WinHttpReadData(hRequest, chunk.data(), dwSize, &dwRead)) break;
+        chunk.resize(dwRead); bytes += dwRead;
+        if(!sink) out.append(chunk);
+        else if(!(*sink)(chunk.data(), chunk.size())) break;
+    }
+
+    // All response headers, from the raw CRLF-separated block
+    Dict headers;
+    DWORD rawLen = 0;
+    WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_RAW_HEADERS_CRLF, WINHTTP_HEADER_NAME_BY_INDEX, WINHTTP_NO_OUTPUT_BUFFER, &rawLen, WINHTTP_NO_HEADER_INDEX);
+    if(rawLen){
+        std::wstring raw(rawLen/sizeof(wchar_t), L'\0');
+        if(WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_RAW_HEADERS_CRLF, WINHTTP_HEADER_NAME_BY_INDEX, raw.data(), &rawLen, WINHTTP_NO_HEADER_INDEX)){
+            std::string block(raw.begin(), raw.begin() + rawLen/sizeof(wchar_t));
+            for(size_t pos = 0; pos < block.size(); ){ size_t eol = block.find("\r\n", pos); if(eol == std::string::npos) eol = block.size(); addHeaderLine(headers, block.data()+pos, eol-pos); pos = eol + 2; }
+        }
+    }
+
+    WinHttpCloseHandle(hRequest); WinHttpCloseHandle(hConnect); WinHttpCloseHandle(hSession);
+
+    Dict resp; resp["status"] = Value((double)statusCode); resp["headers"] = Value(headers); resp["bytes"] = Value((double)bytes);
+    if(statusCode == 304) resp["not_modified"] = Value(true);
+    if(!sink) resp["text"] = Value(out);
+    return resp;
+#else
+    // Non-Windows: libcurl (optional)
+    #ifndef ADASCRIPT_NO_CURL
+      HttpTransfer t(httpClient(ip)); t.buf.sink = sink;
+      if(!t.open(method, url, body, extra_headers)) throw RuntimeError("requests."+method+": curl init failed");
+      CURLcode rc = curl_easy_perform(t.h);
+      if(rc == CURLE_GOT_NOTHING){
+          // Retry once with HTTP/1.0 and Connection: close
+          curl_easy_setopt(t.h, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_0);
+          t.hdrs = curl_slist_append(t.hdrs, "Connection: close");
+          curl_easy_setopt(t.h, CURLOPT_HTTPHEADER, t.hdrs);
+          rc = curl_easy_perform(t.h);
+      }
+      t.countConnects();
+      if(t.buf.err) std::rethrow_exception(t.buf.err);
+      if(rc != CURLE_OK && !(rc == CURLE_WRITE_ERROR && t.buf.stopped)) throw RuntimeError(std::string("requests.")+method+": curl perform failed: "+t.error(rc));
+      return t.response();
+    #else
+      (void)ip; (void)body; (void)extra_headers;
+      throw RuntimeError("HTTP disabled: libcurl not available in this build");
+    #endif
+#endif
+}
+
+static std::unordered_map<std::string, std::string> headersArg(const Value& v, const char* who){ auto d = v.asDict(); if(!d) throw RuntimeError(std::string(who)+" headers must be dict");
+    std::unordered_map<std::string, std::string> out; for(const auto& kv: *d){ if(kv.second.isString()) out[kv.first] = kv.second.str(); } return out; }
+// GET through the response cache when requests.cache is on. Hits carry `cached: true`; a stale entry the server
+// confirmed with 304 also carries `revalidated: true`.
+static Dict cached_get(Interpreter& ip, const std::string& url, const std::unordered_map<std::string, std::string>& hdrs){
+    HttpClient& client = httpClient(ip);
+    if(!client.cache || url.rfind("file://", 0) == 0) return http_request(ip, "GET", url, std::string(), hdrs);
+    HttpCache& cache = *client.cache;
+    Dict request; for(const auto& kv: hdrs) request[kv.first] = Value(kv.second);
+    HttpCache::Directives asked = HttpCache::directives(request);
+    if(asked.noStore) return http_request(ip, "GET", url, std::string(), hdrs);
+    bool userConditional = headerOf(request, "If-None-Match") || headerOf(request, "If-Modified-Since");
+    std::string key = "GET " + url; int64_t now = (int64_t)std::time(nullptr);
+    std::optional<HttpCache::Entry> hit = cache.find(key); if(hit && !HttpCache::varyMatches(*hit, request)) hit.reset();
+    auto serve = [](const HttpCache::Entry& e){ Dict r; r["status"] = Value(e.status); r["headers"] = Value(e.headers); r["text"] = e.text; r["bytes"] = Value((double)e.text.str().size()); r["cached"] = Value(true); return r; };
+    if(hit && !asked.noCache && asked.maxAge != 0 && !hit->noCache && now < hit->expires){ cache.hits++; return serve(*hit); }
+    bool validating = hit && !userConditional && HttpCache::hasValidator(hit->headers);
+    auto sent = hdrs;
+    if(validating){ if(auto v = headerOf(hit->headers, "ETag")) sent["If-None-Match"] = v->str(); if(auto v = headerOf(hit->headers, "Last-Modified")) sent["If-Modified-Since"] = v->str(); }
+    Dict r = http_request(ip, "GET", url, std::string(), sent);
+    double status = std::get<double>(r["status"].data);
+    Dict* got = r["headers"].asDict();
+    if(validating && status == 304){
+        cache.hits++; cache.revalidated++;
+        if(got) for(const auto& kv: *got){ if(!headerNameIs(kv.first, "Content-Length")) hit->headers[kv.first] = kv.second; }
+        hit->expires = now + HttpCache::lifetime(hit->headers, now); cache.store(*hit);
+        Dict out = serve(*hit); out["revalidated"] = Value(true); if(r.count("timing")) out["timing"] = r["timing"]; return out;
+    }
+    cache.misses++;
+    if(status == 200 && got && !userConditional){
+        HttpCache::Directives d = HttpCache::directives(*got); auto vary = headerOf(*got, "Vary"); std::string varyList = vary && vary->isString()? vary->str() : std::string();
+        int64_t life = HttpCache::lifetime(*got, now);
+        if(!d.noStore && varyList.find('*') == std::string::npos && (life > 0 || HttpCache::hasValidator(*got))){
+            HttpCache::Entry e; e.key = key; e.status = status; e.headers = *got; e.text = r["text"]; e.expires = now + life; e.noCache = d.noCache;
+            for(size_t pos = 0; pos < varyList.size(); ){ size_t comma = varyList.find(',', pos); if(comma == std::string::npos) comma = varyList.size();
+                size_t a = varyList.find_first_not_of(" \t", pos), b = varyList.find_last_not_of(" \t", comma - 1);
+                if(a != std::string::npos && a < comma){ std::string name = varyList.substr(a, b - a + 1); auto v = headerOf(request, name.c_str()); e.vary.emplace_back(name, v? v->str() : std::string()); }
+                pos = comma + 1; }
+            cache.store(e); }
+    }
+    return r;
+}
+
+// requests.get(url[, headers])
+static Value builtin_requests_get(Interpreter& ip, const std::vector<Value>& args){ if(args.empty()||args.size()>2) throw RuntimeError("requests.get expects (url[, headers])"); std::string url = args[0].str(); std::unordered_map<std::string,std::string> hdrs; if(args.size()==2) hdrs = headersArg(args[1], "requests.get"); auto resp = cached_get(ip, url, hdrs); return Value(resp); }
+// requests.post(url, data, headers?)
+static Value builtin_requests_post(Interpreter& ip, const std::vector<Value>& args){ if(args.size()<1||args.size()>3) throw RuntimeError("requests.post expects (url[, data[, headers]])"); std::string url = args[0].str(); std::string body; std::unordered_map<std::string,std::string> hdrs; if(args.size()>=2){ if(auto s=args[1].asString()) body=*s; else throw RuntimeError("requests.post data must be string"); } if(args.size()==3){ auto d = args[2].asDict(); if(!d) throw RuntimeError("requests.post headers must be dict"); for(const auto& kv : *d){ if(kv.second.isString()) hdrs[kv.first] = kv.second.str(); }
+    }
+auto resp = http_request(ip, "POST", url, body, hdrs); return Value(resp); }
+// requests.request(method, url[, data[, headers]])
+static Value builtin_requests_request(Interpreter& ip, const std::vector<Value>& args){ if(args.size()<2||args.size()>4) throw RuntimeError("requests.request expects (method, url[, data[, headers]])"); std::string method = args[0].str(); std::string url = args[1].str(); std::string body; std::unordered_map<std::string,std::string> hdrs; if(args.size()>=3){ if(auto s=args[2].asString()) body=*s; else throw RuntimeError("requests.request data must be string"); } if(args.size()==4){ auto d = args[3].asDict(); if(!d) throw RuntimeError("requests.request headers must be dict"); for(const auto& kv : *d){ if(kv.second.isString()) hdrs[kv.first] = kv.second.str(); } }
+auto resp = method == "GET" && body.empty()? cached_get(ip, url, hdrs) : http_request(ip, method, url, body, hdrs); return Value(resp); }
+static bool isCallable(const Value& v){ return std::holds_alternative<Ref<Function>>(v.data) || std::holds_alternative<Ref<NativeFunction>>(v.data); }
+// Sink that hands each chunk to a script function as a string; the function returns false to stop the transfer
+static HttpSink scriptSink(Interpreter& ip, const Value& fn){ return [&ip, fn](const char* p, size_t n){ Value r = ip.callValue(fn, {Value(std::string(p, n))}); auto b = std::get_if<bool>(&r.data); return !b || *b; }; }
+// Downloads into `path` through a ".part" file that is renamed into place on success (any status below 400)
+static Dict downloadTo(Interpreter& ip, const std::string& url, const std::string& path, const std::unordered_map<std::string, std::string>& hdrs, const char* who){
+    std::string part = path + ".part";
+    std::unique_ptr<FILE, int(*)(FILE*)> f(fopen(part.c_str(), "wb"), fclose);
+    if(!f) throw RuntimeError(std::string(who)+": cannot open file");
+    HttpSink sink = [&](const char* p, size_t n){ if(fwrite(p, 1, n, f.get()) != n) throw RuntimeError(std::string(who)+": write failed"); return true; };
+    Dict resp; std::error_code ec;
+    try { resp = http_request(ip, "GET", url, std::string(), hdrs, &sink); } catch(...) { f.reset(); std::filesystem::remove(part, ec); throw; }
+    bool flushed = fclose(f.release()) == 0;
+    double status = std::get<double>(resp["status"].data);
+    if(!flushed){ std::filesystem::remove(part, ec); throw RuntimeError(std::string(who)+": write failed"); }
+    if(status >= 400){ std::filesystem::remove(part, ec); return resp; }
+    std::filesystem::rename(part, path, ec); if(ec){ std::filesystem::remove(part, ec); throw RuntimeError(std::string(who)+": cannot move download into place"); }
+    resp["path"] = Value(path); return resp; }
+// requests.stream(url, on_chunk[, headers]): GET that passes the body to on_chunk(chunk) piece by piece; returns { status, bytes }
+static Value builtin_requests_stream(Interpreter& ip, const std::vector<Value>& args){ if(args.size()<2||args.size()>3) throw RuntimeError("requests.stream expects (url, on_chunk[, headers])");
+    if(!isCallable(args[1])) throw RuntimeError("requests.stream on_chunk must be a function");
+    HttpSink sink = scriptSink(ip, args[1]);
+    return Value(http_request(ip, "GET", args[0].str(), std::string(), args.size()==3? headersArg(args[2], "requests.stream") : std::unordered_map<std::string, std::string>{}, &sink)); }
+// requests.download(url, path[, headers]): GET written straight to a file with bounded memory; returns { status, bytes, path }
+static Value builtin_requests_download(Interpreter& ip, const std::vector<Value>& args){ if(args.size()<2||args.size()>3) throw RuntimeError("requests.download expects (url, path[, headers])");
+    if(!args[1].isString()) throw RuntimeError("requests.download path must be string");
+    return Value(downloadTo(ip, args[0].str(), args[1].str(), args.size()==3? headersArg(args[2], "requests.download") : std::unordered_map<std::string, std::string>{}, "requests.download")); }
+// requests.conditional(response): If-None-Match / If-Modified-Since headers from an earlier response's ETag and
+// Last-Modified, for a request that comes back 304 (not_modified) when nothing changed
+static Value builtin_requests_conditional(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("requests.conditional expects (response)");
+    auto resp = args[0].asDict(); if(!resp) throw RuntimeError("requests.conditional response must be dict");
+    Dict out; auto it = resp->find("headers"); if(it==resp->end()) return Value(out);
+    auto headers = it->second.asDict(); if(!headers) return Value(out);
+    for(const auto& kv: *headers){ if(!kv.second.isString()) continue;
+        if(headerNameIs(kv.first, "ETag")) out["If-None-Match"] = kv.second;
+        else if(headerNameIs(kv.first, "Last-Modified")) out["If-Modified-Since"] = kv.second; }
+    return Value(out); }
+// requests.cache([options | bool]): turns the response cache on or off and configures it; returns the settings.
+// Options: dir (entry files; "" keeps the cache in memory only), memory_limit and disk_limit (bytes). The default
+// directory is per user; when it is not private to this user the cache stays in memory only.
+static void openHttpCache(HttpCache& cache, bool chosen){ if(cache.open()) return;
+    if(chosen) throw RuntimeError("requests.cache: "+cache.dir.string()+" is not a private directory owned by this user");
+    cache.dir.clear(); }
+static Value builtin_requests_cache(Interpreter& ip, const std::vector<Value>& args){ if(args.size()>1) throw RuntimeError("requests.cache expects ([options])"); HttpClient& c = httpClient(ip);
+    if(args.size()==1){
+        if(auto on = std::get_if<bool>(&args[0].data)){ if(!*on) c.cache.reset(); else if(!c.cache){ c.cache = std::make_unique<HttpCache>(); c.cache->dir = userCacheDir("http"); openHttpCache(*c.cache, false); } }
+        else { auto d = args[0].asDict(); if(!d) throw RuntimeError("requests.cache options must be dict or bool");
+            auto next = std::make_unique<HttpCache>(); next->dir = userCacheDir("http"); bool chosen = false;
+            if(c.cache){ next->dir = c.cache->dir; next->memoryLimit = c.cache->memoryLimit; next->diskLimit = c.cache->diskLimit; }
+            for(const auto& kv: *d){ auto n = std::get_if<double>(&kv.second.data);
+                if(kv.first=="dir"){ if(!kv.second.isString()) throw RuntimeError("requests.cache: dir must be string"); next->dir = kv.second.str(); chosen = true; }
+                else if(kv.first=="memory_limit"){ if(!n || *n<0) throw RuntimeError("requests.cache: memory_limit must be a number >= 0"); next->memoryLimit = (size_t)*n; }
+                else if(kv.first=="disk_limit"){ if(!n || *n<0) throw RuntimeError("requests.cache: disk_limit must be a number >= 0"); next->diskLimit = (size_t)*n; }
+                else throw RuntimeError("requests.cache: unknown option "+kv.first); }
+            if(c.cache && c.cache->dir == next->dir){ c.cache->memoryLimit = next->memoryLimit; c.cache->diskLimit = next->diskLimit; c.cache->fitMemory(); if(c.cache->diskBytes > c.cache->diskLimit) c.cache->trimDisk(); }
+            else { openHttpCache(*next, chosen); c.cache = std::move(next); } } }
+    Dict out; out["enabled"] = Value((bool)c.cache);
+    if(c.cache){ out["dir"] = Value(c.cache->dir.string()); out["memory_limit"] = Value((double)c.cache->memoryLimit); out["disk_limit"] = Value((double)c.cache->diskLimit); }
+    return Value(out); }
+// requests.cache_stats(): hit/miss counters and sizes of the response cache
+static Value builtin_requests_cache_stats(Interpreter& ip, const std::vector<Value>& args){ if(!args.empty()) throw RuntimeError("requests.cache_stats expects no args"); HttpClient& c = httpClient(ip);
+    Dict d; HttpCache empty; const HttpCache& k = c.cache? *c.cache : empty;
+    d["hits"] = Value((double)k.hits); d["misses"] = Value((double)k.misses); d["revalidated"] = Value((double)k.revalidated); d["stored"] = Value((double)k.stored); d["evicted"] = Value((double)k.evicted);
+    d["entries"] = Value((double)k.lru.size()); d["memory_bytes"] = Value((double)k.memoryBytes); d["disk_bytes"] = Value((double)k.diskBytes); return Value(d); }
+// requests.cache_clear(): drops every cached response, in memory and on disk
+static Value builtin_requests_cache_clear(Interpreter& ip, const std::vector<Value>& args){ if(!args.empty()) throw RuntimeError("requests.cache_clear expects no args"); HttpClient& c = httpClient(ip); if(c.cache) c.cache->clear(); return Value(true); }
+// requests.configure([options]): pool_size (idle handles and open connections kept), idle_timeout (seconds); returns the settings
+static Value builtin_requests_configure(Interpreter& ip, const std::vector<Value>& args){ if(args.size()>1) throw RuntimeError("requests.configure expects ([options])"); HttpClient& c = httpClient(ip);
+    if(args.size()==1){ auto d = args[0].asDict(); if(!d) throw RuntimeError("requests.configure options must be dict");
+        for(const auto& kv: *d){ auto n = std::get_if<double>(&kv.second.data);
+            if(kv.first=="pool_size"){ if(!n || *n<1) throw RuntimeError("requests.configure: pool_size must be a number >= 1"); c.poolSize = (size_t)*n; c.trim(); }
+            else if(kv.first=="idle_timeout"){ if(!n || *n<0) throw RuntimeError("requests.configure: idle_timeout must be a number >= 0"); c.idleTimeout = (long)*n; }
+            else throw RuntimeError("requests.configure: unknown option "+kv.first); } }
+    Dict d; d["pool_size"] = Value((double)c.poolSize); d["idle_timeout"] = Value((double)c.idleTimeout); return Value(d); }
+// requests.stats(): requests made and new connections opened by this interpreter
+static Value builtin_requests_stats(Interpreter& ip, const std::vector<Value>& args){ if(!args.empty()) throw RuntimeError("requests.stats expects no args"); HttpClient& c = httpClient(ip);
+    Dict d; d["requests"] = Value((double)c.requests); d["connections"] = Value((double)c.connects); return Value(d); }
+
+// One entry of requests.batch: a url string, or a dict { url, method?, data?, headers? }
+struct HttpSpec { std::string method = "GET", url, body; std::unordered_map<std::string, std::string> headers; };
+static HttpSpec httpSpec(const Value& v, const char* who){ HttpSpec r;
+    if(v.isString()){ r.url = v.str(); return r; }
+    auto d = v.asDict(); if(!d) throw RuntimeError(std::string(who)+": each request must be a url string or a dict");
+    auto it = d->find("url"); if(it==d->end() || !it->second.isString()) throw RuntimeError(std::string(who)+": request dict needs a string url"); r.url = it->second.str();
+    if((it = d->find("method"))!=d->end()){ if(!it->second.isString()) throw RuntimeError(std::string(who)+": method must be string"); r.method = it->second.str(); }
+    if((it = d->find("data"))!=d->end()){ if(!it->second.isString()) throw RuntimeError(std::string(who)+": data must be string"); r.body = it->second.str(); }
+    if((it = d->find("headers"))!=d->end()){ auto h = it->second.asDict(); if(!h) throw RuntimeError(std::string(who)+": headers must be dict"); for(const auto& kv: *h){ if(kv.second.isString()) r.headers[kv.first] = kv.second.str(); } }
+    return r; }
+
+// Runs the requests with at most `concurrency` in flight and returns the responses in input order. A failed request
+// yields { status: 0, text: "", error } instead of aborting the batch. With libcurl the transfers run on one curl_multi
+// handle on this thread; elsewhere they run one after another.
+static List http_batch(Interpreter& ip, const std::vector<HttpSpec>& specs, size_t concurrency){
+    using clk = std::chrono::steady_clock; const auto t0 = clk::now();
+    auto secondsSince = [](clk::time_point t){ return std::chrono::duration<double>(clk::now() - t).count(); };
+    List out(specs.size());
+    auto failed = [](const std::string& msg){ Dict r; r["status"] = Value((double)0); r["text"] = Value(std::string()); r["error"] = Value(msg); return r; };
+    auto runOne = [&](size_t i){ const auto ts = clk::now(); Dict r;
+        try { r = http_request(ip, specs[i].method, specs[i].url, specs[i].body, specs[i].headers); } catch(const RuntimeError& e){ r = failed(e.what()); }
+        r["started"] = Value(std::chrono::duration<double>(ts - t0).count()); r["elapsed"] = Value(secondsSince(ts)); out[i] = Value(r); };
+#if !defined(_WIN32) && !defined(ADASCRIPT_NO_CURL)
+    HttpClient& client = httpClient(ip);
+    std::unique_ptr<CURLM, CURLMcode(*)(CURLM*)> multi(curl_multi_init(), curl_multi_cleanup);
+    if(!multi) throw RuntimeError("requests.batch: curl multi init failed");
+    curl_multi_setopt(multi.get(), CURLMOPT_MAXCONNECTS, (long)std::max(concurrency, client.poolSize));
+    std::vector<std::unique_ptr<HttpTransfer>> live(specs.size()); std::vector<double> started(specs.size());
+    size_t next = 0, active = 0;
+    auto launch = [&](){ for(; next<specs.size() && active<concurrency; next++){
+        const HttpSpec& s = specs[next];
+        if(s.url.rfind("file://", 0) == 0){ runOne(next); continue; }
+        auto t = std::make_unique<HttpTransfer>(client);
+        if(!t->open(s.method, s.url, s.body, s.headers)){ out[next] = Value(failed("requests.batch: curl init failed")); continue; }
+        curl_easy_setopt(t->h, CURLOPT_PRIVATE, (void*)next);
+        if(curl_multi_add_handle(multi.get(), t->h) != CURLM_OK){ out[next] = Value(failed("requests.batch: cannot add transfer")); continue; }
+        started[next] = secondsSince(t0); live[next] = std::move(t); active++; } };
+    launch();
+    while(active){
+        int running = 0; curl_multi_perform(multi.get(), &running);
+        int queued = 0; while(CURLMsg* msg = curl_multi_info_read(multi.get(), &queued)){
+            if(msg->msg != CURLMSG_DONE) continue;
+            void* tag = nullptr; curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &tag); size_t i = (size_t)tag;
+            std::unique_ptr<HttpTransfer> t = std::move(live[i]); CURLcode rc = msg->data.result;
+            curl_multi_remove_handle(multi.get(), t->h); t->countConnects(); active--;
+            Dict r = rc==CURLE_OK? Dict{} : failed("requests."+specs[i].method+": curl perform failed: "+t->error(rc));
+            if(rc==CURLE_OK) r = t->response();
+            double total = 0; curl_easy_getinfo(t->h, CURLINFO_TOTAL_TIME, &total);
+            r["started"] = Value(started[i]); r["elapsed"] = Value(total); out[i] = Value(r); }
+        launch();
+        if(active && running){
+    #if LIBCURL_VERSION_NUM >= 0x074200
+            curl_multi_poll(multi.get(), nullptr, 0, 1000, nullptr);
+    #else
+            curl_multi_wait(multi.get(), nullptr, 0, 1000, nullptr);
+    #endif
+        }
+    }
+#else
+    (void)concurrency; for(size_t i=0;i<specs.size();i++) runOne(i);
+#endif
+    return out; }
+static size_t batchConcurrency(Interpreter& ip, const std::vector<Value>& args, size_t at, const char* who){ size_t n = httpClient(ip).poolSize;
+    if(args.size()>at){ auto d = args[at].asDict(); if(!d) throw RuntimeError(std::string(who)+" options must be dict");
+        for(const auto& kv: *d){ auto v = std::get_if<double>(&kv.second.data);
+            if(kv.first=="concurrency"){ if(!v || *v<1) throw RuntimeError(std::string(who)+": concurrency must be a number >= 1"); n = (size_t)*v; }
+            else throw RuntimeError(std::string(who)+": unknown option "+kv.first); } }
+    return n; }
+// requests.batch(requests[, {concurrency}]): runs many requests in parallel; each response also carries started/elapsed seconds
+static Value builtin_requests_batch(Interpreter& ip, const std::vector<Value>& args){ if(args.empty()||args.size()>2) throw RuntimeError("requests.batch expects (requests[, options])");
+    auto xs = args[0].asList(); if(!xs) throw RuntimeError("requests.batch requests must be list");
+    std::vector<HttpSpec> specs; specs.reserve(xs->size()); for(const auto& v: *xs) specs.push_back(httpSpec(v, "requests.batch"));
+    return Value(http_batch(ip, specs, batchConcurrency(ip, args, 1, "requests.batch"))); }
+// requests.get_many(urls[, {concurrency}]): requests.batch for a list of GET urls
+static Value builtin_requests_get_many(Interpreter& ip, const std::vector<Value>& args){ if(args.empty()||args.size()>2) throw RuntimeError("requests.get_many expects (urls[, options])");
+    auto xs = args[0].asList(); if(!xs) throw RuntimeError("requests.get_many urls must be list");
+    std::vector<HttpSpec> specs(xs->size()); for(size_t i=0;i<xs->size();i++){ if(!(*xs)[i].isString()) throw RuntimeError("requests.get_many urls must be strings"); specs[i].url = (*xs)[i].str(); }
+    return Value(http_batch(ip, specs, batchConcurrency(ip, args, 1, "requests.get_many"))); }
+
+// Parse a line of input into a list: list_input(prompt[, sep[, type]]) where type in {"auto","int","float","str"}
+static Value builtin_list_input(Interpreter&, const std::vector<Value>& args){ if(args.size()<1||args.size()>3) throw RuntimeError("list_input expects (prompt[, sep[, type]])"); if(!args[0].isString()) throw RuntimeError("list_input prompt must be string"); std::string prompt = args[0].str(); std::string sep; std::string typ = "auto"; if(args.size()>=2){ if(!args[1].isString()) throw RuntimeError("list_input sep must be string"); sep = args[1].str();} if(args.size()==3){ if(!args[2].isString()) throw RuntimeError("list_input type must be string"); typ = args[2].str();} writeConsole(std::cout, prompt); std::string line; std::getline(std::cin, line); // auto sep if empty
+    if(sep.empty()){ if(line.find(',')!=std::string::npos) sep = ","; else sep = ""; }
+    List out;
+    auto trim = [](std::string s){ size_t i=0; while(i<s.size() && std::isspace((unsigned char)s[i])) i++; size_t j=s.size(); while(j>i && std::isspace((unsigned char)s[j-1])) j--; return s.substr(i,j-i); };
+    auto castVal = [&](const std::string& s)->Value{
+        if(typ=="str") return Value(s);
+        if(typ=="int") { try{ return Value((double)std::stoll(s)); } catch(...) { throw RuntimeError("list_input: invalid int"); } }
+        if(typ=="float") { try{ return Value(std::stod(s)); } catch(...) { throw RuntimeError("list_input: invalid float"); } }
+        // auto
+        try{ size_t pos=0; double v = std::stod(s, &pos); if(pos==s.size()) return Value(v); } catch(...){}
+        return Value(s);
+    };
+    if(sep.empty()){
+        std::istringstream iss(line); std::string tok; while(iss>>tok){ tok = trim(tok); out.push_back(castVal(tok)); }
+    } else {
+        size_t pos=0; while(true){ size_t n=line.find(sep, pos); if(n==std::string::npos){ std::string tok = trim(line.substr(pos)); if(!tok.empty()) out.push_back(castVal(tok)); break; } std::string tok = trim(line.substr(pos, n-pos)); if(!tok.empty()) out.push_back(castVal(tok)); pos = n + sep.size(); }
+    }
+    return Value(out);
+}
+
+// Filesystem builtins
+static Value builtin_fs_read_text(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("fs.read_text expects (path)"); std::string p = args[0].str(); std::ifstream in(p, std::ios::binary); if(!in) throw RuntimeError("fs.read_text: cannot open file"); return Value(readAll(in)); }
+static Value builtin_fs_write_text(Interpreter&, const std::vector<Value>& args){ if(args.size()!=2) throw RuntimeError("fs.write_text expects (path, text)"); std::string p = args[0].str(); std::string t = args[1].str(); std::ofstream out(p, std::ios::binary); if(!out) throw RuntimeError("fs.write_text: cannot open file"); out<<t; return Value(true); }
+static Value builtin_fs_exists(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("fs.exists expects (path)"); std::string p = args[0].str(); return Value((bool)std::filesystem::exists(p)); }
+static Value builtin_fs_listdir(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("fs.listdir expects (path)"); std::string p = args[0].str(); List out; for(auto& de: std::filesystem::directory_iterator(p)){ out.push_back(Value(de.path().filename().string())); } return Value(out); }
+static Value builtin_fs_mkdirs(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("fs.mkdirs expects (path)"); std::string p = args[0].str(); std::filesystem::create_directories(p); return Value(true); }
+static Value builtin_fs_remove(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("fs.remove expects (path)"); std::string p = args[0].str(); uintmax_t n=0; std::error_code ec; if(std::filesystem::is_directory(p, ec)) n = std::filesystem::remove_all(p, ec); else { bool ok = std::filesystem::remove(p, ec); n = ok?1:0; } if(ec) throw RuntimeError("fs.remove failed"); return Value((double)n); }
+
+// Content.get: http(s) via WinHTTP; file:// or local path via filesystem
+// Options stream instead of buffering: { on_chunk: fn } passes the content to fn piece by piece, { path: p } saves it
+// to a file; the result then has `bytes` in place of `text`.
+static Value builtin_content_get(Interpreter& ip, const std::vector<Value>& args){ if(args.empty()||args.size()>2) throw RuntimeError("content.get expects (source[, options])"); std::string src = args[0].str(); Dict resp; resp["source"] = Value(src);
+    Value onChunk; std::string dest;
+    if(args.size()==2){ auto d = args[1].asDict(); if(!d) throw RuntimeError("content.get options must be dict");
+        for(const auto& kv: *d){
+            if(kv.first=="on_chunk"){ if(!isCallable(kv.second)) throw RuntimeError("content.get: on_chunk must be a function"); onChunk = kv.second; }
+            else if(kv.first=="path"){ if(!kv.second.isString()) throw RuntimeError("content.get: path must be string"); dest = kv.second.str(); }
+            else throw RuntimeError("content.get: unknown option "+kv.first); }
+        if(!onChunk.isNull() && !dest.empty()) throw RuntimeError("content.get: use either on_chunk or path"); }
+    std::optional<HttpSink> sink; if(!onChunk.isNull()) sink = scriptSink(ip, onChunk);
+    auto starts_with = [](const std::string& s, const char* p){ return s.rfind(p,0)==0; };
+    try{
+        if(starts_with(src, "http://") || starts_with(src, "https://") || starts_with(src, "file://")){
+            Dict r = !dest.empty()? downloadTo(ip, src, dest, {}, "content.get") : sink? http_request(ip, "GET", src, std::string(), {}, &*sink) : cached_get(ip, src, {});
+            resp["ok"] = Value(true); resp["status"] = r["status"]; resp["type"] = Value(starts_with(src, "file://")? std::string("file"): std::string("http"));
+            if(r.count("cached")) resp["cached"] = Value(true);
+            if(r.count("text")) resp["text"] = std::move(r["text"]); else resp["bytes"] = r["bytes"];
+            return Value(resp);
+        }
+        // local path fallback
+        if(std::filesystem::exists(src)){
+            if(!dest.empty()){ std::filesystem::path from = std::filesystem::absolute(src); Dict r = downloadTo(ip, "file://"+from.string(), dest, {}, "content.get"); resp["ok"] = Value(true); resp["status"] = r["status"]; resp["bytes"] = r["bytes"]; resp["type"] = Value(std::string("file")); return Value(resp); }
+            std::ifstream in(src, std::ios::binary); if(!in) throw RuntimeError("content.get: cannot open file"); resp["ok"] = Value(true); resp["status"] = Value((double)200); resp["type"] = Value(std::string("file"));
+            if(sink){ resp["bytes"] = Value((double)sinkStream(in, *sink)); return Value(resp); }
+            resp["text"] = Value(readAll(in)); return Value(resp);
+        }
+        resp["ok"] = Value(false); resp["status"] = Value((double)404); resp["error"] = Value(std::string("not found")); return Value(resp);
+    } catch(const RuntimeError& e){ resp["ok"] = Value(false); resp["status"] = Value((double)500); resp["error"] = Value(std::string(e.what())); return Value(resp); }
+}
+
+// C execution: compile and run C code with gcc (MinGW) on Windows
+static Value builtin_c_run(Interpreter&, const std::vector<Value>& args){
+    if(args.size()<1 || args.size()>2) throw RuntimeError("c.run expects (code[, args_list])");
+    if(!args[0].isString()) throw RuntimeError("c.run code must be string");
+    std::string code = args[0].str();
+    std::vector<std::string> runArgs;
+    if(args.size()==2){
+        auto lst = args[1].asList();
+        if(!lst) throw RuntimeError("c.run args must be list of strings");
+        for(const auto& v: *lst){ if(!v.isString()) throw RuntimeError("c.run args must be strings"); runArgs.push_back(v.str()); }
+    }
+    // Write temp file
+    auto tmpdir = std::filesystem::temp_directory_path();
+#ifdef _WIN32
+    std::string base = (tmpdir / std::filesystem::path("adascript_c_" + std::to_string(::GetCurrentProcessId()) + "_" + std::to_string(::GetTickCount64()))).string();
+    std::string exefile = base + ".exe";
+#else
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    long long ticks = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+    std::string base = (tmpdir / std::filesystem::path("adascript_c_" + std::to_string((long long)getpid()) + "_" + std::to_string(ticks))).string();
+    std::string exefile = base; // no extension needed on Linux
+#endif
+    std::string cfile = base + ".c";
+    {
+        std::ofstream out(cfile, std::ios::binary);
+        if(!out) throw RuntimeError("c.run: cannot create temp .c file");
+        out<<code;
+    }
+    // Compile with gcc
+    std::ostringstream cc;
+    cc<<"gcc \""<<cfile<<"\" -O2 -s -o \""<<exefile<<"\"";
+    int rc_compile = std::system(cc.str().c_str());
+    Dict result; result["exe"] = Value(exefile); result["compile_status"] = Value((double)rc_compile);
+    if(rc_compile!=0){ result["ok"] = Value(false); return Value(result); }
+    // Run the exe; allow it to print to console directly
+    std::ostringstream runCmd;
+    runCmd<<'"'<<exefile<<'"';
+    for(const auto& a: runArgs){ runCmd<<" \""<<a<<"\""; }
+    int rc_run = std::system(runCmd.str().c_str());
+    result["run_status"] = Value((double)rc_run); result["ok"] = Value(true);
+    return Value(result);
+}
+
+// server.serve: an epoll loop on the calling thread owns every socket, parses requests (keep-alive and pipelined)
+// and writes responses, static files through sendfile. A fixed pool of workers runs the script handler; the
+// interpreter is not thread-safe, so handler calls are serialized under one lock and everything else overlaps.
+#if defined(__linux__)
+struct HttpServer {
+    struct Request { uint64_t conn = 0; int error = 0; std::string method, target, version, remote, body; std::vector<std::pair<std::string, std::string>> headers; bool keepAlive = true; };
+    struct Reply { uint64_t conn = 0; std::string data; int fd = -1; off_t offset = 0; size_t length = 0; bool keepAlive = true; };
+    struct Chunk { std::string data; size_t sent = 0; int fd = -1; off_t offset = 0; size_t left = 0; };
+    struct Conn { int fd = -1; uint64_t id = 0; std::string remote, in; std::deque<Request> pending; std::deque<Chunk> out; bool busy = false, closing = false, peerClosed = false, writing = false; };
+
+    Interpreter& ip; Value handler; GcHeap& heap = GcHeap::current(); // the interpreter thread's heap, adopted by workers
+    size_t maxBody = 16u<<20, workerCount = 4; uint64_t maxRequests = 0, served = 0, accepted = 0;
+    int listenFd = -1, ep = -1, wake = -1; std::atomic<bool> stopping{false};
+    std::unordered_map<uint64_t, Conn> conns; uint64_t nextId = 1;
+    std::mutex queueLock; std::condition_variable queueReady; std::deque<Request> queue; bool shutdown = false;
+    std::mutex doneLock; std::vector<Reply> done;
+    std::mutex interpLock; std::vector<std::thread> workers;
+
+    HttpServer(Interpreter& i, Value h): ip(i), handler(std::move(h)) {}
+    ~HttpServer(){ for(auto& kv: conns){ for(auto& c: kv.second.out) if(c.fd>=0) ::close(c.fd); ::close(kv.second.fd); }
+        for(auto& r: done) if(r.fd>=0) ::close(r.fd);
+        if(listenFd>=0){ ::close(listenFd); } if(wake>=0){ ::close(wake); } if(ep>=0) ::close(ep); }
+    void notify(){ uint64_t one = 1; ssize_t n = ::write(wake, &one, sizeof one); (void)n; }
+
+    static const char* reason(int s){ switch(s){ case 200: return "OK"; case 201: return "Created"; case 202: return "Accepted"; case 204: return "No Content";
+        case 301: return "Moved Permanently"; case 302: return "Found"; case 303: return "See Other"; case 304: return "Not Modified"; case 307: return "Temporary Redirect"; case 308: return "Permanent Redirect";
+        case 400: return "Bad Request"; case 401: return "Unauthorized"; case 403: return "Forbidden"; case 404: return "Not Found"; case 405: return "Method Not Allowed"; case 409: return "Conflict";
+        case 413: return "Payload Too Large"; case 429: return "Too Many Requests"; case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error"; case 501: return "Not Implemented"; case 502: return "Bad Gateway"; case 503: return "Service Unavailable"; default: return "Unknown"; } }
+    static const char* mimeOf(const std::string& path){ std::string ext = std::filesystem::path(path).extension().string(); for(auto& ch: ext) ch = (char)std::tolower((unsigned char)ch);
+        static const std::unordered_map<std::string, const char*> types = {{".html","text/html; charset=utf-8"}, {".htm","text/html; charset=utf-8"}, {".css","text/css"}, {".js","text/javascript"}, {".json","application/json"},
+            {".txt","text/plain; charset=utf-8"}, {".csv","text/csv"}, {".xml","application/xml"}, {".svg","image/svg+xml"}, {".png","image/png"}, {".jpg","image/jpeg"}, {".jpeg","image/jpeg"}, {".gif","image/gif"},
+            {".ico","image/x-icon"}, {".wasm","application/wasm"}, {".pdf","application/pdf"}};
+        auto it = types.find(ext); return it==types.end()? "application/octet-stream" : it->second; }
+
+    // Status line and headers; a body of `length` bytes follows unless the status forbids one
+    static std::string head(int status, const std::vector<std::pair<std::string, std::string>>& headers, size_t length, bool keepAlive){
+        char date[64]; std::time_t now = std::time(nullptr); std::tm tm{}; gmtime_r(&now, &tm); std::strftime(date, sizeof date, "%a, %d %b %Y %H:%M:%S GMT", &tm);
+        std::string h = "HTTP/1.1 " + std::to_string(status) + " " + reason(status) + "\r\nServer: AdaScript/2.0\r\nDate: " + date + "\r\n";
+        if(status >= 200 && status != 204 && status != 304) h += "Content-Length: " + std::to_string(length) + "\r\n";
+        h += keepAlive? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+        for(const auto& [k, v]: headers){ h += k; h += ": "; h += v; h += "\r\n"; }
+        h += "\r\n"; return h; }
+    static Reply plain(uint64_t conn, int status, const std::string& text, bool keepAlive){ Reply r; r.conn = conn; r.keepAlive = keepAlive;
+        r.data = head(status, {{"Content-Type", "text/plain; charset=utf-8"}}, text.size(), keepAlive) + text; return r; }
+
+    // Worker side: the handler sees { method, path, query, version, headers, body, remote } and returns a string,
+    // null (204) or a dict { status?, headers?, body? | file? }
+    Reply handle(Request& q){
+        int status = 200; std::vector<std::pair<std::string, std::string>> headers; std::string body, file; bool typed = false;
+        {   std::lock_guard<std::mutex> hold(interpLock); GcHeapScope adopt(heap);
+            try {
+                Dict req; size_t qm = q.target.find('?');
+                req["method"] = Value(q.method); req["path"] = Value(q.target.substr(0, qm)); req["query"] = Value(qm==std::string::npos? std::string() : q.target.substr(qm+1));
+                req["version"] = Value(q.version); req["body"] = Value(std::move(q.body)); req["remote"] = Value(q.remote);
+                Dict hs; for(auto& [k, v]: q.headers) addHeaderLine(hs, (k + ": " + v).c_str(), k.size() + 2 + v.size()); req["headers"] = Value(std::move(hs));
+                Value out = ip.callValue(handler, {Value(std::move(req))});
+                if(out.isNull()) status = 204;
+                else if(auto d = out.asDict()){
+                    auto it = d->find("status"); if(it!=d->end()){ auto n = std::get_if<double>(&it->second.data); if(!n || *n<100 || *n>999) throw RuntimeError("server.serve: response status must be a number 100..999"); status = (int)*n; }
+                    if((it = d->find("headers"))!=d->end()){ auto h = it->second.asDict(); if(!h) throw RuntimeError("server.serve: response headers must be dict");
+                        for(const auto& kv: *h){ if(headerNameIs(kv.first, "Content-Length") || headerNameIs(kv.first, "Connection")) continue; if(headerNameIs(kv.first, "Content-Type")) typed = true; headers.emplace_back(kv.first, strOf(kv.second)); } }
+                    if((it = d->find("file"))!=d->end()){ if(!it->second.isString()) throw RuntimeError("server.serve: response file must be string"); file = it->second.str(); }
+                    else if((it = d->find("body"))!=d->end()) body = strOf(it->second);
+                } else body = strOf(out);
+            } catch(const std::exception& e){ writeConsole(std::cerr, std::string("server.serve: handler failed: ") + e.what() + "\n"); return plain(q.conn, 500, "Internal Server Error\n", q.keepAlive); }
+            catch(...){ writeConsole(std::cerr, "server.serve: handler failed\n"); return plain(q.conn, 500, "Internal Server Error\n", q.keepAlive); }
+        }
+        Reply r; r.conn = q.conn; r.keepAlive = q.keepAlive;
+        if(!file.empty()){
+            int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC); struct stat st{};
+            if(fd < 0 || ::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)){ if(fd>=0) ::close(fd); return plain(q.conn, 404, "Not Found\n", q.keepAlive); }
+            if(!typed) headers.emplace_back("Content-Type", mimeOf(file));
+            r.data = head(status, headers, (size_t)st.st_size, q.keepAlive);
+            if(q.method == "HEAD" || status < 200 || status == 204 || status == 304) ::close(fd); else { r.fd = fd; r.length = (size_t)st.st_size; }
+            return r; }
+        if(!typed && status != 204 && status != 304) headers.emplace_back("Content-Type", "text/plain; charset=utf-8");
+        r.data = head(status, headers, body.size(), q.keepAlive);
+        if(q.method != "HEAD" && status >= 200 && status != 204 && status != 304) r.data += body;
+        return r; }
+    void work(){ for(;;){ Request q;
+            { std::unique_lock<std::mutex> l(queueLock); queueReady.wait(l, [&]{ return shutdown || !queue.empty(); }); if(queue.empty()) return; q = std::move(queue.front()); queue.pop_front(); }
+            Reply r = handle(q);
+            { std::lock_guard<std::mutex> l(doneLock); done.push_back(std::move(r)); }
+            notify(); } }
+
+    // Loop side
+    // Interest set: input until the peer has closed its side, output while replies are waiting on a full socket
+    void arm(Conn& c, bool out){ c.writing = out; epoll_event ev{}; ev.events = (c.peerClosed? 0u : (uint32_t)(EPOLLIN | EPOLLRDHUP)) | (out? (uint32_t)EPOLLOUT : 0u); ev.data.u64 = c.id; epoll_ctl(ep, EPOLL_CTL_MOD, c.fd, &ev); }
+    void watch(Conn& c, bool out){ if(c.writing != out) arm(c, out); }
+    void drop(uint64_t id){ auto it = conns.find(id); if(it==conns.end()) return; Conn& c = it->second; epoll_ctl(ep, EPOLL_CTL_DEL, c.fd, nullptr); ::close(c.fd); for(auto& ch: c.out) if(ch.fd>=0) ::close(ch.fd); conns.erase(it); }
+    // A write to a closed peer raises SIGPIPE. Buffers go out with MSG_NOSIGNAL; sendfile has no such flag, so the
+    // loop thread blocks SIGPIPE while it serves and takes the one a failed sendfile left pending
+    static void drainSigpipe(){ sigset_t pipe; sigemptyset(&pipe); sigaddset(&pipe, SIGPIPE); timespec zero{0, 0}; while(sigtimedwait(&pipe, nullptr, &zero) == SIGPIPE){} }
+    // Sends queued output (consecutive buffers with one sendmsg); false once the connection is gone
+    bool flush(Conn& c){
+        while(!c.out.empty()){
+            Chunk& f = c.out.front();
+            if(f.sent < f.data.size()){
+                iovec iov[16]; int n = 0; for(auto it = c.out.begin(); it!=c.out.end() && n<16; ++it){ if(it->sent < it->data.size()){ iov[n].iov_base = it->data.data() + it->sent; iov[n].iov_len = it->data.size() - it->sent; n++; } if(it->left) break; }
+                msghdr msg{}; msg.msg_iov = iov; msg.msg_iovlen = (size_t)n; ssize_t w = ::sendmsg(c.fd, &msg, MSG_NOSIGNAL);
+                if(w < 0){ if(errno==EAGAIN || errno==EWOULDBLOCK){ watch(c, true); return true; } if(errno==EINTR) continue; drop(c.id); return false; }
+                for(auto it = c.out.begin(); w > 0 && it!=c.out.end(); ++it){ size_t k = std::min((size_t)w, it->data.size() - it->sent); it->sent += k; w -= (ssize_t)k; }
+            }
+            while(!c.out.empty() && c.out.front().sent == c.out.front().data.size() && c.out.front().left){
+                Chunk& g = c.out.front(); ssize_t w = ::sendfile(c.fd, g.fd, &g.offset, std::min<size_t>(g.left, 1u<<30));
+                if(w < 0){ if(errno==EAGAIN || errno==EWOULDBLOCK){ watch(c, true); return true; } if(errno==EINTR) continue; if(errno==EPIPE) drainSigpipe(); drop(c.id); return false; }
+                if(w == 0){ drop(c.id); return false; } // file shrank underneath us
+                g.left -= (size_t)w; }
+            while(!c.out.empty() && c.out.front().sent == c.out.front().data.size() && !c.out.front().left){ if(c.out.front().fd>=0) ::close(c.out.front().fd); c.out.pop_front(); }
+        }
+        watch(c, false);
+        if(!c.busy && (c.closing || (c.peerClosed && c.pending.empty()))){ drop(c.id); return false; }
+        return true; }
+    bool deliver(Conn& c, Reply&& r){ Chunk ch; ch.data = std::move(r.data); ch.fd = r.fd; ch.offset = r.offset; ch.left = r.length; c.out.push_back(std::move(ch));
+        served++; if(!r.keepAlive) c.closing = true; if(maxRequests && served >= maxRequests) stopping = true;
+        return flush(c); }
+    // Hands the connection's next request to the workers; replies go out in request order, so one is in flight at a time
+    void dispatch(Conn& c){
+        while(!c.busy && !c.closing && !c.pending.empty() && !stopping){
+            Request q = std::move(c.pending.front()); c.pending.pop_front();
+            if(q.error){ static const char* msg[] = {"Bad Request\n", "Payload Too Large\n", "Request Header Fields Too Large\n", "Not Implemented\n"};
+                int i = q.error==413? 1 : q.error==431? 2 : q.error==501? 3 : 0; uint64_t id = c.id; if(!deliver(c, plain(id, q.error, msg[i], false))) return; continue; }
+            c.busy = true;
+            { std::lock_guard<std::mutex> l(queueLock); queue.push_back(std::move(q)); }
+            queueReady.notify_one(); } }
+    // Cuts complete requests off the front of the input buffer; a protocol error queues an error reply and stops reading
+    static constexpr size_t kMaxHeader = 64*1024; // request line and headers
+    void parse(Conn& c){
+        size_t at = 0;
+        while(!c.closing){
+            size_t end = c.in.find("\r\n\r\n", at);
+            auto fail = [&](int code){ Request q; q.conn = c.id; q.error = code; q.keepAlive = false; c.pending.push_back(std::move(q)); c.in.clear(); at = 0; c.peerClosed = true; };
+            // the header block is limited whether it is still arriving or came complete in one read
+            if(end == std::string::npos){ if(c.in.size() - at > kMaxHeader) fail(431); break; }
+            if(end - at > kMaxHeader){ fail(431); break; }
+            Request q; q.conn = c.id; q.remote = c.remote;
+            size_t eol = c.in.find("\r\n", at); std::string line = c.in.substr(at, eol - at);
+            size_t s1 = line.find(' '), s2 = line.rfind(' ');
+            if(s1==std::string::npos || s2==s1){ fail(400); break; }
+            q.method = line.substr(0, s1); q.target = line.substr(s1+1, s2-s1-1); q.version = line.substr(s2+1);
+            if(q.version.rfind("HTTP/1.", 0) != 0 || q.target.empty()){ fail(400); break; }
+            q.keepAlive = q.version != "HTTP/1.0";
+            size_t length = 0; bool bad = false, chunked = false;
+            for(size_t p = eol + 2; p < end; ){ size_t e = c.in.find("\r\n", p); if(e > end) e = end;
+                size_t colon = c.in.find(':', p); if(colon == std::string::npos || colon >= e){ bad = true; break; }
+                std::string k = c.in.substr(p, colon - p); size_t vs = c.in.find_first_not_of(" \t", colon+1); std::string v = vs < e? c.in.substr(vs, e - vs) : std::string();
+                while(!v.empty() && (v.back()==' ' || v.back()=='\t')) v.pop_back();
+                if(headerNameIs(k, "Content-Length")){ // digits only: strtoull alone would take "-1" as a huge length
+                    if(v.empty() || v.find_first_not_of("0123456789") != std::string::npos){ bad = true; break; } length = (size_t)std::strtoull(v.c_str(), nullptr, 10); }
+                else if(headerNameIs(k, "Transfer-Encoding")) chunked = true;
+                else if(headerNameIs(k, "Connection")){ std::string lv = v; for(auto& ch: lv) ch = (char)std::tolower((unsigned char)ch);
+                    if(lv.find("close") != std::string::npos) q.keepAlive = false; else if(lv.find("keep-alive") != std::string::npos) q.keepAlive = true; }
+                q.headers.emplace_back(std::move(k), std::move(v)); p = e + 2; }
+            if(bad){ fail(400); break; }
+            if(chunked){ fail(501); break; }
+            if(length > maxBody){ fail(413); break; }
+            if(c.in.size() - (end + 4) < length) break; // body not complete yet
+            q.body = c.in.substr(end + 4, length); at = end + 4 + length;
+            bool last = !q.keepAlive; c.pending.push_back(std::move(q));
+            if(last){ c.peerClosed = true; at = c.in.size(); break; } // nothing after a closing request is served
+        }
+        if(at) c.in.erase(0, at); }
+    void readable(Conn& c){
+        char buf[64*1024];
+        for(;;){ ssize_t n = ::recv(c.fd, buf, sizeof buf, 0);
+            if(n > 0){ if(!c.peerClosed) c.in.append(buf, (size_t)n); continue; }
+            if(n == 0){ c.peerClosed = true; arm(c, c.writing); break; }
+            if(errno==EINTR){ continue; } if(errno==EAGAIN || errno==EWOULDBLOCK) break;
+            drop(c.id); return; }
+        parse(c); uint64_t id = c.id; dispatch(c);
+        auto it = conns.find(id); if(it!=conns.end() && !it->second.busy && it->second.out.empty() && it->second.peerClosed && it->second.pending.empty()) drop(id); }
+    void acceptAll(){
+        for(;;){ sockaddr_in addr{}; socklen_t len = sizeof addr;
+            int fd = ::accept4(listenFd, (sockaddr*)&addr, &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if(fd < 0){ if(errno==EINTR) continue; return; }
+            int one = 1; setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+            char ipbuf[INET_ADDRSTRLEN] = {0}; inet_ntop(AF_INET, &addr.sin_addr, ipbuf, sizeof ipbuf);
+            Conn c; c.fd = fd; c.id = nextId++; c.remote = std::string(ipbuf) + ":" + std::to_string(ntohs(addr.sin_port));
+            epoll_event ev{}; ev.events = EPOLLIN | EPOLLRDHUP; ev.data.u64 = c.id;
+            if(epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) != 0){ ::close(fd); continue; }
+            accepted++; conns.emplace(c.id, std::move(c)); } }
+    void completed(){
+        uint64_t count; ssize_t n = ::read(wake, &count, sizeof count); (void)n;
+        std::vector<Reply> ready; { std::lock_guard<std::mutex> l(doneLock); ready.swap(done); }
+        for(auto& r: ready){ auto it = conns.find(r.conn);
+            if(it == conns.end()){ if(r.fd>=0) ::close(r.fd); continue; }
+            Conn& c = it->second; c.busy = false; uint64_t id = c.id;
+            if(deliver(c, std::move(r)) && conns.count(id)) dispatch(conns.at(id)); } }
+
+    void listen(const std::string& host, int port){
+        listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0); if(listenFd < 0) throw RuntimeError("server.serve: socket failed");
+        int one = 1; setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+        sockaddr_in addr{}; addr.sin_family = AF_INET; addr.sin_port = htons((uint16_t)port);
+        if(inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) throw RuntimeError("server.serve: host must be an IPv4 address");
+        if(::bind(listenFd, (sockaddr*)&addr, sizeof addr) != 0) throw RuntimeError("server.serve: cannot bind "+host+":"+std::to_string(port)+": "+std::strerror(errno));
+        if(::listen(listenFd, SOMAXCONN) != 0) throw RuntimeError("server.serve: listen failed");
+        ep = epoll_create1(EPOLL_CLOEXEC); wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC); if(ep < 0 || wake < 0) throw RuntimeError("server.serve: epoll setup failed");
+        epoll_event ev{}; ev.events = EPOLLIN; ev.data.u64 = 0; epoll_ctl(ep, EPOLL_CTL_ADD, listenFd, &ev); // connection ids start at 1
+        ev.data.u64 = UINT64_MAX; epoll_ctl(ep, EPOLL_CTL_ADD, wake, &ev); }
+    void run(){
+        for(size_t i=0; i<workerCount; i++) workers.emplace_back([this]{ work(); });
+        // SIGPIPE is blocked on this thread only, after the workers start, and restored when serving ends
+        struct BlockSigpipe { sigset_t saved;
+            BlockSigpipe(){ sigset_t pipe; sigemptyset(&pipe); sigaddset(&pipe, SIGPIPE); pthread_sigmask(SIG_BLOCK, &pipe, &saved); }
+            ~BlockSigpipe(){ pthread_sigmask(SIG_SETMASK, &saved, nullptr); } } block;
+        epoll_event evs[256];
+        for(;;){
+            if(stopping){ if(listenFd>=0){ epoll_ctl(ep, EPOLL_CTL_DEL, listenFd, nullptr); ::close(listenFd); listenFd = -1; }
+                bool idle = true; for(auto& kv: conns) if(kv.second.busy || !kv.second.out.empty()){ idle = false; break; }
+                if(idle) break; }
+            int n = epoll_wait(ep, evs, 256, 1000);
+            if(n < 0){ if(errno==EINTR) continue; break; }
+            for(int i=0; i<n; i++){ uint64_t id = evs[i].data.u64;
+                if(id == 0){ if(listenFd>=0) acceptAll(); continue; }
+                if(id == UINT64_MAX){ completed(); continue; }
+                auto it = conns.find(id); if(it==conns.end()) continue;
+                if(evs[i].events & (EPOLLHUP | EPOLLERR)){ drop(id); continue; } // reset, or closed both ways
+                if(evs[i].events & (EPOLLIN | EPOLLRDHUP)){ readable(it->second); it = conns.find(id); if(it==conns.end()) continue; }
+                if(evs[i].events & EPOLLOUT) flush(it->second); } }
+        { std::lock_guard<std::mutex> l(queueLock); shutdown = true; queue.clear(); }
+        queueReady.notify_all(); for(auto& t: workers) t.join(); }
+};
+#endif
+
+// server.serve(port, handler[, options]): blocks serving HTTP/1.1 until server.stop() or max_requests; returns
+// { requests, connections }. Options: host (default "127.0.0.1"), workers (default 4), max_requests, max_body (bytes).
+static Value builtin_server_serve(Interpreter& ip, const std::vector<Value>& args){
+    if(args.size()<2 || args.size()>3) throw RuntimeError("server.serve expects (port, handler[, options])");
+    auto port = std::get_if<double>(&args[0].data); if(!port || *port<0 || *port>65535) throw RuntimeError("server.serve: port must be a number 0..65535");
+    if(!isCallable(args[1])) throw RuntimeError("server.serve: handler must be a function");
+#if defined(__linux__)
+    if(ip.server) throw RuntimeError("server.serve: already serving");
+    auto srv = std::make_unique<HttpServer>(ip, args[1]); std::string host = "127.0.0.1";
+    if(args.size()==3){ auto d = args[2].asDict(); if(!d) throw RuntimeError("server.serve options must be dict");
+        for(const auto& kv: *d){ auto n = std::get_if<double>(&kv.second.data);
+            if(kv.first=="host"){ if(!kv.second.isString()) throw RuntimeError("server.serve: host must be string"); host = kv.second.str(); }
+            else if(kv.first=="workers"){ if(!n || *n<1) throw RuntimeError("server.serve: workers must be a number >= 1"); srv->workerCount = (size_t)*n; }
+            else if(kv.first=="max_requests"){ if(!n || *n<0) throw RuntimeError("server.serve: max_requests must be a number >= 0"); srv->maxRequests = (uint64_t)*n; }
+            else if(kv.first=="max_body"){ if(!n || *n<0) throw RuntimeError("server.serve: max_body must be a number >= 0"); srv->maxBody = (size_t)*n; }
+            else throw RuntimeError("server.serve: unknown option "+kv.first); } }
+    srv->listen(host, (int)*port);
+    ip.server = srv.get(); srv->run(); ip.server = nullptr;
+    Dict out; out["requests"] = Value((double)srv->served); out["connections"] = Value((double)srv->accepted); return Value(out);
+#else
+    (void)ip; throw RuntimeError("server.serve: not supported on this platform");
+#endif
+}
+// server.stop(): ends the running server.serve once in-flight responses are written; callable from a handler
+static Value builtin_server_stop(Interpreter& ip, const std::vector<Value>& args){ if(!args.empty()) throw RuntimeError("server.stop expects no args");
+#if defined(__linux__)
+    if(!ip.server){ return Value(false); } ip.server->stopping = true; ip.server->notify(); return Value(true);
+#else
+    (void)ip; return Value(false);
+#endif
+}
+
+// Native module loader: native.load(path_to_dll_or_so) -> true
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <dlfcn.h>
+#endif
+static Value builtin_native_load(Interpreter& ip, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("native.load expects (path)"); if(!args[0].isString()) throw RuntimeError("native.load path must be string"); std::string path = args[0].str();
+    // Bridge: plugin functions take and return C strings
+    struct Thunk { static Value wrap(AdaScript_NativeStringFn f, void* u, Interpreter&, const std::vector<Value>& a){ std::vector<std::string> ss; ss.reserve(a.size()); for(auto& v: a){ std::ostringstream oss; if(auto s=v.asString()) oss<<*s; else if(auto n=std::get_if<double>(&v.data)) oss<<*n; else if(auto b=std::get_if<bool>(&v.data)) oss<<(*b?"true":"false"); else if(std::holds_alternative<std::monostate>(v.data)) oss<<"null"; else oss<<"<"<<v.typeName()<<">"; ss.push_back(oss.str()); }
+            std::vector<const char*> cargs; cargs.reserve(ss.size()); for(auto& s: ss) cargs.push_back(s.c_str()); char* out = f(u, cargs.data(), (int)cargs.size()); std::string res = out? std::string(out) : std::string(""); if(out) std::free(out); return Value(res); } };
+    // AdaScript_RegisterFn carries no context, so the interpreter being extended is kept in a thread_local while init
+    // runs; loads on other threads (other VMs) each see their own
+    struct Registering { Interpreter* saved; static Interpreter*& target(){ thread_local Interpreter* ip = nullptr; return ip; }
+        explicit Registering(Interpreter& ip): saved(target()) { target() = &ip; } ~Registering(){ target() = saved; } };
+#ifdef _WIN32
+    HMODULE h = LoadLibraryA(path.c_str()); if(!h) throw RuntimeError("native.load: failed to load library");
+    auto init = (AdaScript_ModuleInitFn)GetProcAddress(h, "AdaScript_ModuleInit"); if(!init){ FreeLibrary(h); throw RuntimeError("native.load: AdaScript_ModuleInit not found"); }
+#else
+    void* h = dlopen(path.c_str(), RTLD_NOW); if(!h) throw RuntimeError(std::string("native.load: ")+ dlerror());
+    auto init = (AdaScript_ModuleInitFn)dlsym(h, "AdaScript_ModuleInit"); if(!init){ dlclose(h); throw RuntimeError("native.load: AdaScript_ModuleInit not found"); }
+#endif
+    auto reg_fn = +[](const char* name, int arity, AdaScript_NativeStringFn fn, void* user){ Interpreter* ip = Registering::target(); if(!ip || !name || !fn) return;
+        ip->globals->define(name, Value(makeRef<NativeFunction>(std::string(name), arity, [fn,user](Interpreter& ip2, const std::vector<Value>& a)->Value{ return Thunk::wrap(fn, user, ip2, a); }))); };
+    Registering registering(ip);
+    int rc = init((AdaScript_RegisterFn)reg_fn, (void*)&ip); if(rc!=0) throw RuntimeError("native.load: init returned error");
+    return Value(true);
+}
+
+// Process execution: proc.exec(cmd) -> {status, out}
+static Value builtin_proc_exec(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("proc.exec expects (cmd)"); if(!args[0].isString()) throw RuntimeError("proc.exec cmd must be string"); std::string cmd = args[0].str();
+#ifdef _WIN32
+    std::string full = "cmd /C " + cmd + " 2>&1";
+    FILE* pipe = _popen(full.c_str(), "rt");
+    if(!pipe) throw RuntimeError("proc.exec: failed to start process");
+#else
+    std::string full = cmd + " 2>&1";
+    FILE* pipe = popen(full.c_str(), "r");
+    if(!pipe) throw RuntimeError("proc.exec: failed to start process");
+#endif
+    std::string out; char buf[4096]; while(true){ size_t n = fread(buf, 1, sizeof(buf), pipe); if(n==0) break; out.append(buf, n); }
+#ifdef _WIN32
+    int rc = _pclose(pipe);
+#else
+    int rc = pclose(pipe);
+#endif
+    Dict d; d["status"] = Value((double)rc); d["out"] = Value(out); return Value(d);
+}
+
+// gc namespace: inspect and tune the cycle collector of the current thread
+static Value builtin_gc_collect(Interpreter&, const std::vector<Value>& args){ if(args.size()>1) throw RuntimeError("gc.collect expects ([generation])"); int g = GcHeap::kGenerations-1;
+    if(args.size()==1){ auto n = std::get_if<double>(&args[0].data); if(!n || *n<0 || *n>=GcHeap::kGenerations) throw RuntimeError("gc.collect generation must be 0, 1 or 2"); g = (int)*n; }
+    return Value((double)GcHeap::current().collect(g)); }
+static Value builtin_gc_stats(Interpreter&, const std::vector<Value>& args){ if(!args.empty()) throw RuntimeError("gc.stats expects no args"); const auto& h = GcHeap::current(); Dict d;
+    d["enabled"] = Value(h.enabled); d["tracked"] = Value((double)h.tracked); d["allocated"] = Value((double)h.allocated); d["freed"] = Value((double)h.freed); d["collected"] = Value((double)h.collected);
+    List counts, thresholds, collections; for(const auto& g: h.gens){ counts.push_back(Value((double)g.count)); thresholds.push_back(Value((double)g.threshold)); collections.push_back(Value((double)g.collections)); }
+    d["counts"] = Value(counts); d["thresholds"] = Value(thresholds); d["collections"] = Value(collections); return Value(d); }
+static Value builtin_gc_set_threshold(Interpreter&, const std::vector<Value>& args){ if(args.empty() || args.size()>(size_t)GcHeap::kGenerations) throw RuntimeError("gc.set_threshold expects (t0[, t1[, t2]])"); auto& h = GcHeap::current();
+    for(size_t i=0;i<args.size();++i){ auto n = std::get_if<double>(&args[i].data); if(!n || *n<1) throw RuntimeError("gc.set_threshold thresholds must be numbers >= 1"); h.gens[i].threshold = (int)*n; }
+    return Value(); }
+static Value builtin_gc_enable(Interpreter&, const std::vector<Value>& args){ if(!args.empty()) throw RuntimeError("gc.enable expects no args"); GcHeap::current().enabled = true; return Value(); }
+static Value builtin_gc_disable(Interpreter&, const std::vector<Value>& args){ if(!args.empty()) throw RuntimeError("gc.disable expects no args"); GcHeap::current().enabled = false; return Value(); }
+
+// Native containers. Stack, Queue, Deque and LRUCache keep the method names of the former script versions in
+// builtins/datastructures.ad and builtins/lru_cache.ad.
+template<typename T> static T& receiver(const std::vector<Value>& args){ return static_cast<T&>(*std::get<Ref<NativeObject>>(args[0].data)); }
+static void expectArgs(const std::vector<Value>& args, size_t n, const char* usage){ if(args.size()!=n+1) throw RuntimeError(usage); } // n excludes the receiver
+
+// Growable ring buffer (capacity is a power of two): O(1) push and pop at both ends
+struct RingBuffer { std::vector<Value> buf; size_t head=0, count=0;
+    Value& at(size_t i){ return buf[(head+i) & (buf.size()-1)]; }
+    void grow(){ std::vector<Value> nb(std::max<size_t>(8, buf.size()*2)); for(size_t i=0;i<count;++i) nb[i] = std::move(at(i)); buf.swap(nb); head = 0; }
+    void pushBack(const Value& v){ if(count==buf.size()) grow(); at(count++) = v; }
+    void pushFront(const Value& v){ if(count==buf.size()) grow(); head = (head+buf.size()-1) & (buf.size()-1); buf[head] = v; ++count; }
+    Value popFront(){ if(!count) return Value(); Value v = std::move(buf[head]); buf[head] = Value(); head = (head+1) & (buf.size()-1); --count; return v; }
+    Value popBack(){ if(!count) return Value(); Value& e = at(--count); Value v = std::move(e); e = Value(); return v; }
+    Value front(){ return count? at(0) : Value(); }
+};
+
+struct StackObj : NativeObject { std::vector<Value> items; using NativeObject::NativeObject;
+    void traverse(GcVisit visit, void* ctx) override { for(const auto& v: items) gcTraverse(v, visit, ctx); }
+    void clearRefs() override { std::vector<Value>().swap(items); } };
+
+struct DequeObj : NativeObject { RingBuffer items; using NativeObject::NativeObject; // backs both Queue and Deque
+    void traverse(GcVisit visit, void* ctx) override { for(size_t i=0;i<items.count;++i) gcTraverse(items.at(i), visit, ctx); }
+    void clearRefs() override { items = RingBuffer(); } };
+
+// Hash map of entries threaded on an intrusive recency list: get and put are O(1)
+struct LruObj : NativeObject {
+    struct Entry { Value value; const Value* key=nullptr; Entry* prev=nullptr; Entry* next=nullptr; };
+    struct KeyHash { size_t operator()(const Value& v) const { if(auto s=v.asString()) return std::hash<std::string>()(*s); if(auto n=std::get_if<double>(&v.data)) return std::hash<double>()(*n);
+        return std::visit([](const auto& x)->size_t{ using T = std::decay_t<decltype(x)>; if constexpr (std::is_same_v<T, std::monostate>) return 0; else if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, double>) return (size_t)x; else return std::hash<const void*>()(x.object()); }, v.data); } };
+    struct KeyEq { bool operator()(const Value& a, const Value& b) const { return Interpreter::equal(a, b); } };
+    size_t cap; std::unordered_map<Value, Entry, KeyHash, KeyEq> map; Entry order; // list sentinel: order.next is the most recent entry
+    LruObj(const NativeType& t, size_t c): NativeObject(t), cap(c) { order.prev = order.next = &order; }
+    void unlink(Entry* e){ e->prev->next = e->next; e->next->prev = e->prev; }
+    void touch(Entry* e){ e->next = order.next; e->prev = &order; order.next->prev = e; order.next = e; }
+    Value get(const Value& k){ auto it = map.find(k); if(it==map.end()) return Value(); unlink(&it->second); touch(&it->second); return it->second.value; }
+    void put(const Value& k, const Value& v){ auto it = map.find(k); if(it!=map.end()){ it->second.value = v; unlink(&it->second); touch(&it->second); return; }
+        if(map.size()>=cap){ Entry* lru = order.prev; unlink(lru); Value key = *lru->key; map.erase(key); }
+        auto r = map.emplace(k, Entry{}); Entry& e = r.first->second; e.value = v; e.key = &r.first->first; touch(&e); }
+    void traverse(GcVisit visit, void* ctx) override { for(const auto& kv: map){ gcTraverse(kv.first, visit, ctx); gcTraverse(kv.second.value, visit, ctx); } }
+    void clearRefs() override { map.clear(); order.prev = order.next = &order; } };
+
+// Snapshot copies of the containers (NativeType::clone); an LRU cache is refilled from least to most recent
+static Ref<NativeObject> cloneStack(NativeObject& o, const ValueCopy& copy){ auto c = new StackObj(o.type); Ref<NativeObject> r(c); for(const auto& v: static_cast<StackObj&>(o).items) c->items.push_back(copy(v)); return r; }
+static Ref<NativeObject> cloneDeque(NativeObject& o, const ValueCopy& copy){ auto& src = static_cast<DequeObj&>(o).items; auto c = new DequeObj(o.type); Ref<NativeObject> r(c);
+    for(size_t i=0;i<src.count;++i){ c->items.pushBack(copy(src.at(i))); } return r; }
+static Ref<NativeObject> cloneLru(NativeObject& o, const ValueCopy& copy){ auto& src = static_cast<LruObj&>(o); auto c = new LruObj(o.type, src.cap); Ref<NativeObject> r(c);
+    for(auto e = src.order.prev; e != &src.order; e = e->prev){ c->put(copy(*e->key), copy(e->value)); } return r; }
+
+static const NativeType& stackType(){ static const NativeType t = [](){ NativeType t("Stack"); t.clone = cloneStack;
+        t.add("push", 1, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 1, "Stack.push expects (x)"); receiver<StackObj>(a).items.push_back(a[1]); return Value(); });
+        t.add("pop", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "Stack.pop expects no args"); auto& xs = receiver<StackObj>(a).items; if(xs.empty()) return Value(); Value v = std::move(xs.back()); xs.pop_back(); return v; });
+        t.add("peek", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "Stack.peek expects no args"); auto& xs = receiver<StackObj>(a).items; return xs.empty()? Value() : xs.back(); });
+        t.add("is_empty", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "Stack.is_empty expects no args"); return Value(receiver<StackObj>(a).items.empty()); });
+        t.add("len", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "Stack.len expects no args"); return Value((double)receiver<StackObj>(a).items.size()); });
+        return t; }(); return t; }
+
+static const NativeType& queueType(){ static const NativeType t = [](){ NativeType t("Queue"); t.clone = cloneDeque;
+        t.add("push", 1, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 1, "Queue.push expects (x)"); receiver<DequeObj>(a).items.pushBack(a[1]); return Value(); });
+        t.add("pop", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "Queue.pop expects no args"); return receiver<DequeObj>(a).items.popFront(); });
+        t.add("peek", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "Queue.peek expects no args"); return receiver<DequeObj>(a).items.front(); });
+        t.add("is_empty", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "Queue.is_empty expects no args"); return Value(receiver<DequeObj>(a).items.count==0); });
+        t.add("len", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "Queue.len expects no args"); return Value((double)receiver<DequeObj>(a).items.count); });
+        return t; }(); return t; }
+
+static const NativeType& dequeType(){ static const NativeType t = [](){ NativeType t("Deque"); t.clone = cloneDeque;
+        t.add("push_back", 1, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 1, "Deque.push_back expects (x)"); receiver<DequeObj>(a).items.pushBack(a[1]); return Value(); });
+        t.add("push_front", 1, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 1, "Deque.push_front expects (x)"); receiver<DequeObj>(a).items.pushFront(a[1]); return Value(); });
+        t.add("pop_back", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "Deque.pop_back expects no args"); return receiver<DequeObj>(a).items.popBack(); });
+        t.add("pop_front", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "Deque.pop_front expects no args"); return receiver<DequeObj>(a).items.popFront(); });
+        t.add("is_empty", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "Deque.is_empty expects no args"); return Value(receiver<DequeObj>(a).items.count==0); });
+        t.add("len", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "Deque.len expects no args"); return Value((double)receiver<DequeObj>(a).items.count); });
+        return t; }(); return t; }
+
+static const NativeType& lruType(){ static const NativeType t = [](){ NativeType t("LRUCache"); t.clone = cloneLru;
+        t.add("get", 1, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 1, "LRUCache.get expects (key)"); return receiver<LruObj>(a).get(a[1]); });
+        t.add("put", 2, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 2, "LRUCache.put expects (key, value)"); receiver<LruObj>(a).put(a[1], a[2]); return Value(); });
+        t.add("size", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "LRUCache.size expects no args"); return Value((double)receiver<LruObj>(a).map.size()); });
+        return t; }(); return t; }
+
+static Value builtin_stack_new(Interpreter&, const std::vector<Value>& args){ if(!args.empty()) throw RuntimeError("Stack expects no args"); return Value(Ref<NativeObject>(new StackObj(stackType()))); }
+static Value builtin_queue_new(Interpreter&, const std::vector<Value>& args){ if(!args.empty()) throw RuntimeError("Queue expects no args"); return Value(Ref<NativeObject>(new DequeObj(queueType()))); }
+static Value builtin_deque_new(Interpreter&, const std::vector<Value>& args){ if(!args.empty()) throw RuntimeError("Deque expects no args"); return Value(Ref<NativeObject>(new DequeObj(dequeType()))); }
+static Value builtin_lru_new(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("LRUCache expects (capacity)"); auto n = std::get_if<double>(&args[0].data);
+    if(!n || *n<1){ throw RuntimeError("LRUCache capacity must be a number >= 1"); } return Value(Ref<NativeObject>(new LruObj(lruType(), (size_t)*n))); }
+
+// File handles (fs.open). Reads go through the handle's own buffer, so read_line cuts a line with memchr and builds
+// its string in one copy; writes go through a 64 KB stdio buffer. A handle iterates its remaining lines in for-in.
+struct FileObj : NativeObject {
+    FILE* f; bool writable; std::vector<char> buf; size_t pos = 0, len = 0; bool eof = false;
+    FileObj(const NativeType& t, FILE* file, bool w): NativeObject(t), f(file), writable(w) { if(w) setvbuf(f, nullptr, _IOFBF, 64*1024); else buf.resize(64*1024); }
+    ~FileObj() override { if(f) fclose(f); }
+    void traverse(GcVisit, void*) override {}
+    void clearRefs() override {}
+    FILE* open(const char* who, bool forWrite){ if(!f) throw RuntimeError(std::string(who)+": file is closed");
+        if(forWrite != writable){ throw RuntimeError(std::string(who)+(writable? ": file is open for writing" : ": file is open for reading")); } return f; }
+    // Reads more input behind the unread bytes; false at end of file
+    bool fill(){ if(eof) return false;
+        if(pos){ std::memmove(buf.data(), buf.data()+pos, len-pos); len -= pos; pos = 0; }
+        if(len == buf.size()) buf.resize(buf.size()*2); // a line longer than the buffer
+        size_t n = std::fread(buf.data()+len, 1, buf.size()-len, f);
+        if(n == 0){ eof = true; if(std::ferror(f)) throw RuntimeError("file read failed"); return false; }
+        len += n; return true; }
+    // Next line without its "\n" or "\r\n"; false at end of file
+    bool readLine(Value& out){ size_t scanned = 0;
+        for(;;){ const char* nl = (const char*)std::memchr(buf.data()+pos+scanned, '\n', len-pos-scanned);
+            if(nl){ size_t end = (size_t)(nl - buf.data()), stop = end; if(stop>pos && buf[stop-1]=='\r') stop--; out = Value(std::string(buf.data()+pos, stop-pos)); pos = end+1; return true; }
+            scanned = len - pos;
+            if(!fill()){ if(pos == len) return false; out = Value(std::string(buf.data()+pos, len-pos)); pos = len; return true; } } }
+    std::string read(size_t n){ std::string out; size_t take = std::min(n, len-pos); out.assign(buf.data()+pos, take); pos += take;
+        if(out.size() < n && !eof){ size_t want = n - out.size(), have = out.size(); out.resize(n); size_t got = std::fread(out.data()+have, 1, want, f); out.resize(have+got); if(got < want) eof = true; }
+        return out; }
+    void close(){ if(f){ int rc = std::fclose(f); f = nullptr; if(rc != 0 && writable) throw RuntimeError("file close failed"); } }
+};
+
+static bool fileNext(NativeObject& o, Value& out){ auto& fo = static_cast<FileObj&>(o); fo.open("file iteration", false); return fo.readLine(out); }
+static const NativeType& fileType(){ static const NativeType t = [](){ NativeType t("File"); t.next = fileNext;
+        t.add("read_line", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "File.read_line expects no args"); auto& fo = receiver<FileObj>(a); fo.open("File.read_line", false); Value line; return fo.readLine(line)? line : Value(); });
+        t.add("read", -1, [](Interpreter&, const std::vector<Value>& a){ if(a.size()>2) throw RuntimeError("File.read expects ([n])"); auto& fo = receiver<FileObj>(a); fo.open("File.read", false);
+            size_t n = SIZE_MAX; if(a.size()==2){ auto k = std::get_if<double>(&a[1].data); if(!k || *k<0) throw RuntimeError("File.read: n must be a number >= 0"); n = (size_t)*k; }
+            if(n != SIZE_MAX) return Value(fo.read(n));
+            std::string all(fo.buf.data()+fo.pos, fo.len-fo.pos); fo.pos = fo.len; char chunk[64*1024]; size_t got; while(!fo.eof && (got = std::fread(chunk, 1, sizeof chunk, fo.f)) > 0) all.append(chunk, got); fo.eof = true; return Value(std::move(all)); });
+        t.add("lines", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "File.lines expects no args"); receiver<FileObj>(a).open("File.lines", false); return a[0]; });
+        t.add("write", 1, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 1, "File.write expects (text)"); auto& fo = receiver<FileObj>(a); FILE* f = fo.open("File.write", true);
+            const std::string& s = a[1].str(); if(std::fwrite(s.data(), 1, s.size(), f) != s.size()) throw RuntimeError("File.write failed"); return Value((double)s.size()); });
+        t.add("flush", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "File.flush expects no args"); auto& fo = receiver<FileObj>(a); if(std::fflush(fo.open("File.flush", true))!=0) throw RuntimeError("File.flush failed"); return Value(true); });
+        t.add("tell", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "File.tell expects no args"); auto& fo = receiver<FileObj>(a); if(!fo.f) throw RuntimeError("File.tell: file is closed");
+            long at = std::ftell(fo.f); return Value((double)at - (double)(fo.len - fo.pos)); });
+        t.add("seek", 1, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 1, "File.seek expects (offset)"); auto& fo = receiver<FileObj>(a); auto k = std::get_if<double>(&a[1].data); if(!k || *k<0) throw RuntimeError("File.seek: offset must be a number >= 0");
+            if(!fo.f){ throw RuntimeError("File.seek: file is closed"); } if(fo.writable){ std::fflush(fo.f); } if(std::fseek(fo.f, (long)*k, SEEK_SET)!=0) throw RuntimeError("File.seek failed"); fo.pos = fo.len = 0; fo.eof = false; return Value(true); });
+        t.add("close", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "File.close expects no args"); receiver<FileObj>(a).close(); return Value(true); });
+        return t; }(); return t; }
+
+// fs.open(path[, mode]): mode "r" (default), "w" or "a"; files are always binary, lines end at "\n"
+static Value builtin_fs_open(Interpreter&, const std::vector<Value>& args){ if(args.empty()||args.size()>2) throw RuntimeError("fs.open expects (path[, mode])");
+    std::string path = args[0].str(), mode = args.size()==2? args[1].str() : std::string("r");
+    mode.erase(std::remove(mode.begin(), mode.end(), 'b'), mode.end());
+    if(mode!="r" && mode!="w" && mode!="a") throw RuntimeError("fs.open: mode must be \"r\", \"w\" or \"a\"");
+    FILE* f = std::fopen(path.c_str(), (mode+"b").c_str()); if(!f) throw RuntimeError("fs.open: cannot open "+path);
+    return Value(Ref<NativeObject>(new FileObj(fileType(), f, mode!="r"))); }
+
+// Read-only memory map of a whole file (fs.mmap). The bytes are never copied as a whole: slice, find and count work
+// on the mapping and only the pieces asked for become strings, so memory use does not grow with the file size.
+struct MapObj : NativeObject {
+    const char* data = nullptr; size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE, mapping = nullptr;
+#endif
+    using NativeObject::NativeObject;
+    ~MapObj() override { unmap(); }
+    void traverse(GcVisit, void*) override {}
+    void clearRefs() override {}
+    void unmap(){
+#ifdef _WIN32
+        if(data) UnmapViewOfFile(data); if(mapping) CloseHandle(mapping); if(file != INVALID_HANDLE_VALUE) CloseHandle(file); mapping = nullptr; file = INVALID_HANDLE_VALUE;
+#else
+        if(data && size) munmap((void*)data, size);
+#endif
+        data = nullptr; size = 0; }
+    std::string_view view(const char* who) const { if(!data && size) throw RuntimeError(std::string(who)+": mapping is closed"); return std::string_view(data? data : "", size); }
+};
+// Line iterator over a mapping; keeps the mapping alive
+struct MapLinesObj : NativeObject { Ref<NativeObject> map; size_t pos = 0; bool closed = false;
+    MapLinesObj(const NativeType& t, Ref<NativeObject> m): NativeObject(t), map(std::move(m)) {}
+    void traverse(GcVisit visit, void* ctx) override { if(map) visit(map.object(), ctx); }
+    void clearRefs() override { map = nullptr; } };
+
+static bool mapLinesNext(NativeObject& o, Value& out){ auto& it = static_cast<MapLinesObj&>(o); if(!it.map) return false;
+    auto& m = static_cast<MapObj&>(*it.map); if(!m.data){ it.map = nullptr; return false; }
+    std::string_view s(m.data, m.size); if(it.pos >= s.size()) return false;
+    size_t nl = s.find('\n', it.pos), end = nl==std::string_view::npos? s.size() : nl, stop = end; if(stop>it.pos && s[stop-1]=='\r') stop--;
+    out = Value(std::string(s.substr(it.pos, stop-it.pos))); it.pos = end + 1; return true; }
+static const NativeType& mapLinesType(){ static const NativeType t = [](){ NativeType t("MappedLines"); t.next = mapLinesNext; return t; }(); return t; }
+// Byte offset into a mapping; negative counts from the end, out of range clamps
+static size_t mapIndex(const Value& v, size_t size, const char* who){ auto k = std::get_if<double>(&v.data); if(!k) throw RuntimeError(std::string(who)+": index must be a number");
+    double i = *k < 0? *k + (double)size : *k; return (size_t)std::clamp(i, 0.0, (double)size); }
+static const NativeType& mapType(){ static const NativeType t = [](){ NativeType t("MappedFile");
+        t.add("len", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "MappedFile.len expects no args"); return Value((double)receiver<MapObj>(a).view("MappedFile.len").size()); });
+        t.add("slice", -1, [](Interpreter&, const std::vector<Value>& a){ if(a.size()<2||a.size()>3) throw RuntimeError("MappedFile.slice expects (start[, end])"); auto s = receiver<MapObj>(a).view("MappedFile.slice");
+            size_t from = mapIndex(a[1], s.size(), "MappedFile.slice"), to = a.size()==3? mapIndex(a[2], s.size(), "MappedFile.slice") : s.size(); return Value(std::string(from<to? s.substr(from, to-from) : std::string_view())); });
+        t.add("find", -1, [](Interpreter&, const std::vector<Value>& a){ if(a.size()<2||a.size()>3) throw RuntimeError("MappedFile.find expects (text[, start])"); auto s = receiver<MapObj>(a).view("MappedFile.find");
+            size_t at = s.find(a[1].str(), a.size()==3? mapIndex(a[2], s.size(), "MappedFile.find") : 0); return Value(at==std::string_view::npos? -1.0 : (double)at); });
+        t.add("count", 1, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 1, "MappedFile.count expects (text)"); auto s = receiver<MapObj>(a).view("MappedFile.count"); const std::string& needle = a[1].str();
+            if(needle.empty()){ throw RuntimeError("MappedFile.count: text must not be empty"); } size_t n = 0;
+            if(needle.size()==1){ for(const char* p = s.data(), *e = p + s.size(); (p = (const char*)std::memchr(p, needle[0], (size_t)(e-p))); ++p) n++; }
+            else for(size_t at = s.find(needle); at != std::string_view::npos; at = s.find(needle, at + needle.size())) n++;
+            return Value((double)n); });
+        t.add("text", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "MappedFile.text expects no args"); return Value(std::string(receiver<MapObj>(a).view("MappedFile.text"))); });
+        t.add("lines", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "MappedFile.lines expects no args"); receiver<MapObj>(a).view("MappedFile.lines");
+            return Value(Ref<NativeObject>(new MapLinesObj(mapLinesType(), std::get<Ref<NativeObject>>(a[0].data)))); });
+        t.add("close", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "MappedFile.close expects no args"); auto& m = receiver<MapObj>(a); m.unmap(); m.size = 1; return Value(true); });
+        return t; }(); return t; }
+
+// fs.mmap(path): maps the file read-only
+static Value builtin_fs_mmap(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("fs.mmap expects (path)"); std::string path = args[0].str();
+    Ref<NativeObject> ref(new MapObj(mapType())); auto& m = static_cast<MapObj&>(*ref);
+#ifdef _WIN32
+    m.file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(m.file == INVALID_HANDLE_VALUE) throw RuntimeError("fs.mmap: cannot open "+path);
+    LARGE_INTEGER sz; if(!GetFileSizeEx(m.file, &sz)) throw RuntimeError("fs.mmap: cannot stat "+path);
+    if(sz.QuadPart > 0){ m.mapping = CreateFileMappingA(m.file, nullptr, PAGE_READONLY, 0, 0, nullptr); if(!m.mapping) throw RuntimeError("fs.mmap: cannot map "+path);
+        m.data = (const char*)MapViewOfFile(m.mapping, FILE_MAP_READ, 0, 0, 0); if(!m.data) throw RuntimeError("fs.mmap: cannot map "+path); m.size = (size_t)sz.QuadPart; }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC); if(fd < 0) throw RuntimeError("fs.mmap: cannot open "+path);
+    struct stat st{}; if(::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)){ ::close(fd); throw RuntimeError("fs.mmap: not a regular file: "+path); }
+    if(st.st_size > 0){ void* p = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p == MAP_FAILED){ ::close(fd); throw RuntimeError("fs.mmap: cannot map "+path); } m.data = (const char*)p; m.size = (size_t)st.st_size; }
+    ::close(fd);
+#endif
+    return Value(ref); }
+
+// CSV/TSV reader (csv.reader). Records are parsed straight out of a File handle's read buffer: each field is copied
+// once into a reused scratch string and once into its Value, quoted fields may hold delimiters, "" and newlines, and a
+// record never has to fit in the buffer. Column types follow list_input: "str", "auto", "int", "float".
+enum class CsvType : char { Str, Auto, Int, Float };
+static CsvType csvType(const std::string& t){ if(t=="str") return CsvType::Str; if(t=="auto") return CsvType::Auto; if(t=="int") return CsvType::Int; if(t=="float") return CsvType::Float;
+    throw RuntimeError("csv.reader: type must be \"str\", \"auto\", \"int\" or \"float\""); }
+// Whole-field number parse; surrounding spaces and a leading '+' are allowed
+static bool csvNumber(const std::string& s, bool integer, double& out){ const char* b = s.data(); const char* e = b + s.size();
+    while(b<e && (*b==' '||*b=='\t')){ b++; } while(e>b && (e[-1]==' '||e[-1]=='\t')){ e--; } if(b<e && *b=='+'){ b++; } if(b==e) return false;
+    if(integer){ long long v; auto r = std::from_chars(b, e, v); if(r.ec!=std::errc() || r.ptr!=e) return false; out = (double)v; return true; }
+    auto r = std::from_chars(b, e, out); return r.ec==std::errc() && r.ptr==e; }
+
+struct CsvReaderObj : NativeObject {
+    Ref<NativeObject> file; char delim = ','; int quote = '"'; bool header = false;
+    CsvType defType = CsvType::Str; std::vector<CsvType> colTypes; std::unordered_map<std::string, CsvType> namedTypes;
+    List names; std::vector<std::string> fields; size_t nfields = 0, records = 0; bool special[256] = {};
+    using NativeObject::NativeObject;
+    void traverse(GcVisit visit, void* ctx) override { if(file) visit(file.object(), ctx); }
+    void clearRefs() override { file = nullptr; }
+    void configure(){ special[(unsigned char)delim] = special[(unsigned char)'\n'] = special[(unsigned char)'\r'] = true; }
+    // Parses the next record into fields[0..nfields); false at end of input. Blank lines are skipped.
+    bool record(){ if(!file) return false; auto& fo = static_cast<FileObj&>(*file); if(!fo.f) throw RuntimeError("csv.reader: file is closed");
+        for(;;){ if(fo.pos==fo.len && !fo.fill()){ file = nullptr; return false; } char c = fo.buf[fo.pos]; if(c!='\n' && c!='\r') break; fo.pos++; }
+        nfields = 0;
+        for(;;){ if(nfields==fields.size()) fields.emplace_back(); std::string& out = fields[nfields++]; out.clear();
+            if(fo.pos<fo.len && (unsigned char)fo.buf[fo.pos]==quote){ fo.pos++;
+                for(;;){ if(fo.pos==fo.len && !fo.fill()) throw RuntimeError("csv.reader: unterminated quoted field in record "+std::to_string(records+1));
+                    const char* b = fo.buf.data() + fo.pos; const char* q = (const char*)std::memchr(b, quote, fo.len - fo.pos);
+                    if(!q){ out.append(b, fo.len - fo.pos); fo.pos = fo.len; continue; }
+                    out.append(b, (size_t)(q-b)); fo.pos += (size_t)(q-b) + 1;
+                    if(fo.pos==fo.len) fo.fill();
+                    if(fo.pos<fo.len && (unsigned char)fo.buf[fo.pos]==quote){ out += (char)quote; fo.pos++; continue; }
+                    break; } }
+            // unquoted field (or text after a closing quote, kept as is)
+            for(;;){ const char* b = fo.buf.data() + fo.pos; const char* e = fo.buf.data() + fo.len; const char* p = b; while(p<e && !special[(unsigned char)*p]) p++;
+                out.append(b, (size_t)(p-b)); fo.pos += (size_t)(p-b);
+                if(p<e){ break; } if(!fo.fill()){ records++; return true; } }
+            char c = fo.buf[fo.pos++]; if(c==delim) continue;
+            if(c=='\r'){ if(fo.pos==fo.len) fo.fill(); if(fo.pos<fo.len && fo.buf[fo.pos]=='\n') fo.pos++; }
+            records++; return true; } }
+    CsvType typeOf(size_t col) const { return col<colTypes.size()? colTypes[col] : defType; }
+    Value field(size_t col) const { const std::string& s = fields[col]; CsvType t = typeOf(col); if(t==CsvType::Str) return Value(s);
+        double v; if(csvNumber(s, t==CsvType::Int, v)) return Value(v);
+        if(t==CsvType::Auto) return s.empty()? Value() : Value(s);
+        if(s.find_first_not_of(" \t")==std::string::npos) return Value();
+        throw RuntimeError("csv.reader: record "+std::to_string(records)+", column "+std::to_string(col+1)+": not "+(t==CsvType::Int? "an int" : "a number")+": "+s); }
+    // Reads the header record (when asked for) and resolves per-name types to column positions
+    void start(){ if(!header || !names.empty()) return; if(!record()) return;
+        for(size_t i=0;i<nfields;i++) names.push_back(Value(fields[i]));
+        if(!namedTypes.empty()){ colTypes.assign(nfields, defType); for(size_t i=0;i<nfields;i++){ auto it = namedTypes.find(fields[i]); if(it!=namedTypes.end()) colTypes[i] = it->second; } } }
+    Value row(){ if(header){ Dict d; for(size_t i=0;i<nfields;i++) d[i<names.size()? names[i].str() : std::to_string(i)] = field(i); return Value(std::move(d)); }
+        List l; l.reserve(nfields); for(size_t i=0;i<nfields;i++) l.push_back(field(i)); return Value(std::move(l)); }
+    // Remaining records as one list per column; short records are padded with null
+    Value columns(){ std::vector<List> cols; size_t n = 0;
+        while(record()){ if(nfields>cols.size()){ cols.resize(nfields); for(size_t i=0;i<nfields;i++) cols[i].resize(n); }
+            for(size_t i=0;i<cols.size();i++){ cols[i].push_back(i<nfields? field(i) : Value()); } n++; }
+        if(header){ cols.resize(std::max(cols.size(), names.size()), List(n)); Dict d; for(size_t i=0;i<cols.size();i++) d[i<names.size()? names[i].str() : std::to_string(i)] = Value(std::move(cols[i])); return Value(std::move(d)); }
+        List out; out.reserve(cols.size()); for(auto& c: cols) out.push_back(Value(std::move(c))); return Value(std::move(out)); }
+};
+
+static bool csvNext(NativeObject& o, Value& out){ auto& r = static_cast<CsvReaderObj&>(o); if(!r.record()) return false; out = r.row(); return true; }
+static const NativeType& csvReaderType(){ static const NativeType t = [](){ NativeType t("CsvReader"); t.next = csvNext;
+        t.add("read_row", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "CsvReader.read_row expects no args"); auto& r = receiver<CsvReaderObj>(a); return r.record()? r.row() : Value(); });
+        t.add("rows", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "CsvReader.rows expects no args"); auto& r = receiver<CsvReaderObj>(a); List out; while(r.record()) out.push_back(r.row()); return Value(std::move(out)); });
+        t.add("columns", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "CsvReader.columns expects no args"); return receiver<CsvReaderObj>(a).columns(); });
+        t.add("header", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "CsvReader.header expects no args"); auto& r = receiver<CsvReaderObj>(a); return r.header? Value(r.names) : Value(); });
+        t.add("line", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "CsvReader.line expects no args"); return Value((double)receiver<CsvReaderObj>(a).records); });
+        return t; }(); return t; }
+
+static char csvChar(const Value& v, const char* what){ std::string s = v.str(); if(s=="\\t" || s=="tab") return '\t'; if(s.size()!=1) throw RuntimeError(std::string("csv.reader: ")+what+" must be one character"); return s[0]; }
+// csv.reader(path_or_file[, options]): options { delimiter, quote, header, types, columns }
+static Value builtin_csv_reader(Interpreter&, const std::vector<Value>& args){ if(args.empty()||args.size()>2) throw RuntimeError("csv.reader expects (path_or_file[, options])");
+    Ref<NativeObject> ref(new CsvReaderObj(csvReaderType())); auto& r = static_cast<CsvReaderObj&>(*ref);
+    if(auto p = args[0].asString()){ FILE* f = std::fopen(p->c_str(), "rb"); if(!f) throw RuntimeError("csv.reader: cannot open "+*p);
+        r.file = Ref<NativeObject>(new FileObj(fileType(), f, false)); if(p->size()>4 && p->compare(p->size()-4, 4, ".tsv")==0) r.delim = '\t'; }
+    else if(auto o = std::get_if<Ref<NativeObject>>(&args[0].data); o && &(*o)->type==&fileType()){ static_cast<FileObj&>(**o).open("csv.reader", false); r.file = *o; }
+    else throw RuntimeError("csv.reader: source must be a path or a file from fs.open");
+    bool columns = false;
+    if(args.size()==2 && !args[1].isNull()){ auto opts = args[1].asDict(); if(!opts) throw RuntimeError("csv.reader: options must be a dict");
+        for(const auto& [k, v]: *opts){
+            if(k=="delimiter") r.delim = csvChar(v, "delimiter");
+            else if(k=="quote"){ r.quote = v.str().empty()? -1 : (unsigned char)csvChar(v, "quote"); }
+            else if(k=="header") r.header = Interpreter::isTruthy(v);
+            else if(k=="columns") columns = Interpreter::isTruthy(v);
+            else if(k=="types"){
+                if(v.isString()) r.defType = csvType(v.str());
+                else if(auto l = v.asList()){ for(const auto& t: *l) r.colTypes.push_back(csvType(t.str())); }
+                else if(auto d = v.asDict()){ for(const auto& [name, t]: *d) r.namedTypes[name] = csvType(t.str()); }
+                else throw RuntimeError("csv.reader: types must be a string, a list or a dict"); }
+            else throw RuntimeError("csv.reader: unknown option "+k); }
+        if(!r.namedTypes.empty() && !r.header) throw RuntimeError("csv.reader: types by column name need header: true"); }
+    if(r.quote>=0 && (char)r.quote==r.delim) throw RuntimeError("csv.reader: quote and delimiter must differ");
+    r.configure(); r.start();
+    return columns? r.columns() : Value(ref); }
+
+// JSON (json.parse / json.stringify / json.parser). The parser is a single pass over the text with a cursor:
+// strings without escapes become Values straight from the input span, and string scanning checks 8 bytes at a
+// time for a quote, a backslash or a control byte. Objects map to Dict, arrays to List, numbers to double.
+static constexpr int kJsonMaxDepth = 512;
+// Index of the first '"', '\\' or control byte in [p, e), scanning a word at a time
+static const char* jsonStringStop(const char* p, const char* e){
+    constexpr uint64_t ones = 0x0101010101010101ull, highs = 0x8080808080808080ull;
+    for(; e - p >= 8; p += 8){ uint64_t v; std::memcpy(&v, p, 8);
+        uint64_t q = v ^ (ones * '"'), b = v ^ (ones * '\\');
+        if(((q - ones) & ~q & highs) | ((b - ones) & ~b & highs) | ((v - ones * 0x20) & ~v & highs)) break; }
+    while(p < e && *p != '"' && *p != '\\' && (unsigned char)*p >= 0x20){ p++; } return p; }
+static void jsonUtf8(std::string& out, uint32_t cp){
+    if(cp < 0x80) out += (char)cp; else if(cp < 0x800){ out += (char)(0xC0 | (cp>>6)); out += (char)(0x80 | (cp & 0x3F)); }
+    else if(cp < 0x10000){ out += (char)(0xE0 | (cp>>12)); out += (char)(0x80 | ((cp>>6) & 0x3F)); out += (char)(0x80 | (cp & 0x3F)); }
+    else { out += (char)(0xF0 | (cp>>18)); out += (char)(0x80 | ((cp>>12) & 0x3F)); out += (char)(0x80 | ((cp>>6) & 0x3F)); out += (char)(0x80 | (cp & 0x3F)); } }
+
+struct JsonParser {
+    const char* b; const char* p; const char* e; int depth = 0; std::string scratch;
+    JsonParser(const char* data, size_t n): b(data), p(data), e(data + n) {}
+    [[noreturn]] void fail(const std::string& msg){ size_t line = 1, col = 1; for(const char* q = b; q < p && q < e; q++){ if(*q=='\n'){ line++; col = 1; } else col++; }
+        throw RuntimeError("json.parse: "+msg+" at line "+std::to_string(line)+", column "+std::to_string(col)); }
+    void ws(){ while(p < e && (*p==' '||*p=='\n'||*p=='\r'||*p=='\t')) p++; }
+    bool literal(const char* word, size_t n){ if((size_t)(e-p) >= n && std::memcmp(p, word, n)==0){ p += n; return true; } return false; }
+    // Parses one complete document; trailing non-whitespace is an error
+    Value document(){ ws(); Value v = value(); ws(); if(p != e) fail("unexpected trailing characters"); return v; }
+    Value value(){ if(p >= e) fail("unexpected end of input");
+        switch(*p){
+            case '{': return object();
+            case '[': return array();
+            case '"': { p++; return Value(string()); }
+            case 't': if(literal("true", 4)) return Value(true); break;
+            case 'f': if(literal("false", 5)) return Value(false); break;
+            case 'n': if(literal("null", 4)) return Value(); break;
+            default: if(*p=='-' || (*p>='0' && *p<='9')) return Value(number()); }
+        fail(std::string("unexpected character '")+*p+"'"); }
+    Value object(){ if(++depth > kJsonMaxDepth) fail("nesting too deep"); p++; Dict d; ws();
+        if(p < e && *p=='}'){ p++; depth--; return Value(std::move(d)); }
+        for(;;){ if(p >= e || *p!='"') fail("expected a string key"); p++; std::string key = string(); ws();
+            if(p >= e || *p!=':'){ fail("expected ':'"); } p++; ws(); d.insert_or_assign(std::move(key), value()); ws();
+            if(p < e && *p==','){ p++; ws(); continue; } if(p < e && *p=='}'){ p++; break; } fail("expected ',' or '}'"); }
+        depth--; return Value(std::move(d)); }
+    Value array(){ if(++depth > kJsonMaxDepth) fail("nesting too deep"); p++; List l; ws();
+        if(p < e && *p==']'){ p++; depth--; return Value(std::move(l)); }
+        for(;;){ l.push_back(value()); ws(); if(p < e && *p==','){ p++; ws(); continue; } if(p < e && *p==']'){ p++; break; } fail("expected ',' or ']'"); }
+        depth--; return Value(std::move(l)); }
+    uint32_t hex4(){ if(e - p < 4) fail("bad \\u escape"); uint32_t v = 0; for(int i=0;i<4;i++){ char c = *p++; v <<= 4;
+            if(c>='0'&&c<='9') v |= (uint32_t)(c-'0'); else if(c>='a'&&c<='f') v |= (uint32_t)(c-'a'+10); else if(c>='A'&&c<='F') v |= (uint32_t)(c-'A'+10); else { p--; fail("bad \\u escape"); } }
+        return v; }
+    // After the opening quote; leaves p past the closing quote
+    std::string string(){ const char* s = p; p = jsonStringStop(p, e);
+        if(p < e && *p=='"'){ std::string out(s, (size_t)(p-s)); p++; return out; }
+        scratch.assign(s, (size_t)(p-s));
+        for(;;){ if(p >= e) fail("unterminated string"); char c = *p;
+            if(c=='"'){ p++; return scratch; }
+            if((unsigned char)c < 0x20) fail("control character in string");
+            p++; // backslash
+            if(p >= e) fail("unterminated string");
+            switch(*p++){ case '"': scratch += '"'; break; case '\\': scratch += '\\'; break; case '/': scratch += '/'; break;
+                case 'b': scratch += '\b'; break; case 'f': scratch += '\f'; break; case 'n': scratch += '\n'; break; case 'r': scratch += '\r'; break; case 't': scratch += '\t'; break;
+                case 'u': { uint32_t cp = hex4();
+                    if(cp>=0xD800 && cp<=0xDBFF && e-p>=6 && p[0]=='\\' && p[1]=='u'){ const char* save = p; p += 2; uint32_t lo = hex4(); if(lo>=0xDC00 && lo<=0xDFFF) cp = 0x10000 + ((cp-0xD800)<<10) + (lo-0xDC00); else p = save; }
+                    if(cp>=0xD800 && cp<=0xDFFF) cp = 0xFFFD; // an unpaired surrogate has no UTF-8 form
+                    jsonUtf8(scratch, cp); break; }
+                default: p--; fail("bad escape"); }
+            const char* run = p; p = jsonStringStop(p, e); scratch.append(run, (size_t)(p-run)); } }
+    double number(){ const char* s = p; bool neg = *p=='-'; if(neg) p++;
+        if(p >= e || !(*p>='0'&&*p<='9')) fail("bad number");
+        uint64_t mant = 0; int digits = 0; if(*p=='0') p++; else while(p < e && *p>='0' && *p<='9'){ mant = mant*10 + (uint64_t)(*p-'0'); digits++; p++; }
+        bool simple = digits <= 15;
+        if(p < e && *p=='.'){ simple = false; p++; if(p >= e || !(*p>='0'&&*p<='9')) fail("bad number"); while(p < e && *p>='0' && *p<='9') p++; }
+        if(p < e && (*p=='e'||*p=='E')){ simple = false; p++; if(p < e && (*p=='+'||*p=='-')) p++; if(p >= e || !(*p>='0'&&*p<='9')) fail("bad number"); while(p < e && *p>='0' && *p<='9') p++; }
+        if(simple) return neg? -(double)mant : (double)mant; // exact: at most 15 digits
+        double v; auto r = std::from_chars(s, p, v); if(r.ec==std::errc::result_out_of_range) fail("number out of range"); return v; }
+};
+
+struct JsonWriter {
+    std::string out; int indent = 0; bool sortKeys = false; std::vector<const void*> open;
+    void newline(size_t level){ if(!indent) return; out += '\n'; out.append(level * (size_t)indent, ' '); }
+    void string(const std::string& s){ out += '"'; const char* p = s.data(); const char* e = p + s.size();
+        for(;;){ const char* run = p; p = jsonStringStop(p, e); out.append(run, (size_t)(p-run)); if(p == e) break; char c = *p++;
+            switch(c){ case '"': out += "\\\""; break; case '\\': out += "\\\\"; break; case '\n': out += "\\n"; break; case '\r': out += "\\r"; break; case '\t': out += "\\t"; break;
+                case '\b': out += "\\b"; break; case '\f': out += "\\f"; break; default: { char u[8]; std::snprintf(u, sizeof u, "\\u%04x", (unsigned)(unsigned char)c); out += u; } } }
+        out += '"'; }
+    void number(double d){ if(!std::isfinite(d)) throw RuntimeError("json.stringify: cannot encode NaN or infinity");
+        char buf[32]; std::to_chars_result r;
+        // From 1e15 up, plain to_chars may pick fixed notation and print every digit of the double (12345678901234567168);
+        // scientific keeps it to the shortest digits that read back (1.2345678901234567e+19)
+        if(d == std::trunc(d) && std::fabs(d) < 1e15) r = std::to_chars(buf, buf + sizeof buf, (long long)d);
+        else r = std::to_chars(buf, buf + sizeof buf, d, std::fabs(d) >= 1e15? std::chars_format::scientific : std::chars_format::general);
+        out.append(buf, (size_t)(r.ptr - buf)); }
+    void enter(const void* c){ if(std::find(open.begin(), open.end(), c) != open.end()) throw RuntimeError("json.stringify: value contains a cycle");
+        if(open.size() >= (size_t)kJsonMaxDepth){ throw RuntimeError("json.stringify: nesting too deep"); } open.push_back(c); }
+    void value(const Value& v){
+        if(v.isNull()) out += "null";
+        else if(auto b = std::get_if<bool>(&v.data)) out += *b? "true" : "false";
+        else if(auto n = std::get_if<double>(&v.data)) number(*n);
+        else if(auto s = v.asString()) string(*s);
+        else if(auto l = v.asList()){ enter(l); out += '['; size_t level = open.size();
+            for(size_t i=0;i<l->size();i++){ if(i) out += ','; newline(level); value((*l)[i]); }
+            open.pop_back(); if(!l->empty()) newline(level-1); out += ']'; }
+        else if(auto d = v.asDict()){ enter(d); out += '{'; size_t level = open.size(); bool first = true;
+            auto member = [&](const std::string& k, const Value& x){ if(!first) out += ','; first = false; newline(level); string(k); out += indent? ": " : ":"; value(x); };
+            if(sortKeys){ std::vector<const Dict::value_type*> kv; kv.reserve(d->size()); for(const auto& m: *d) kv.push_back(&m);
+                std::sort(kv.begin(), kv.end(), [](auto x, auto y){ return x->first < y->first; }); for(auto m: kv) member(m->first, m->second); }
+            else for(const auto& m: *d) member(m.first, m.second);
+            open.pop_back(); if(!d->empty()) newline(level-1); out += '}'; }
+        else throw RuntimeError("json.stringify: cannot encode a "+v.typeName()); }
+};
+
+static Value builtin_json_parse(Interpreter&, const std::vector<Value>& args){ if(args.size()!=1 || !args[0].isString()) throw RuntimeError("json.parse expects (text)");
+    const std::string& s = args[0].str(); GcPause pause; JsonParser jp(s.data(), s.size()); return jp.document(); }
+// json.stringify(value[, options]): options { indent: spaces, sort_keys: bool }
+static Value builtin_json_stringify(Interpreter&, const std::vector<Value>& args){ if(args.empty() || args.size()>2) throw RuntimeError("json.stringify expects (value[, options])");
+    JsonWriter w;
+    if(args.size()==2 && !args[1].isNull()){ auto opts = args[1].asDict(); if(!opts) throw RuntimeError("json.stringify: options must be a dict");
+        for(const auto& [k, v]: *opts){ if(k=="indent"){ auto n = std::get_if<double>(&v.data); if(!n || *n<0 || *n>16) throw RuntimeError("json.stringify: indent must be 0..16"); w.indent = (int)*n; }
+            else if(k=="sort_keys") w.sortKeys = Interpreter::isTruthy(v); else throw RuntimeError("json.stringify: unknown option "+k); } }
+    w.value(args[0]); return Value(std::move(w.out)); }
+
+// Incremental parser (json.parser). feed() appends a chunk and returns the values completed by it. A structural scan
+// (strings, nesting depth, scalar ends) carries its state across chunks, so every byte is scanned once and each
+// finished value is handed to JsonParser as one span. The input is a sequence of values (concatenated or one per line),
+// or with { items: true } a single top-level array whose elements are returned one by one.
+struct JsonStreamObj : NativeObject {
+    std::string buf; size_t scan = 0, start = 0; int depth = 0, base = 0; bool inString = false, escape = false, inScalar = false, inValue = false;
+    bool items = false, opened = false, closed = false;
+    using NativeObject::NativeObject;
+    void traverse(GcVisit, void*) override {}
+    void clearRefs() override {}
+    [[noreturn]] void fail(const std::string& msg){ throw RuntimeError("json.parser: "+msg); }
+    void complete(size_t end, List& out){ JsonParser jp(buf.data() + start, end - start); out.push_back(jp.document()); inValue = false; }
+    void begin(size_t i){ if(closed) fail("data after the end of the top-level array"); start = i; inValue = true; }
+    void run(List& out){ const char* d = buf.data(); size_t n = buf.size(), i = scan;
+        while(i < n){
+            if(inString){ if(escape){ escape = false; i++; continue; }
+                const char* q = jsonStringStop(d + i, d + n); i = (size_t)(q - d); if(i >= n) break;
+                char c = d[i++]; if(c=='\\'){ escape = true; continue; } if(c=='"'){ inString = false; if(depth==base) complete(i, out); } continue; }
+            char c = d[i];
+            if(inScalar){ if(c==' '||c=='\n'||c=='\r'||c=='\t'||c==','||c==']'||c=='}'||c=='['||c=='{'||c=='"'||c==':'){ inScalar = false; if(depth==base) complete(i, out); } else { i++; continue; } }
+            switch(c){
+                case ' ': case '\n': case '\r': case '\t': break;
+                case '"': if(depth==base) begin(i); inString = true; break;
+                case '{': case '[':
+                    if(items && !opened){ if(c!='[') fail("items mode expects a top-level array"); opened = true; depth = base = 1; break; }
+                    if(depth==base){ begin(i); } depth++; break;
+                case '}': case ']':
+                    if(items && depth==base && c==']' && opened && !closed){ closed = true; depth = base = 0; break; }
+                    if(--depth < base){ fail(std::string("unexpected '")+c+"'"); } if(depth==base){ complete(i+1, out); } break;
+                case ',': if(depth==base && !(items && opened && !closed)) fail("unexpected ','"); break;
+                case ':': if(depth==base) fail("unexpected ':'"); break;
+                default: if(items && !opened) fail("items mode expects a top-level array"); if(depth==base) begin(i); inScalar = true; }
+            i++; }
+        // drop everything before the value in progress
+        size_t keep = inValue? start : i; buf.erase(0, keep); scan = i - keep; start -= inValue? keep : start; }
+    List feed(const std::string& chunk){ buf.append(chunk); List out; GcPause pause; run(out); return out; }
+    List finish(){ List out; if(inScalar && depth==base){ inScalar = false; complete(buf.size(), out); }
+        if(inValue) fail("input ends inside a value");
+        if(items && opened && !closed) fail("input ends inside the top-level array");
+        buf.clear(); scan = start = 0; depth = base = 0; opened = closed = false; return out; }
+};
+static const NativeType& jsonStreamType(){ static const NativeType t = [](){ NativeType t("JsonParser");
+        t.add("feed", 1, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 1, "JsonParser.feed expects (chunk)"); if(!a[1].isString()) throw RuntimeError("JsonParser.feed: chunk must be a string"); return Value(receiver<JsonStreamObj>(a).feed(a[1].str())); });
+        t.add("finish", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "JsonParser.finish expects no args"); return Value(receiver<JsonStreamObj>(a).finish()); });
+        t.add("pending", 0, [](Interpreter&, const std::vector<Value>& a){ expectArgs(a, 0, "JsonParser.pending expects no args"); return Value((double)receiver<JsonStreamObj>(a).buf.size()); });
+        return t; }(); return t; }
+// json.parser([options]): options { items: bool }
+static Value builtin_json_parser(Interpreter&, const std::vector<Value>& args){ if(args.size()>1) throw RuntimeError("json.parser expects ([options])");
+    Ref<NativeObject> ref(new JsonStreamObj(jsonStreamType())); auto& s = static_cast<JsonStreamObj&>(*ref);
+    if(args.size()==1 && !args[0].isNull()){ auto opts = args[0].asDict(); if(!opts) throw RuntimeError("json.parser: options must be a dict");
+        for(const auto& [k, v]: *opts){ if(k=="items") s.items = Interpreter::isTruthy(v); else throw RuntimeError("json.parser: unknown option "+k); } }
+    return Value(ref); }
+
+// Sorting, searching and graph kernels (formerly script code in builtins/algorithms.ad)
+// Introsort: median-of-three quicksort, heapsort once recursion gets too deep, insertion sort for short runs.
+// Partition scans are bounds-checked, so an inconsistent comparator can misorder the list but never overrun it.
+template<typename Less> static void introsort(Value* a, ptrdiff_t n, int depth, Less& less){
+    while(n > 16){
+        if(depth-- == 0){ std::make_heap(a, a+n, less); std::sort_heap(a, a+n, less); return; }
+        ptrdiff_t mid = n/2;
+        if(less(a[mid], a[0])) std::swap(a[mid], a[0]);
+        if(less(a[n-1], a[mid])){ std::swap(a[n-1], a[mid]); if(less(a[mid], a[0])) std::swap(a[mid], a[0]); }
+        Value pivot = a[mid]; ptrdiff_t i = 0, j = n-1;
+        while(i <= j){
+            while(i < n && less(a[i], pivot)) ++i;
+            while(j >= 0 && less(pivot, a[j])) --j;
+            if(i <= j){ std::swap(a[i], a[j]); ++i; --j; }
+        }
+        // recurse into the smaller side [0, j] or [i, n), loop on the larger
+        if(j+1 < n-i){ introsort(a, j+1, depth, less); a += i; n -= i; } else { introsort(a+i, n-i, depth, less); n = j+1; }
+    }
+    for(ptrdiff_t k=1;k<n;++k){ Value x = std::move(a[k]); ptrdiff_t m = k; while(m>0 && less(x, a[m-1])){ a[m] = std::move(a[m-1]); --m; } a[m] = std::move(x); }
+}
+
+// Default order: numbers by value, strings lexicographically; anything else needs a comparator
+static bool naturalLess(const Value& a, const Value& b){ auto x = std::get_if<double>(&a.data); auto y = std::get_if<double>(&b.data); if(x && y) return *x<*y;
+    auto s = a.asString(); auto t = b.asString(); if(s && t) return *s<*t; throw RuntimeError("Cannot compare "+a.typeName()+" with "+b.typeName()+" (pass a comparator)"); }
+
+// 'cmp' (optional) is called as cmp(a, b) and returns a negative number (or true) when a sorts before b
+static void sortValues(Interpreter& ip, List& xs, const Value* cmp){
+    int depth = 2; for(size_t n = xs.size(); n > 1; n >>= 1) depth += 2;
+    if(!cmp){ auto less = naturalLess; introsort(xs.data(), (ptrdiff_t)xs.size(), depth, less); return; }
+    auto less = [&ip, cmp](const Value& a, const Value& b){ Value r = ip.callValue(*cmp, {a, b}); if(auto n = std::get_if<double>(&r.data)) return *n<0; if(auto t = std::get_if<bool>(&r.data)) return *t; throw RuntimeError("sort comparator must return a number or bool"); };
+    introsort(xs.data(), (ptrdiff_t)xs.size(), depth, less);
+}
+
+// Sorts a script list in place. The elements are moved out while sorting so a comparator that touches the list
+// cannot invalidate them.
+static Value sortListValue(Interpreter& ip, const Value& v, const Value* cmp, const char* usage){ List* xs = v.asList(); if(!xs) throw RuntimeError(usage);
+    List work = std::move(*xs); xs->clear();
+    try{ sortValues(ip, work, cmp); } catch(...){ *v.asList() = std::move(work); throw; }
+    *v.asList() = std::move(work); return v; }
+
+static Value builtin_sort(Interpreter& ip, const std::vector<Value>& args){ if(args.empty() || args.size()>2) throw RuntimeError("sort expects (list[, cmp])"); return sortListValue(ip, args[0], args.size()==2? &args[1] : nullptr, "sort expects (list[, cmp])"); }
+static Value builtin_sorted(Interpreter& ip, const std::vector<Value>& args){ if(args.empty() || args.size()>2) throw RuntimeError("sorted expects (list[, cmp])"); auto xs = args[0].asList(); if(!xs) throw RuntimeError("sorted expects (list[, cmp])");
+    Value out = Value(List(*xs)); return sortListValue(ip, out, args.size()==2? &args[1] : nullptr, "sorted expects (list[, cmp])"); }
+static Value builtin_quicksort(Interpreter& ip, const std::vector<Value>& args){ if(args.size()!=1) throw RuntimeError("quicksort expects (list)"); return sortListValue(ip, args[0], nullptr, "quicksort expects (list)"); }
+
+// bisect_left/bisect_right(sorted_list, x[, cmp]): insertion index before/after any entries equal to x
+static Value bisect(Interpreter& ip, const std::vector<Value>& args, bool right, const char* usage){ if(args.size()<2 || args.size()>3) throw RuntimeError(usage); auto xs = args[0].asList(); if(!xs) throw RuntimeError(usage);
+    const Value* cmp = args.size()==3? &args[2] : nullptr;
+    List snapshot; if(cmp) snapshot = *xs; // a comparator may modify the list while we search it
+    const List& ys = cmp? snapshot : *xs;
+    auto less = [&](const Value& a, const Value& b){ if(!cmp) return naturalLess(a, b); Value r = ip.callValue(*cmp, {a, b}); if(auto n = std::get_if<double>(&r.data)) return *n<0; if(auto t = std::get_if<bool>(&r.data)) return *t; throw RuntimeError("bisect comparator must return a number or bool"); };
+    auto it = right? std::upper_bound(ys.begin(), ys.end(), args[1], less) : std::lower_bound(ys.begin(), ys.end(), args[1], less);
+    return Value((double)(it - ys.begin())); }
+static Value builtin_bisect_left(Interpreter& ip, const std::vector<Value>& args){ return bisect(ip, args, false, "bisect_left expects (list, x[, cmp])"); }
+static Value builtin_bisect_right(Interpreter& ip, const std::vector<Value>& args){ return bisect(ip, args, true, "bisect_right expects (list, x[, cmp])"); }
+
+// Index of 'target' in a sorted list, or -1 (same probe sequence as the former script version)
+static Value builtin_binary_search(Interpreter&, const std::vector<Value>& args){ if(args.size()!=2) throw RuntimeError("binary_search expects (list, target)"); auto xs = args[0].asList(); if(!xs) throw RuntimeError("binary_search expects (list, target)");
+    long long lo = 0, hi = (long long)xs->size()-1;
+    while(lo<=hi){ long long mid = (lo+hi)/2; const Value& v = (*xs)[mid]; if(Interpreter::equal(v, args[1])) return Value((double)mid); if(naturalLess(v, args[1])) lo = mid+1; else hi = mid-1; }
+    return Value(-1.0); }
+
+// Graph traversal over an adjacency dict { str(node): [neighbors...] }. Nodes get dense ids as they are reached, so
+// the visited set is a bitset and each edge is stringified once; nodes without an entry have no neighbors.
+struct GraphWalk { const Dict& graph; const char* who; std::unordered_map<std::string, int> ids; std::vector<std::string> keys; std::vector<bool> visited;
+    GraphWalk(const Dict& g, const char* w): graph(g), who(w) { ids.reserve(g.size()); keys.reserve(g.size()); visited.reserve(g.size()); }
+    int idOf(const Value& v){ std::string k = strOf(v); auto it = ids.find(k); if(it!=ids.end()) return it->second;
+        int id = (int)keys.size(); ids.emplace(k, id); keys.push_back(std::move(k)); visited.push_back(false); return id; }
+    const List* neighbors(int id){ auto it = graph.find(keys[id]); if(it==graph.end()) return nullptr; auto l = it->second.asList(); if(!l) throw RuntimeError(std::string(who)+": graph values must be lists of neighbors"); return l; }
+};
+
+static Value builtin_bfs(Interpreter&, const std::vector<Value>& args){ if(args.size()!=2) throw RuntimeError("bfs expects (graph, start)"); auto g = args[0].asDict(); if(!g) throw RuntimeError("bfs expects (graph, start)");
+    GraphWalk w(*g, "bfs"); List order; std::deque<std::pair<int, Value>> q;
+    int s = w.idOf(args[1]); w.visited[s] = true; q.emplace_back(s, args[1]);
+    while(!q.empty()){ auto [id, v] = std::move(q.front()); q.pop_front(); order.push_back(v);
+        if(const List* ns = w.neighbors(id)) for(const auto& n: *ns){ int nid = w.idOf(n); if(!w.visited[nid]){ w.visited[nid] = true; q.emplace_back(nid, n); } } }
+    return Value(std::move(order)); }
+
+static Value builtin_dfs(Interpreter&, const std::vector<Value>& args){ if(args.size()!=2) throw RuntimeError("dfs expects (graph, start)"); auto g = args[0].asDict(); if(!g) throw RuntimeError("dfs expects (graph, start)");
+    GraphWalk w(*g, "dfs"); List order; std::vector<std::pair<int, Value>> st;
+    st.emplace_back(w.idOf(args[1]), args[1]);
+    while(!st.empty()){ auto [id, v] = std::move(st.back()); st.pop_back(); if(w.visited[id]) continue; w.visited[id] = true; order.push_back(v);
+        if(const List* ns = w.neighbors(id)) for(size_t i = ns->size(); i-- > 0;) st.emplace_back(w.idOf((*ns)[i]), (*ns)[i]); } // reversed, so the first neighbor is visited first
+    return Value(std::move(order)); }
+
+static Value builtin_clock(Interpreter&, const std::vector<Value>& args){ if(!args.empty()) throw RuntimeError("clock expects no args");
+    return Value(std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count()); }
+
+Interpreter::Interpreter(const std::filesystem::path& entry_dir){ current_dir = entry_dir; globals->define("print", Value(makeRef<NativeFunction>("print", -1, builtin_print))); globals->define("len", Value(makeRef<NativeFunction>("len", 1, builtin_len))); globals->define("input", Value(makeRef<NativeFunction>("input", 0, builtin_input))); globals->define("map", Value(makeRef<NativeFunction>("map", 2, builtin_map))); globals->define("sqrt_bs", Value(makeRef<NativeFunction>("sqrt_bs", 1, builtin_sqrt_bs))); globals->define("range", Value(makeRef<NativeFunction>("range", -1, builtin_range))); globals->define("int", Value(makeRef<NativeFunction>("int", 1, builtin_int))); globals->define("float", Value(makeRef<NativeFunction>("float", 1, builtin_float))); globals->define("str", Value(makeRef<NativeFunction>("str", 1, builtin_str))); globals->define("split", Value(makeRef<NativeFunction>("split", -1, builtin_split))); globals->define("join", Value(makeRef<NativeFunction>("join", 2, builtin_join)));
+    // math helpers
+    static auto builtin_abs = [](Interpreter&, const std::vector<Value>& args)->Value{ if(args.size()!=1) throw RuntimeError("abs expects 1 arg"); if(auto n=std::get_if<double>(&args[0].data)) return Value(std::abs(*n)); throw RuntimeError("abs expects number"); };
+    globals->define("abs", Value(makeRef<NativeFunction>("abs", 1, builtin_abs)));
+    // container helpers
+    globals->define("has", Value(makeRef<NativeFunction>("has", 2, builtin_has)));
+    // input helpers
+    globals->define("list_input", Value(makeRef<NativeFunction>("list_input", -1, builtin_list_input)));
+    // namespaced style requests get/post via dict
+    Dict requests; requests["get"] = Value(makeRef<NativeFunction>("requests.get", -1, builtin_requests_get)); requests["post"] = Value(makeRef<NativeFunction>("requests.post", -1, builtin_requests_post)); requests["request"] = Value(makeRef<NativeFunction>("requests.request", -1, builtin_requests_request));
+    requests["configure"] = Value(makeRef<NativeFunction>("requests.configure", -1, builtin_requests_configure)); requests["stats"] = Value(makeRef<NativeFunction>("requests.stats", 0, builtin_requests_stats));
+    requests["batch"] = Value(makeRef<NativeFunction>("requests.batch", -1, builtin_requests_batch)); requests["get_many"] = Value(makeRef<NativeFunction>("requests.get_many", -1, builtin_requests_get_many));
+    requests["stream"] = Value(makeRef<NativeFunction>("requests.stream", -1, builtin_requests_stream)); requests["download"] = Value(makeRef<NativeFunction>("requests.download", -1, builtin_requests_download));
+    requests["conditional"] = Value(makeRef<NativeFunction>("requests.conditional", 1, builtin_requests_conditional));
+    requests["cache"] = Value(makeRef<NativeFunction>("requests.cache", -1, builtin_requests_cache)); requests["cache_stats"] = Value(makeRef<NativeFunction>("requests.cache_stats", 0, builtin_requests_cache_stats)); requests["cache_clear"] = Value(makeRef<NativeFunction>("requests.cache_clear", 0, builtin_requests_cache_clear)); globals->define("requests", Value(requests));
+    // filesystem namespace
+    Dict fs; fs["read_text"] = Value(makeRef<NativeFunction>("fs.read_text", 1, builtin_fs_read_text)); fs["write_text"] = Value(makeRef<NativeFunction>("fs.write_text", 2, builtin_fs_write_text)); fs["exists"] = Value(makeRef<NativeFunction>("fs.exists", 1, builtin_fs_exists)); fs["listdir"] = Value(makeRef<NativeFunction>("fs.listdir", 1, builtin_fs_listdir)); fs["mkdirs"] = Value(makeRef<NativeFunction>("fs.mkdirs", 1, builtin_fs_mkdirs)); fs["remove"] = Value(makeRef<NativeFunction>("fs.remove", 1, builtin_fs_remove));
+    fs["open"] = Value(makeRef<NativeFunction>("fs.open", -1, builtin_fs_open)); fs["mmap"] = Value(makeRef<NativeFunction>("fs.mmap", 1, builtin_fs_mmap));
+    globals->define("fs", Value(fs));
+    Dict csv; csv["reader"] = Value(makeRef<NativeFunction>("csv.reader", -1, builtin_csv_reader)); globals->define("csv", Value(csv));
+    Dict json; json["parse"] = Value(makeRef<NativeFunction>("json.parse", 1, builtin_json_parse)); json["stringify"] = Value(makeRef<NativeFunction>("json.stringify", -1, builtin_json_stringify));
+    json["parser"] = Value(makeRef<NativeFunction>("json.parser", -1, builtin_json_parser)); globals->define("json", Value(json));
+    // content namespace
+    Dict content; content["get"] = Value(makeRef<NativeFunction>("content.get", -1, builtin_content_get)); globals->define("content", Value(content));
+    // c namespace (C execution)
+    Dict cns; cns["run"] = Value(makeRef<NativeFunction>("c.run", -1, builtin_c_run)); globals->define("c", Value(cns));
+Dict server; server["serve"] = Value(makeRef<NativeFunction>("server.serve", -1, builtin_server_serve)); server["stop"] = Value(makeRef<NativeFunction>("server.stop", 0, builtin_server_stop)); globals->define("server", Value(server));
+    // proc namespace (command execution)
+    Dict proc; proc["exec"] = Value(makeRef<NativeFunction>("proc.exec", 1, builtin_proc_exec)); globals->define("proc", Value(proc));
+    // gc namespace (cycle collector)
+    Dict gc; gc["collect"] = Value(makeRef<NativeFunction>("gc.collect", -1, builtin_gc_collect)); gc["stats"] = Value(makeRef<NativeFunction>("gc.stats", 0, builtin_gc_stats)); gc["set_threshold"] = Value(makeRef<NativeFunction>("gc.set_threshold", -1, builtin_gc_set_threshold));
+    gc["enable"] = Value(makeRef<NativeFunction>("gc.enable", 0, builtin_gc_enable)); gc["disable"] = Value(makeRef<NativeFunction>("gc.disable", 0, builtin_gc_disable)); globals->define("gc", Value(gc));
+    // native containers (replace the script classes of builtins/datastructures.ad and builtins/lru_cache.ad)
+    globals->define("Stack", Value(makeRef<NativeFunction>("Stack", 0, builtin_stack_new))); globals->define("Queue", Value(makeRef<NativeFunction>("Queue", 0, builtin_queue_new)));
+    globals->define("Deque", Value(makeRef<NativeFunction>("Deque", 0, builtin_deque_new))); globals->define("LRUCache", Value(makeRef<NativeFunction>("LRUCache", 1, builtin_lru_new)));
+    // sorting, searching and graph kernels (replace the script versions of builtins/algorithms.ad)
+    globals->define("sort", Value(makeRef<NativeFunction>("sort", -1, builtin_sort))); globals->define("sorted", Value(makeRef<NativeFunction>("sorted", -1, builtin_sorted))); globals->define("quicksort", Value(makeRef<NativeFunction>("quicksort", 1, builtin_quicksort)));
+    globals->define("bisect_left", Value(makeRef<NativeFunction>("bisect_left", -1, builtin_bisect_left))); globals->define("bisect_right", Value(makeRef<NativeFunction>("bisect_right", -1, builtin_bisect_right))); globals->define("binary_search", Value(makeRef<NativeFunction>("binary_search", 2, builtin_binary_search)));
+    globals->define("bfs", Value(makeRef<NativeFunction>("bfs", 2, builtin_bfs))); globals->define("dfs", Value(makeRef<NativeFunction>("dfs", 2, builtin_dfs))); globals->define("clock", Value(makeRef<NativeFunction>("clock", 0, builtin_clock)));
+    // native namespace (dynamic plugin loader)
+    Dict native; native["load"] = Value(makeRef<NativeFunction>("native.load", 1, [](Interpreter& ip, const std::vector<Value>& a){ return builtin_native_load(ip,a);})); globals->define("native", Value(native)); }
+
+// Snapshots. A snapshot is a frozen deep copy of an interpreter's globals: every object in it is immortal and
+// untracked, so VMs on any thread can read it at once. A new interpreter starts from a copy of that graph in which
+// only mutable objects (containers, functions, classes, instances, closure environments) are copied; strings, native
+// functions and parsed or compiled code stay shared.
+class GraphCopy {
+public:
+    explicit GraphCopy(std::vector<Object*>* frozen): frozen(frozen) { work.reserve(64); } // freezing when 'frozen' collects the copies, thawing otherwise
+    void map(Environment* from, Environment* to){ memo[from] = to; }
+    Value copy(const Value& v);
+    Ref<Environment> copy(const Ref<Environment>& e);
+    void finish(); // fills the shells created so far; containers are filled from a worklist, so deep graphs don't recurse
+private:
+    enum Kind { List_, Dict_, Function_, Class_, Instance_, Env_ };
+    struct Pending { Kind kind; Object* from; Object* to; };
+    std::vector<Object*>* frozen; std::unordered_map<const Object*, Object*> memo; std::vector<Pending> work;
+    template<typename T> T* adopt(T* o){ if(frozen){ if constexpr (std::is_base_of_v<GcObject, T>) GcHeap::current().untrack(o); o->refs = Object::kImmortal; frozen->push_back(o); } return o; }
+    template<typename T> T* shell(Kind k, const Object* from, T* to){ adopt(to); memo[from] = to; work.push_back({k, const_cast<Object*>(from), to}); return to; }
+    template<typename T> T* seen(const Object* from){ auto it = memo.find(from); return it!=memo.end()? static_cast<T*>(it->second) : nullptr; }
+};
+
+Value GraphCopy::copy(const Value& v){
+    if(auto s = std::get_if<Ref<StrObj>>(&v.data)){ if((*s)->refs == Object::kImmortal) return v; // literals, and every string of a frozen graph
+        if(auto c = seen<StrObj>(s->object())){ return Value(Ref<StrObj>(c)); } auto c = adopt(new StrObj((*s)->s, true)); memo[s->object()] = c; return Value(Ref<StrObj>(c)); }
+    if(auto f = std::get_if<Ref<NativeFunction>>(&v.data)){ if((*f)->refs == Object::kImmortal && !(*f)->method) return v;
+        if(auto c = seen<NativeFunction>(f->object())) return Value(Ref<NativeFunction>(c));
+        Ref<NativeFunction> c = (*f)->method? Interpreter::bindNative((*f)->method, copy((*f)->receiver)) // rebinds to the copied receiver
+                                            : makeRef<NativeFunction>((*f)->name, (*f)->fixedArity, (*f)->fn);
+        adopt(c.get()); memo[f->object()] = c.get(); return Value(c); }
+    if(auto l = std::get_if<Ref<ListObj>>(&v.data)){ auto c = seen<ListObj>(l->object()); if(!c) c = shell(List_, l->object(), new ListObj(List{})); return Value(Ref<ListObj>(c)); }
+    if(auto d = std::get_if<Ref<DictObj>>(&v.data)){ auto c = seen<DictObj>(d->object()); if(!c) c = shell(Dict_, d->object(), new DictObj(Dict{})); return Value(Ref<DictObj>(c)); }
+    if(auto f = std::get_if<Ref<Function>>(&v.data)){ auto c = seen<Function>(f->object());
+        if(!c){ c = shell(Function_, f->object(), new Function(**f)); c->closure = nullptr; c->boundThis = Value(); } // filled by finish
+        return Value(Ref<Function>(c)); }
+    if(auto k = std::get_if<Ref<Class>>(&v.data)){ auto c = seen<Class>(k->object()); if(!c){ c = shell(Class_, k->object(), new Class(Symbol((*k)->name), {})); c->ar = (*k)->ar; c->slotHint = (*k)->slotHint; }
+        return Value(Ref<Class>(c)); }
+    if(auto i = std::get_if<Ref<Instance>>(&v.data)){ auto c = seen<Instance>(i->object());
+        if(!c){ c = shell(Instance_, i->object(), new Instance(std::get<Ref<Class>>(copy(Value((*i)->klass)).data))); } return Value(Ref<Instance>(c)); }
+    if(auto o = std::get_if<Ref<NativeObject>>(&v.data)){ if(auto c = seen<NativeObject>(o->object())) return Value(Ref<NativeObject>(c));
+        if(!(*o)->type.clone) throw RuntimeError("Cannot snapshot a " + (*o)->type.name + " object");
+        Ref<NativeObject> c = (*o)->type.clone(**o, [this](const Value& x){ return copy(x); }); adopt(c.get()); memo[o->object()] = c.get(); return Value(c); }
+    return v;
+}
+
+Ref<Environment> GraphCopy::copy(const Ref<Environment>& e){ if(!e) return nullptr; if(auto c = seen<Environment>(e.object())) return Ref<Environment>(c);
+    return Ref<Environment>(shell(Env_, e.object(), new Environment())); }
+
+void GraphCopy::finish(){
+    while(!work.empty()){ Pending p = work.back(); work.pop_back(); // each copy is stored into its owner as soon as it is made, which keeps it alive
+        switch(p.kind){
+        case List_: { auto& from = static_cast<ListObj*>(p.from)->items; auto to = static_cast<ListObj*>(p.to); to->items.reserve(from.size()); for(const auto& x: from) to->items.push_back(copy(x));
+            if(!frozen){ to->account(); } break; }
+        case Dict_: { auto to = static_cast<DictObj*>(p.to); to->items = static_cast<DictObj*>(p.from)->items; for(auto& kv: to->items) kv.second = copy(kv.second); // copying the table keeps its buckets
+            if(!frozen){ to->account(); } break; }
+        case Function_: { auto from = static_cast<Function*>(p.from); auto to = static_cast<Function*>(p.to); to->closure = copy(from->closure); to->boundThis = copy(from->boundThis); break; }
+        case Class_: { auto from = static_cast<Class*>(p.from); std::unordered_map<Symbol, Ref<Function>> methods;
+            for(const auto& kv: from->methods){ methods.emplace(kv.first, std::get<Ref<Function>>(copy(Value(kv.second)).data)); } static_cast<Class*>(p.to)->setMethods(std::move(methods)); break; }
+        case Instance_: { auto from = static_cast<Instance*>(p.from); auto to = static_cast<Instance*>(p.to); // replay the fields in slot order to reach the same layout
+            std::vector<Symbol> names(from->slots.size()); for(const auto& kv: from->shape->index) names[kv.second] = kv.first;
+            for(size_t i=0;i<names.size();++i){ to->defineField(names[i]) = copy(from->slots[i]); } break; }
+        case Env_: { auto from = static_cast<Environment*>(p.from); auto to = static_cast<Environment*>(p.to); to->parent = copy(from->parent);
+            to->values = from->values; for(auto& kv: to->values) kv.second = copy(kv.second);
+            to->slots.reserve(from->slots.size()); for(const auto& x: from->slots) to->slots.push_back(copy(x)); break; }
+        }
+    }
+}
+
+struct Snapshot { Ref<Environment> globals; std::vector<Object*> frozen; // owns every frozen object
+    std::filesystem::path current_dir, builtins_dir, module_cache_dir; std::unordered_set<std::string> loaded_files; bool use_bytecode = false;
+    Interpreter::Limits limits; size_t byteLimit = 0; // VMs created from the snapshot inherit the resource limits
+    explicit Snapshot(Interpreter& ip): current_dir(ip.current_dir), builtins_dir(ip.builtins_dir), module_cache_dir(ip.module_cache_dir), loaded_files(ip.loaded_files), use_bytecode(ip.use_bytecode), limits(ip.limits), byteLimit(GcHeap::current().byteLimit) {
+        GcPause pause; GraphCopy g(&frozen); globals = g.copy(ip.globals); try{ g.finish(); } catch(...){ release(); throw; } }
+    ~Snapshot(){ release(); }
+    Snapshot(const Snapshot&) = delete; Snapshot& operator=(const Snapshot&) = delete;
+private:
+    // a Ref still reads its target's count when dropped, so cut every link before freeing anything, and free the
+    // natives (whose closures may hold containers) before the containers
+    void release(){ globals = nullptr; for(Object* o: frozen) if(auto g = dynamic_cast<GcObject*>(o)) g->clearRefs();
+        for(Object*& o: frozen){ if(!dynamic_cast<GcObject*>(o)){ delete o; o = nullptr; } } for(Object* o: frozen){ delete o; } frozen.clear(); }
+};
+
+Interpreter::Interpreter(const Snapshot& snap): current_dir(snap.current_dir), builtins_dir(snap.builtins_dir), loaded_files(snap.loaded_files), module_cache_dir(snap.module_cache_dir), use_bytecode(snap.use_bytecode), limits(snap.limits) {
+    GcPause pause; GraphCopy g(nullptr); g.map(snap.globals.get(), globals.get());
+    globals->values = snap.globals->values; for(auto& kv: globals->values) kv.second = g.copy(kv.second); g.finish(); }
+
+// C API for embedding
+extern "C" {
+// Each VM owns its GC heap and every entry point below adopts it, so a VM may move between threads (used by one
+// at a time) and VMs on different threads share no mutable state
+struct AdaScriptValue;
+struct AdaScriptVM { GcHeap heap; Interpreter* ip = nullptr;
+    std::vector<Value> stack; size_t base = 0; // typed API value stack; 'base' starts the current (callback) frame
+    std::string error;                         // set by AdaScript_SetError for the running typed callback
+    std::shared_ptr<const Snapshot> origin;    // the snapshot this VM was created from: its frozen strings and natives are shared
+    int running = 0;                           // nesting of entry points that run code: the outermost starts the limit counters
+    std::unordered_set<AdaScriptValue*> handles; // live value handles, detached by AdaScript_Destroy
+};
+// Entry points that run scripts: a top-level run gets a fresh operation budget and deadline, a callback's does not
+struct RunScope { AdaScriptVM* vm; explicit RunScope(AdaScriptVM* v): vm(v) { if(vm->running++ == 0) vm->ip->startRun(); } ~RunScope(){ --vm->running; } };
+struct AdaScriptSnapshot { std::shared_ptr<const Snapshot> snap; };
+struct AdaScriptValue { Value v; AdaScriptVM* vm; }; // vm is null once its VM is destroyed
+struct AdaScriptProgram { ModuleImage image; std::optional<std::filesystem::path> dir; };
+
+static char* adascript_strdup(const std::string& s){ char* p=(char*)std::malloc(s.size()+1); if(!p) return nullptr; std::memcpy(p, s.c_str(), s.size()+1); return p; }
+// Lexes and parses source given to the C API; a syntax error starts with 'filename' when there is one
+static std::vector<StmtPtr> parseSource(const std::string& source, const char* filename){
+    try{ Lexer lx(source); auto tokens=lx.scan(); Parser ps(tokens); return ps.parse(); }
+    catch(const RuntimeError& e){ if(filename && *filename) throw RuntimeError(std::string(filename)+": "+e.what()); throw; } }
+
+ADASCRIPT_API AdaScriptVM* AdaScript_Create(const char* entry_dir){ try{ std::filesystem::path p = entry_dir? std::filesystem::path(entry_dir) : std::filesystem::current_path(); auto vm = std::make_unique<AdaScriptVM>(); GcHeapScope hs(vm->heap); vm->ip = new Interpreter(p); vm->ip->host = vm.get(); return vm.release(); } catch(...){ return nullptr; } }
+
+ADASCRIPT_API AdaScriptSnapshot* AdaScript_Snapshot(AdaScriptVM* vm, char** error_message){ if(!vm){ if(error_message) *error_message=adascript_strdup("invalid vm"); return nullptr; } GcHeapScope hs(vm->heap);
+    try{ return new AdaScriptSnapshot{std::make_shared<const Snapshot>(*vm->ip)}; } catch(const std::exception& e){ if(error_message) *error_message=adascript_strdup(e.what()); return nullptr; } }
+
+ADASCRIPT_API AdaScriptVM* AdaScript_CreateFromSnapshot(const AdaScriptSnapshot* snapshot){ if(!snapshot) return nullptr;
+    try{ auto vm = std::make_unique<AdaScriptVM>(); GcHeapScope hs(vm->heap); vm->origin = snapshot->snap; vm->ip = new Interpreter(*snapshot->snap); vm->ip->host = vm.get(); vm->heap.byteLimit = snapshot->snap->byteLimit; return vm.release(); } catch(...){ return nullptr; } }
+
+ADASCRIPT_API void AdaScript_FreeSnapshot(AdaScriptSnapshot* snapshot){ delete snapshot; }
+
+// The heap is torn down before 'origin' is dropped: its objects still point into the snapshot. Handles not yet released
+// drop their values and stay detached, so using one afterwards is refused and releasing it only frees the handle.
+ADASCRIPT_API void AdaScript_Destroy(AdaScriptVM* vm){ if(!vm) return;
+    { GcHeapScope hs(vm->heap); for(auto h: vm->handles){ h->v = Value(); h->vm = nullptr; } vm->handles.clear(); vm->stack.clear(); delete vm->ip; vm->ip = nullptr; }
+    vm->heap.teardown(); delete vm; }
+
+ADASCRIPT_API int AdaScript_SetEngine(AdaScriptVM* vm, int engine){ if(!vm) return 1; if(engine!=ADASCRIPT_ENGINE_TREE && engine!=ADASCRIPT_ENGINE_BYTECODE) return 2; vm->ip->use_bytecode = (engine==ADASCRIPT_ENGINE_BYTECODE); return 0; }
+
+ADASCRIPT_API int AdaScript_SetLimits(AdaScriptVM* vm, const AdaScriptLimits* limits){ if(!vm) return 1; AdaScriptLimits none{}; const AdaScriptLimits& l = limits? *limits : none;
+    if(l.max_call_depth < 0 || !(l.timeout_seconds >= 0)) return 2;
+    vm->ip->limits = Interpreter::Limits{l.max_operations, l.max_call_depth, l.timeout_seconds}; vm->heap.byteLimit = l.max_heap_bytes;
+    vm->ip->startRun(); return 0; } // also from a callback: the run in progress continues under the new limits, counted afresh
+
+ADASCRIPT_API void AdaScript_Interrupt(AdaScriptVM* vm){ if(vm) vm->ip->interrupted.store(true, std::memory_order_relaxed); }
+
+static std::string value_to_string(const Value& v){ std::ostringstream oss; if(auto n=std::get_if<double>(&v.data)) oss<<*n; else if(auto s=v.asString()) oss<<*s; else if(auto b=std::get_if<bool>(&v.data)) oss<<(*b?"true":"false"); else if(std::holds_alternative<std::monostate>(v.data)) oss<<"null"; else oss<<"<"<<v.typeName()<<">"; return oss.str(); }
+
+ADASCRIPT_API int AdaScript_Eval(AdaScriptVM* vm, const char* source, const char* filename, char** error_message){ if(!vm||!source){ if(error_message) *error_message=adascript_strdup("invalid vm or source"); return 1; } GcHeapScope hs(vm->heap); try{ auto stmts=parseSource(source, filename); if(filename){ vm->ip->current_dir = std::filesystem::path(filename).parent_path(); } RunScope run(vm); vm->ip->runProgram(stmts); return 0; } catch(const RuntimeError& e){ if(error_message) *error_message=adascript_strdup(e.what()); return 2; } catch(const std::exception& e){ if(error_message) *error_message=adascript_strdup(e.what()); return 3; } }
+
+ADASCRIPT_API AdaScriptProgram* AdaScript_Compile(const char* source, const char* filename, char** error_message){ if(!source){ if(error_message) *error_message=adascript_strdup("invalid source"); return nullptr; }
+    try{ auto prog = std::make_unique<AdaScriptProgram>(); prog->image.stmts = parseSource(source, filename); prog->image.frameSize = Resolver::resolveScript(prog->image.stmts);
+        if(filename){ prog->dir = std::filesystem::path(filename).parent_path(); } return prog.release();
+    } catch(const std::exception& e){ if(error_message) *error_message=adascript_strdup(e.what()); return nullptr; } }
+
+ADASCRIPT_API int AdaScript_Execute(AdaScriptVM* vm, const AdaScriptProgram* program, char** error_message){ if(!vm||!program){ if(error_message) *error_message=adascript_strdup("invalid vm or program"); return 1; } GcHeapScope hs(vm->heap);
+    try{ if(program->dir) vm->ip->current_dir = *program->dir; RunScope run(vm); vm->ip->runImage(program->image); return 0;
+    } catch(const RuntimeError& e){ if(error_message) *error_message=adascript_strdup(e.what()); return 2; } catch(const std::exception& e){ if(error_message) *error_message=adascript_strdup(e.what()); return 3; } }
+
+ADASCRIPT_API void AdaScript_FreeProgram(AdaScriptProgram* program){ delete program; }
+
+ADASCRIPT_API int AdaScript_RunFile(AdaScriptVM* vm, const char* path, char** error_message){ if(!vm||!path){ if(error_message) *error_message=adascript_strdup("invalid vm or path"); return 1; } GcHeapScope hs(vm->heap); try{ std::ifstream in(path, std::ios::binary); if(!in){ if(error_message) *error_message=adascript_strdup("failed to open file"); return 2; } std::ostringstream ss; ss<<in.rdbuf(); auto stmts=parseSource(ss.str(), path); vm->ip->current_dir = std::filesystem::path(path).parent_path(); RunScope run(vm); vm->ip->runProgram(stmts); return 0; } catch(const RuntimeError& e){ if(error_message) *error_message=adascript_strdup(e.what()); return 3; } catch(const std::exception& e){ if(error_message) *error_message=adascript_strdup(e.what()); return 4; } }
+
+ADASCRIPT_API char* AdaScript_Call(AdaScriptVM* vm, const char* func_name, const char* const* args, int argc, char** error_message){ if(!vm||!func_name){ if(error_message) *error_message=adascript_strdup("invalid vm or func_name"); return nullptr; } GcHeapScope hs(vm->heap); try{ Value* vptr = vm->ip->globals->getPtr(func_name); if(!vptr) throw RuntimeError(std::string("Undefined function: ")+func_name); std::vector<Value> av; av.reserve((size_t)argc); for(int i=0;i<argc;i++){ av.emplace_back(std::string(args[i]?args[i]:"")); }
+    Value ret; RunScope run(vm);
+    if(auto nf = std::get_if<Ref<NativeFunction>>(&vptr->data)){
+        ret = (*nf)->call(*vm->ip, av);
+    } else if(auto uf = std::get_if<Ref<Function>>(&vptr->data)){
+        ret = (*uf)->call(*vm->ip, av);
+    } else if(auto kc = std::get_if<Ref<Class>>(&vptr->data)){
+        ret = (*kc)->call(*vm->ip, av);
+    } else {
+        throw RuntimeError("Target is not callable");
+    }
+    std::string out = value_to_string(ret); return adascript_strdup(out);
+  } catch(const RuntimeError& e){ if(error_message) *error_message=adascript_strdup(e.what()); return nullptr; } catch(const std::exception& e){ if(error_message) *error_message=adascript_strdup(e.what()); return nullptr; } }
+
+struct _NativeThunk { AdaScript_NativeStringFn fn; void* user; };
+
+ADASCRIPT_API int AdaScript_RegisterNativeStringFn(AdaScriptVM* vm, const char* name, int arity, AdaScript_NativeStringFn fn, void* user_data){ if(!vm||!name||!fn) return 1; GcHeapScope hs(vm->heap); try{ auto thunk = std::make_shared<_NativeThunk>(); thunk->fn = fn; thunk->user = user_data; auto wrapper = makeRef<NativeFunction>(std::string(name), arity, [thunk](Interpreter&, const std::vector<Value>& args)->Value{
+      std::vector<std::string> sargs; sargs.reserve(args.size()); for(const auto& v: args){ sargs.push_back(value_to_string(v)); }
+      std::vector<const char*> cargs; cargs.reserve(sargs.size()); for(const auto& s: sargs){ cargs.push_back(s.c_str()); }
+      char* res = thunk->fn(thunk->user, cargs.data(), (int)cargs.size());
+      std::string out = res? std::string(res) : std::string("");
+      if(res) std::free(res);
+      return Value(out);
+    });
+    vm->ip->globals->define(name, Value(wrapper));
+    return 0;
+  } catch(...){ return 2; } }
+
+// Typed value API: values stay Values on vm->stack, so nothing is formatted or reparsed
+static Value* typedSlot(AdaScriptVM* vm, int idx){ if(!vm) return nullptr; size_t n = vm->stack.size() - vm->base;
+    if(idx >= 0){ return (size_t)idx < n? &vm->stack[vm->base + idx] : nullptr; } return (size_t)-(long long)idx <= n? &vm->stack[vm->stack.size() + idx] : nullptr; }
+static int typedType(const Value& v){ switch(v.data.index()){ case 0: return ADASCRIPT_TYPE_NULL; case 1: return ADASCRIPT_TYPE_BOOL; case 2: return ADASCRIPT_TYPE_NUMBER; case 3: return ADASCRIPT_TYPE_STRING;
+    case 4: return ADASCRIPT_TYPE_LIST; case 5: return ADASCRIPT_TYPE_DICT; case 6: case 7: case 8: return ADASCRIPT_TYPE_FUNCTION; default: return ADASCRIPT_TYPE_OBJECT; } }
+static void typedPush(AdaScriptVM* vm, Value v){ vm->stack.push_back(std::move(v)); }
+// Values the host creates or drops through the typed API are charged to the VM's heap, so they count toward
+// max_heap_bytes. Creating one never fails, since most of these entry points cannot report an error: the cap is
+// lifted for the call, and the script's next allocation fails instead.
+struct HostHeapScope { GcHeapScope hs; GcHeap& heap; size_t limit;
+    explicit HostHeapScope(AdaScriptVM* vm): hs(vm->heap), heap(vm->heap), limit(vm->heap.byteLimit) { heap.byteLimit = 0; }
+    ~HostHeapScope(){ heap.byteLimit = limit; }
+    HostHeapScope(const HostHeapScope&) = delete; HostHeapScope& operator=(const HostHeapScope&) = delete; };
+// Pops the top value into 'out' and returns the container at 'idx', which must sit below the popped value
+static Value* typedPopInto(AdaScriptVM* vm, int idx, Value& out){ Value* c = typedSlot(vm, idx); if(!c || c == &vm->stack.back()) return nullptr;
+    out = std::move(vm->stack.back()); vm->stack.pop_back(); return c; }
+
+ADASCRIPT_API int AdaScript_GetTop(AdaScriptVM* vm){ return vm? (int)(vm->stack.size() - vm->base) : 0; }
+ADASCRIPT_API void AdaScript_Pop(AdaScriptVM* vm, int n){ if(!vm || n <= 0) return; HostHeapScope hs(vm); size_t k = std::min((size_t)n, vm->stack.size() - vm->base); vm->stack.resize(vm->stack.size() - k); }
+ADASCRIPT_API void AdaScript_PushNull(AdaScriptVM* vm){ if(!vm) return; HostHeapScope hs(vm); typedPush(vm, Value()); }
+ADASCRIPT_API void AdaScript_PushBool(AdaScriptVM* vm, int b){ if(!vm) return; HostHeapScope hs(vm); typedPush(vm, Value(b != 0)); }
+ADASCRIPT_API void AdaScript_PushNumber(AdaScriptVM* vm, double n){ if(!vm) return; HostHeapScope hs(vm); typedPush(vm, Value(n)); }
+ADASCRIPT_API void AdaScript_PushString(AdaScriptVM* vm, const char* s, size_t len){ if(!vm) return; HostHeapScope hs(vm); typedPush(vm, Value(s? std::string(s, len) : std::string())); }
+
+ADASCRIPT_API int AdaScript_Type(AdaScriptVM* vm, int idx){ Value* v = typedSlot(vm, idx); return v? typedType(*v) : -1; }
+ADASCRIPT_API double AdaScript_ToNumber(AdaScriptVM* vm, int idx){ Value* v = typedSlot(vm, idx); auto n = v? std::get_if<double>(&v->data) : nullptr; return n? *n : 0; }
+ADASCRIPT_API int AdaScript_ToBool(AdaScriptVM* vm, int idx){ Value* v = typedSlot(vm, idx); return v && Interpreter::isTruthy(*v)? 1 : 0; }
+ADASCRIPT_API const char* AdaScript_ToString(AdaScriptVM* vm, int idx, size_t* len){ Value* v = typedSlot(vm, idx); auto s = v? v->asString() : nullptr; if(len) *len = s? s->size() : 0; return s? s->c_str() : nullptr; }
+
+ADASCRIPT_API void AdaScript_NewList(AdaScriptVM* vm, size_t reserve){ if(!vm) return; HostHeapScope hs(vm); List l; l.reserve(reserve); typedPush(vm, Value(std::move(l))); }
+ADASCRIPT_API void AdaScript_NewDict(AdaScriptVM* vm){ if(!vm) return; HostHeapScope hs(vm); typedPush(vm, Value(Dict{})); }
+ADASCRIPT_API int AdaScript_ListAppend(AdaScriptVM* vm, int list_idx){ if(!vm) return -1; HostHeapScope hs(vm); Value v; Value* c = typedPopInto(vm, list_idx, v); List* l = c? c->asList() : nullptr; if(!l) return -1; l->push_back(std::move(v)); return 0; }
+ADASCRIPT_API int AdaScript_DictSet(AdaScriptVM* vm, int dict_idx, const char* key, size_t len){ if(!vm || !key) return -1; HostHeapScope hs(vm);
+    Value v; Value* c = typedPopInto(vm, dict_idx, v); Dict* d = c? c->asDict() : nullptr; if(!d) return -1; (*d)[std::string(key, len)] = std::move(v); return 0; }
+ADASCRIPT_API size_t AdaScript_Len(AdaScriptVM* vm, int idx){ Value* v = typedSlot(vm, idx); if(!v) return 0;
+    if(auto l = v->asList()){ return l->size(); } if(auto d = v->asDict()){ return d->size(); } if(auto s = v->asString()){ return s->size(); } return 0; }
+ADASCRIPT_API int AdaScript_ListGet(AdaScriptVM* vm, int list_idx, size_t i){ Value* v = typedSlot(vm, list_idx); List* l = v? v->asList() : nullptr; if(!l || i >= l->size()) return -1; HostHeapScope hs(vm);
+    Value item = (*l)[i]; int t = typedType(item); typedPush(vm, std::move(item)); return t; }
+ADASCRIPT_API int AdaScript_DictGet(AdaScriptVM* vm, int dict_idx, const char* key, size_t len){ Value* v = typedSlot(vm, dict_idx); Dict* d = v? v->asDict() : nullptr; if(!d || !key) return -1;
+    auto it = d->find(std::string(key, len)); if(it == d->end()) return -1; HostHeapScope hs(vm); Value item = it->second; int t = typedType(item); typedPush(vm, std::move(item)); return t; }
+ADASCRIPT_API int AdaScript_DictKeys(AdaScriptVM* vm, int dict_idx){ Value* v = typedSlot(vm, dict_idx); Dict* d = v? v->asDict() : nullptr; if(!d) return -1; HostHeapScope hs(vm);
+    List keys; keys.reserve(d->size()); for(auto& kv: *d) keys.emplace_back(kv.first); typedPush(vm, Value(std::move(keys))); return 0; }
+
+// Pops argc arguments and pushes the result of calling 'fn' (or the global 'func_name' when fn is null)
+static int typedCall(AdaScriptVM* vm, const char* func_name, const Value* fn, int argc, char** error_message){
+    if(!vm || (!fn && !func_name) || argc < 0 || (size_t)argc > vm->stack.size() - vm->base){ if(error_message) *error_message=adascript_strdup("invalid vm, function or argc"); return 1; }
+    GcHeapScope hs(vm->heap);
+    std::vector<Value> av(std::make_move_iterator(vm->stack.end() - argc), std::make_move_iterator(vm->stack.end())); vm->stack.resize(vm->stack.size() - argc);
+    try{ Value callee; if(fn) callee = *fn; else if(Value* g = vm->ip->globals->getPtr(func_name)) callee = *g; else throw RuntimeError(std::string("Undefined function: ")+func_name);
+        RunScope run(vm); vm->stack.push_back(vm->ip->callValue(callee, av)); return 0;
+    } catch(const RuntimeError& e){ if(error_message) *error_message=adascript_strdup(e.what()); return 2; } catch(const std::exception& e){ if(error_message) *error_message=adascript_strdup(e.what()); return 3; } }
+ADASCRIPT_API int AdaScript_CallTyped(AdaScriptVM* vm, const char* func_name, int argc, char** error_message){ return typedCall(vm, func_name, nullptr, argc, error_message); }
+ADASCRIPT_API int AdaScript_CallHandle(AdaScriptVM* vm, const AdaScriptValue* fn, int argc, char** error_message){
+    if(!fn){ if(error_message) *error_message=adascript_strdup("invalid function handle"); return 1; }
+    if(fn->vm != vm){ if(error_message) *error_message=adascript_strdup(fn->vm? "function handle belongs to another VM" : "function handle outlived its VM"); return 1; }
+    return typedCall(vm, nullptr, &fn->v, argc, error_message); }
+
+static AdaScriptValue* newHandle(AdaScriptVM* vm, const Value& v){ auto h = new AdaScriptValue{v, vm}; vm->handles.insert(h); return h; }
+ADASCRIPT_API AdaScriptValue* AdaScript_Ref(AdaScriptVM* vm, int idx){ Value* v = typedSlot(vm, idx); if(!v) return nullptr; HostHeapScope hs(vm); return newHandle(vm, *v); }
+ADASCRIPT_API void AdaScript_PushRef(AdaScriptVM* vm, const AdaScriptValue* value){ if(!vm) return; HostHeapScope hs(vm); typedPush(vm, value && value->vm == vm? value->v : Value()); }
+ADASCRIPT_API void AdaScript_Release(AdaScriptValue* value){ if(!value) return; if(!value->vm){ delete value; return; }
+    HostHeapScope hs(value->vm); value->vm->handles.erase(value); delete value; }
+ADASCRIPT_API AdaScriptValue* AdaScript_GetFunction(AdaScriptVM* vm, const char* func_name){ if(!vm||!func_name) return nullptr; HostHeapScope hs(vm); Value* g = vm->ip->globals->getPtr(func_name);
+    return g && typedType(*g) == ADASCRIPT_TYPE_FUNCTION? newHandle(vm, *g) : nullptr; }
+
+ADASCRIPT_API int AdaScript_RegisterNativeFn(AdaScriptVM* vm, const char* name, int arity, AdaScript_NativeFn fn, void* user_data){ if(!vm||!name||!fn) return 1; GcHeapScope hs(vm->heap); try{
+    std::string fname(name);
+    auto wrapper = makeRef<NativeFunction>(fname, arity, [fn, user_data, fname](Interpreter& ip, const std::vector<Value>& args)->Value{
+        // the callback's frame starts at its arguments; nested calls from the callback stack further frames on top. The VM
+        // comes from the interpreter, not the closure: VMs created from a snapshot share this function
+        AdaScriptVM* vm = ip.host; if(!vm) throw RuntimeError(fname + ": typed native functions need a C API VM");
+        size_t savedBase = vm->base, frame = vm->stack.size(); vm->stack.insert(vm->stack.end(), args.begin(), args.end()); vm->base = frame; vm->error.clear();
+        int rc = fn(vm, user_data, (int)args.size());
+        Value out = rc > 0 && vm->stack.size() > frame? std::move(vm->stack.back()) : Value();
+        vm->stack.resize(frame); vm->base = savedBase;
+        if(rc < 0){ std::string msg = vm->error.empty()? fname + ": native function failed" : std::move(vm->error); vm->error.clear(); throw RuntimeError(msg); }
+        return out;
+    });
+    vm->ip->globals->define(name, Value(wrapper));
+    return 0;
+  } catch(...){ return 2; } }
+ADASCRIPT_API void AdaScript_SetError(AdaScriptVM* vm, const char* message){ if(vm) vm->error = message? message : ""; }
+
+ADASCRIPT_API void AdaScript_FreeString(char* s){ if(s) std::free(s); }
+} // extern "C"
+
+// Main
+#ifndef ADASCRIPT_NO_MAIN
+static std::filesystem::path defaultModuleCacheDir(){ return userCacheDir("modules"); }
+
+int main(int argc, char** argv){ std::ios::sync_with_stdio(false); std::cin.tie(nullptr);
+    if(argc<2){ std::cerr<<"Usage: adascript [--built-ins-location <dir>] [--engine tree|bytecode] [--no-module-cache] [--max-ops N] [--max-heap BYTES[K|M|G]] [--max-depth N] [--timeout SECONDS] <file.ad>\n"; return 1; }
+    // Parse options
+    int argi = 1; std::string script;
+    std::string builtinsLoc;
+    std::string engine = "tree";
+    bool moduleCache = true;
+    Interpreter::Limits limits; size_t maxHeap = 0;
+    // numeric option values: a non-negative number, with an optional K/M/G suffix for --max-heap
+    auto number = [&](const std::string& opt, double& out, bool sizes){ if(argi+1>=argc){ std::cerr<<"Missing value for "<<opt<<"\n"; return false; }
+        std::string v = argv[++argi]; argi++; double scale = 1; if(sizes && !v.empty()){ char c = (char)std::toupper((unsigned char)v.back()); if(c=='K'||c=='M'||c=='G'){ scale = c=='K'? 1024. : c=='M'? 1048576. : 1073741824.; v.pop_back(); } }
+        char* end = nullptr; out = std::strtod(v.c_str(), &end) * scale; if(v.empty() || *end || !(out >= 0)){ std::cerr<<"Invalid value for "<<opt<<": "<<argv[argi-1]<<"\n"; return false; } return true; };
+    while(argi < argc){ std::string a = argv[argi]; if(a == "--built-ins-location"){ if(argi+1>=argc){ std::cerr<<"Missing value for --built-ins-location\n"; return 1; } builtinsLoc = argv[++argi]; argi++; continue; }
+        else if(a == "--engine"){ if(argi+1>=argc){ std::cerr<<"Missing value for --engine\n"; return 1; } engine = argv[++argi]; argi++; if(engine!="tree" && engine!="bytecode"){ std::cerr<<"Unknown engine: "<<engine<<" (expected tree or bytecode)\n"; return 1; } continue; }
+        else if(a == "--no-module-cache"){ moduleCache = false; argi++; continue; }
+        else if(a == "--max-ops" || a == "--max-heap" || a == "--max-depth" || a == "--timeout"){ double n; if(!number(a, n, a == "--max-heap")) return 1;
+            if(a == "--max-ops") limits.ops = (uint64_t)n; else if(a == "--max-heap") maxHeap = (size_t)n; else if(a == "--max-depth") limits.depth = (int)std::min(n, 1e9); else limits.seconds = n; continue; }
+        else { script = a; argi++; break; } }
+    if(script.empty()){ std::cerr<<"Missing script file\n"; return 1; }
+    if(!std::ifstream(script, std::ios::binary)){ std::cerr<<"Failed to open: "<<script<<"\n"; return 1; }
+    // Parsed modules (the script and its imports) are cached in $ADASCRIPT_MODULE_CACHE, by default a per-user directory
+    // (see defaultModuleCacheDir); an empty ADASCRIPT_MODULE_CACHE turns the cache off like --no-module-cache
+    std::filesystem::path cacheDir;
+    if(moduleCache){ if(const char* env = std::getenv("ADASCRIPT_MODULE_CACHE")) cacheDir = env; else cacheDir = defaultModuleCacheDir();
+        if(!cacheDir.empty() && !privateCacheDir(cacheDir)){ std::cerr<<"Module cache disabled: "<<cacheDir.string()<<" is not a private directory owned by this user\n"; cacheDir.clear(); } }
+    try{
+        auto stmts = loadModule(script, cacheDir); std::filesystem::path entry = std::filesystem::path(script).parent_path(); Interpreter ip(entry); ip.use_bytecode = (engine == "bytecode"); ip.module_cache_dir = cacheDir;
+        // Resolve builtins directory: either provided or alongside executable (../builtins)
+        if(!builtinsLoc.empty()){
+            ip.builtins_dir = builtinsLoc;
+        } else {
+            try{
+                std::filesystem::path exe = std::filesystem::absolute(argv[0]);
+                std::filesystem::path exeDir = exe.parent_path();
+                std::vector<std::filesystem::path> candidates = {
+                    exeDir / "builtins",
+                    exeDir.parent_path() / "builtins",
+                    exeDir.parent_path() / "dist" / "windows" / "builtins",
+                    std::filesystem::current_path() / "builtins"
+                };
+                for(const auto& cand : candidates){
+                    if(std::filesystem::exists(cand)) { ip.builtins_dir = cand.string(); break; }
+                }
+            } catch(...){ /* ignore */ }
+        }
+        ip.limits = limits; GcHeap::current().byteLimit = maxHeap; ip.startRun();
+        ip.interpret(stmts);
+    } catch(const RuntimeError& e){ std::cerr<<"Error: "<<e.what()<<"\n"; return 1; }
+    return 0; }
+#endif
+
@@ -0,0 +1,241 @@
+/*
+C API test: the typed value stack (push and read back every type, containers, wrong types, invalid indices and
+underflow), typed and string native callbacks, and who frees which strings. Every check runs on both engines.
+Built and run by CTest; by hand, from the repository root:
+     cc -Iinclude tests/c_api_test.c -Lbuild -ladascript_core -o c_api_test
+     LD_LIBRARY_PATH=build ./c_api_test
+Prints "FAIL: ..." for each failed check and exits non-zero if there was one.
+*/
+#include "AdaScript.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int g_checks, g_failures;
+#define CHECK(cond) do{ ++g_checks; if(!(cond)){ ++g_failures; fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); } }while(0)
+
+static const char* kScript =
+    "class Point { func init(x, y) { this.x = x; this.y = y; } func sum() { return this.x + this.y; } }\n"
+    "func make_point(x, y) { return Point(x, y); }\n"
+    "func echo(v) { return v; }\n"
+    "func describe(n, s, xs, d) { return str(n) + \":\" + s + \":\" + str(len(xs)) + \":\" + str(d[\"k\"]); }\n"
+    "func fail(msg) { return len(msg) / 0; }\n"
+    "func check_host() { return host_ok; }\n";
+
+static int ok_eval(AdaScriptVM* vm, const char* src){ char* err = NULL; int rc = AdaScript_Eval(vm, src, NULL, &err);
+    if(rc != 0){ fprintf(stderr, "eval: %s\n", err? err : "?"); AdaScript_FreeString(err); } return rc == 0; }
+
+// push, type and read back each scalar type; a string may hold NUL bytes
+static void test_scalars(AdaScriptVM* vm){
+    AdaScript_PushNull(vm); AdaScript_PushBool(vm, 1); AdaScript_PushBool(vm, 0); AdaScript_PushNumber(vm, -2.5); AdaScript_PushString(vm, "a\0b", 3);
+    CHECK(AdaScript_GetTop(vm) == 5);
+    CHECK(AdaScript_Type(vm, 0) == ADASCRIPT_TYPE_NULL);
+    CHECK(AdaScript_Type(vm, 1) == ADASCRIPT_TYPE_BOOL && AdaScript_ToBool(vm, 1) == 1);
+    CHECK(AdaScript_Type(vm, 2) == ADASCRIPT_TYPE_BOOL && AdaScript_ToBool(vm, 2) == 0);
+    CHECK(AdaScript_Type(vm, 3) == ADASCRIPT_TYPE_NUMBER && AdaScript_ToNumber(vm, 3) == -2.5);
+    size_t len = 0; const char* s = AdaScript_ToString(vm, -1, &len);
+    CHECK(AdaScript_Type(vm, -1) == ADASCRIPT_TYPE_STRING && s && len == 3 && memcmp(s, "a\0b", 4) == 0);
+    CHECK(AdaScript_Len(vm, -1) == 3);
+    // negative indices count from the top
+    CHECK(AdaScript_ToNumber(vm, -2) == -2.5 && AdaScript_Type(vm, -5) == ADASCRIPT_TYPE_NULL);
+    // truthiness follows the language: null is false, a non-empty string is true
+    CHECK(AdaScript_ToBool(vm, 0) == 0 && AdaScript_ToBool(vm, 4) == 1);
+    AdaScript_Pop(vm, 5); CHECK(AdaScript_GetTop(vm) == 0);
+}
+
+// lists and dicts built from C, read back from C and passed to a script
+static void test_containers(AdaScriptVM* vm){
+    AdaScript_NewList(vm, 3);
+    for(int i = 0; i < 3; ++i){ AdaScript_PushNumber(vm, i * 10); CHECK(AdaScript_ListAppend(vm, -2) == 0); }
+    AdaScript_NewList(vm, 0); CHECK(AdaScript_ListAppend(vm, -2) == 0); // a list inside a list
+    CHECK(AdaScript_GetTop(vm) == 1 && AdaScript_Type(vm, 0) == ADASCRIPT_TYPE_LIST && AdaScript_Len(vm, 0) == 4);
+    CHECK(AdaScript_ListGet(vm, 0, 2) == ADASCRIPT_TYPE_NUMBER && AdaScript_ToNumber(vm, -1) == 20); AdaScript_Pop(vm, 1);
+    CHECK(AdaScript_ListGet(vm, 0, 3) == ADASCRIPT_TYPE_LIST && AdaScript_Len(vm, -1) == 0); AdaScript_Pop(vm, 1);
+
+    AdaScript_NewDict(vm);
+    AdaScript_PushString(vm, "v", 1); CHECK(AdaScript_DictSet(vm, -2, "k", 1) == 0);
+    AdaScript_PushBool(vm, 1); CHECK(AdaScript_DictSet(vm, -2, "flag", 4) == 0);
+    AdaScript_PushNull(vm); CHECK(AdaScript_DictSet(vm, -2, "k\0x", 3) == 0); // keys may hold NUL bytes too
+    CHECK(AdaScript_Type(vm, 1) == ADASCRIPT_TYPE_DICT && AdaScript_Len(vm, 1) == 3);
+    CHECK(AdaScript_DictGet(vm, 1, "k", 1) == ADASCRIPT_TYPE_STRING && strcmp(AdaScript_ToString(vm, -1, NULL), "v") == 0); AdaScript_Pop(vm, 1);
+    CHECK(AdaScript_DictGet(vm, 1, "k\0x", 3) == ADASCRIPT_TYPE_NULL); AdaScript_Pop(vm, 1);
+    CHECK(AdaScript_DictKeys(vm, 1) == 0 && AdaScript_Type(vm, -1) == ADASCRIPT_TYPE_LIST && AdaScript_Len(vm, -1) == 3); AdaScript_Pop(vm, 1);
+
+    // (number, string, list, dict) into a script and a string back
+    char* err = NULL; AdaScript_PushNumber(vm, 7); AdaScript_PushString(vm, "s", 1);
+    AdaScript_PushRef(vm, NULL); AdaScript_Pop(vm, 1); // a null handle pushes null
+    CHECK(AdaScript_GetTop(vm) == 4);
+    // move the list and dict above the scalars: take handles, drop them from the stack and push them back
+    AdaScriptValue* list = AdaScript_Ref(vm, 0); AdaScriptValue* dict = AdaScript_Ref(vm, 1);
+    CHECK(list && dict);
+    AdaScriptValue* n = AdaScript_Ref(vm, 2); AdaScriptValue* s = AdaScript_Ref(vm, 3);
+    AdaScript_Pop(vm, 4);
+    AdaScript_PushRef(vm, n); AdaScript_PushRef(vm, s); AdaScript_PushRef(vm, list); AdaScript_PushRef(vm, dict);
+    AdaScript_Release(n); AdaScript_Release(s); AdaScript_Release(list); AdaScript_Release(dict);
+    CHECK(AdaScript_CallTyped(vm, "describe", 4, &err) == 0);
+    CHECK(AdaScript_GetTop(vm) == 1 && strcmp(AdaScript_ToString(vm, -1, NULL), "7:s:4:v") == 0);
+    AdaScript_Pop(vm, 1);
+}
+
+// functions and objects come back with their own types and can be called or inspected
+static void test_functions_and_objects(AdaScriptVM* vm){
+    char* err = NULL;
+    AdaScriptValue* echo = AdaScript_GetFunction(vm, "echo"); CHECK(echo != NULL);
+    AdaScript_PushRef(vm, echo); CHECK(AdaScript_Type(vm, -1) == ADASCRIPT_TYPE_FUNCTION); AdaScript_Pop(vm, 1);
+    AdaScriptValue* cls = AdaScript_GetFunction(vm, "Point"); CHECK(cls != NULL); // a class is callable
+    AdaScript_PushNumber(vm, 2); AdaScript_PushNumber(vm, 3);
+    CHECK(AdaScript_CallHandle(vm, cls, 2, &err) == 0 && AdaScript_Type(vm, -1) == ADASCRIPT_TYPE_OBJECT);
+    // an object passes through a script unchanged
+    CHECK(AdaScript_CallHandle(vm, echo, 1, &err) == 0 && AdaScript_Type(vm, -1) == ADASCRIPT_TYPE_OBJECT);
+    CHECK(AdaScript_ToNumber(vm, -1) == 0 && AdaScript_ToString(vm, -1, NULL) == NULL && AdaScript_Len(vm, -1) == 0);
+    AdaScript_Pop(vm, 1);
+    CHECK(AdaScript_GetFunction(vm, "kScriptNoSuchName") == NULL);
+    CHECK(AdaScript_GetFunction(vm, "kNumber") == NULL); // defined but not callable
+    AdaScript_Release(echo); AdaScript_Release(cls);
+}
+
+// reading a value as the wrong type gives 0/NULL, and builders refuse a value that isn't their container
+static void test_type_mismatch(AdaScriptVM* vm){
+    size_t len = 99;
+    AdaScript_PushString(vm, "12", 2); AdaScript_PushNumber(vm, 5); AdaScript_NewDict(vm); AdaScript_NewList(vm, 0);
+    CHECK(AdaScript_ToNumber(vm, 0) == 0);                             // a numeric string is not a number
+    CHECK(AdaScript_ToString(vm, 1, &len) == NULL && len == 0);         // nor is a number a string
+    CHECK(AdaScript_Len(vm, 1) == 0);
+    CHECK(AdaScript_ListGet(vm, 2, 0) == -1 && AdaScript_GetTop(vm) == 4); // a dict is not a list
+    CHECK(AdaScript_DictGet(vm, 3, "k", 1) == -1 && AdaScript_GetTop(vm) == 4);
+    CHECK(AdaScript_DictKeys(vm, 3) == -1 && AdaScript_GetTop(vm) == 4);
+    CHECK(AdaScript_ListGet(vm, 3, 0) == -1);                         // out of range
+    CHECK(AdaScript_DictGet(vm, 2, "absent", 6) == -1 && AdaScript_GetTop(vm) == 4);
+    // the builders pop the value they were given even when the container is the wrong type
+    AdaScript_PushNumber(vm, 1); CHECK(AdaScript_ListAppend(vm, 2) == -1 && AdaScript_GetTop(vm) == 4);
+    AdaScript_PushNumber(vm, 1); CHECK(AdaScript_DictSet(vm, 3, "k", 1) == -1 && AdaScript_GetTop(vm) == 4);
+    AdaScript_PushNumber(vm, 1); CHECK(AdaScript_DictSet(vm, 2, NULL, 0) == -1);
+    AdaScript_Pop(vm, AdaScript_GetTop(vm)); CHECK(AdaScript_GetTop(vm) == 0);
+}
+
+// an empty stack, out-of-range indices and too many arguments are refused without touching the stack
+static void test_underflow(AdaScriptVM* vm){
+    char* err = NULL;
+    CHECK(AdaScript_GetTop(vm) == 0);
+    AdaScript_Pop(vm, 3); CHECK(AdaScript_GetTop(vm) == 0);       // popping more than the frame holds stops at empty
+    AdaScript_Pop(vm, -1); CHECK(AdaScript_GetTop(vm) == 0);
+    CHECK(AdaScript_Type(vm, 0) == -1 && AdaScript_Type(vm, -1) == -1);
+    CHECK(AdaScript_ToNumber(vm, -1) == 0 && AdaScript_ToBool(vm, 0) == 0 && AdaScript_ToString(vm, 0, NULL) == NULL && AdaScript_Len(vm, -1) == 0);
+    CHECK(AdaScript_Ref(vm, -1) == NULL);
+    AdaScript_NewList(vm, 0);
+    CHECK(AdaScript_ListAppend(vm, -1) == -1 && AdaScript_GetTop(vm) == 1); // nothing above the list to append
+    CHECK(AdaScript_Type(vm, 1) == -1 && AdaScript_Type(vm, -2) == -1);
+    AdaScript_Pop(vm, 1);
+    AdaScript_PushNumber(vm, 1);
+    CHECK(AdaScript_CallTyped(vm, "echo", 2, &err) != 0 && err != NULL);   // two arguments asked for, one on the stack
+    CHECK(AdaScript_GetTop(vm) == 1);
+    AdaScript_FreeString(err); err = NULL;
+    CHECK(AdaScript_CallTyped(vm, "echo", -1, &err) != 0); AdaScript_FreeString(err); err = NULL;
+    AdaScript_Pop(vm, 1);
+    CHECK(AdaScript_CallHandle(vm, NULL, 0, &err) != 0 && err && strcmp(err, "invalid function handle") == 0); AdaScript_FreeString(err);
+    // a NULL vm is refused everywhere
+    CHECK(AdaScript_GetTop(NULL) == 0 && AdaScript_Type(NULL, 0) == -1 && AdaScript_Eval(NULL, "1;", NULL, NULL) != 0);
+    AdaScript_PushNumber(NULL, 1); AdaScript_Pop(NULL, 1);
+}
+
+// typed native callback: its frame holds only its arguments; it returns a value, null or an error
+static int host_sum(AdaScriptVM* vm, void* user, int argc){
+    int* calls = (int*)user; ++*calls;
+    if(AdaScript_GetTop(vm) != argc || AdaScript_Type(vm, argc) != -1) { AdaScript_SetError(vm, "host_sum: bad frame"); return -1; }
+    double sum = 0; for(int i = 0; i < argc; ++i){
+        if(AdaScript_Type(vm, i) != ADASCRIPT_TYPE_NUMBER){ AdaScript_SetError(vm, "host_sum: numbers only"); return -1; }
+        sum += AdaScript_ToNumber(vm, i); }
+    if(sum == 0) return 0;
+    AdaScript_PushNumber(vm, sum); return 1; }
+
+static void test_native_callbacks(AdaScriptVM* vm){
+    char* err = NULL; int calls = 0;
+    CHECK(AdaScript_RegisterNativeFn(vm, "host_sum", 2, host_sum, &calls) == 0);
+    AdaScript_PushString(vm, "below the callback frame", 24);
+    CHECK(ok_eval(vm, "let total = host_sum(2, 3) + host_sum(4, 5); let zero = host_sum(0, 0);"));
+    CHECK(calls == 3 && AdaScript_GetTop(vm) == 1);
+    AdaScript_PushNumber(vm, 1); AdaScript_PushNumber(vm, 2);
+    CHECK(AdaScript_CallTyped(vm, "host_sum", 2, &err) == 0 && AdaScript_ToNumber(vm, -1) == 3); AdaScript_Pop(vm, 1);
+    CHECK(ok_eval(vm, "let host_ok = total == 14 && zero == null;") && AdaScript_CallTyped(vm, "check_host", 0, &err) == 0);
+    CHECK(AdaScript_ToBool(vm, -1) == 1); AdaScript_Pop(vm, 1);
+    CHECK(AdaScript_CallTyped(vm, "echo", 0, &err) != 0 && err && strcmp(err, "Arity mismatch") == 0); // script functions check their arity
+    AdaScript_FreeString(err); err = NULL;
+    // an error raised by the callback fails the call with its message
+    AdaScript_PushString(vm, "x", 1); AdaScript_PushNumber(vm, 1);
+    CHECK(AdaScript_CallTyped(vm, "host_sum", 2, &err) != 0 && err && strstr(err, "host_sum: numbers only") != NULL);
+    CHECK(AdaScript_GetTop(vm) == 1); // the arguments are popped, nothing pushed
+    AdaScript_FreeString(err); err = NULL;
+    AdaScript_Pop(vm, 1);
+}
+
+// string API: AdaScript_Call and *error_message hand malloc'd strings to the caller, and the VM frees what a
+// string native returns
+static char* host_upper(void* user, const char* const* args, int argc){ (void)user;
+    if(argc != 1) return NULL;
+    size_t n = strlen(args[0]); char* out = (char*)malloc(n + 1); if(!out) return NULL;
+    for(size_t i = 0; i <= n; ++i) out[i] = (char)(args[0][i] >= 'a' && args[0][i] <= 'z'? args[0][i] - 32 : args[0][i]);
+    return out; }
+
+static void test_string_ownership(AdaScriptVM* vm){
+    char* err = NULL;
+    CHECK(AdaScript_RegisterNativeStringFn(vm, "host_upper", 1, host_upper, NULL) == 0);
+    const char* args[] = { "abc" };
+    for(int i = 0; i < 100; ++i){ // each result is the caller's to free; a leak or double free shows up under ASan
+        char* out = AdaScript_Call(vm, "host_upper", args, 1, &err);
+        CHECK(out && strcmp(out, "ABC") == 0); AdaScript_FreeString(out); }
+    char* out = AdaScript_Call(vm, "echo", args, 1, &err); CHECK(out && strcmp(out, "abc") == 0); AdaScript_FreeString(out);
+    out = AdaScript_Call(vm, "fail", args, 1, &err);
+    CHECK(out == NULL && err && strcmp(err, "Division by zero") == 0); AdaScript_FreeString(err); err = NULL;
+    out = AdaScript_Call(vm, "no_such_function", NULL, 0, &err);
+    CHECK(out == NULL && err && strstr(err, "no_such_function") != NULL); AdaScript_FreeString(err); err = NULL;
+    CHECK(AdaScript_Eval(vm, "let = 1;", NULL, &err) != 0 && err != NULL); AdaScript_FreeString(err); err = NULL;
+    CHECK(AdaScript_Eval(vm, "fail(1);", NULL, NULL) != 0); // error_message may be NULL
+    AdaScript_FreeString(NULL);
+    // a string read with ToString stays valid while a handle holds it, after it left the stack
+    AdaScript_PushString(vm, "kept", 4); AdaScriptValue* h = AdaScript_Ref(vm, -1); const char* p = AdaScript_ToString(vm, -1, NULL);
+    AdaScript_Pop(vm, 1); CHECK(ok_eval(vm, "let churn = []; for (i in range(0, 1000)) { churn[len(churn)] = str(i); }"));
+    CHECK(strcmp(p, "kept") == 0);
+    AdaScript_Release(h);
+}
+
+// values the host pushes are charged to the VM's heap: with a 1 MB cap, a 2 MB string on the stack makes the script's
+// next allocation fail (the push itself never does), and popping the string gives its bytes back
+static void test_heap_accounting(AdaScriptVM* vm){
+    char* err = NULL; AdaScriptLimits limits = {0, 1u << 20, 0, 0};
+    size_t n = 2u << 20; char* big = (char*)malloc(n); if(!big) return; memset(big, 'x', n);
+    const char* grow = "let grown = str(1234567890) + \"abcdefghijklmnopqrstuvwxyz\";";
+    CHECK(AdaScript_SetLimits(vm, &limits) == 0);
+    CHECK(ok_eval(vm, grow));
+    AdaScript_PushString(vm, big, n); free(big);
+    CHECK(AdaScript_GetTop(vm) == 1 && AdaScript_Len(vm, -1) == n);
+    CHECK(AdaScript_Eval(vm, grow, NULL, &err) != 0 && err && strstr(err, "Memory limit exceeded") != NULL);
+    AdaScript_FreeString(err); err = NULL;
+    AdaScript_NewList(vm, 0); AdaScript_PushString(vm, "past the cap, still built", 25); // over the cap, these still succeed
+    CHECK(AdaScript_ListAppend(vm, -2) == 0 && AdaScript_Len(vm, -1) == 1);
+    AdaScript_Pop(vm, 2);
+    CHECK(ok_eval(vm, grow));
+    CHECK(AdaScript_SetLimits(vm, NULL) == 0);
+}
+
+int main(void){
+    for(int engine = ADASCRIPT_ENGINE_TREE; engine <= ADASCRIPT_ENGINE_BYTECODE; ++engine){
+        AdaScriptVM* vm = AdaScript_Create(".");
+        if(!vm){ fprintf(stderr, "FAIL: AdaScript_Create\n"); return 1; }
+        CHECK(AdaScript_SetEngine(vm, engine) == 0);
+        CHECK(AdaScript_SetEngine(vm, 7) != 0);
+        CHECK(ok_eval(vm, kScript) && ok_eval(vm, "let kNumber = 1;"));
+        test_scalars(vm);
+        test_containers(vm);
+        test_functions_and_objects(vm);
+        test_type_mismatch(vm);
+        test_underflow(vm);
+        test_native_callbacks(vm);
+        test_string_ownership(vm);
+        test_heap_accounting(vm);
+        CHECK(AdaScript_GetTop(vm) == 0);
+        AdaScript_Destroy(vm);
+    }
+    if(g_failures){ fprintf(stderr, "FAIL: %d of %d checks\n", g_failures, g_checks); return 1; }
+    printf("c_api: %d checks passed\n", g_checks);
+    return 0;
+}
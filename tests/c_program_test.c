@@ -0,0 +1,151 @@
+/*
+C API test: precompiled programs and function handles. A program is compiled once and executed many times, by
+several VMs and on both engines; syntax errors are reported by Compile and runtime errors by Execute, leaving the VM
+usable. Function handles are called repeatedly, keep their function when the global is reassigned, and are refused
+once their VM is destroyed or when passed to another VM.
+Built and run by CTest; by hand, from the repository root:
+     cc -Iinclude tests/c_program_test.c -Lbuild -ladascript_core -o c_program_test
+     LD_LIBRARY_PATH=build ./c_program_test
+Prints "FAIL: ..." for each failed check and exits non-zero if there was one.
+*/
+#include "AdaScript.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int g_checks, g_failures;
+#define CHECK(cond) do{ ++g_checks; if(!(cond)){ ++g_failures; fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); } }while(0)
+
+static const char* kSetup =
+    "let hits = 0; let total = 0; let order = {\"total\": 0}; let discount = 0;\n"
+    "func square(x) { return x * x; }\n"
+    "func counter() { return hits; }\n";
+static const char* kRule =
+    "hits = hits + 1;\n"
+    "total = total + square(hits);\n"
+    "if (order[\"total\"] > 100) { discount = 0.1; } else { discount = 0; }\n";
+
+static double global_number(AdaScriptVM* vm, const char* getter){ char* err = NULL; double n = -1;
+    if(AdaScript_CallTyped(vm, getter, 0, &err) == 0){ n = AdaScript_ToNumber(vm, -1); AdaScript_Pop(vm, 1); } else AdaScript_FreeString(err);
+    return n; }
+
+static AdaScriptVM* new_vm(int engine){ char* err = NULL; AdaScriptVM* vm = AdaScript_Create(".");
+    if(!vm) return NULL;
+    AdaScript_SetEngine(vm, engine);
+    if(AdaScript_Eval(vm, kSetup, NULL, &err) != 0 ||
+       AdaScript_Eval(vm, "func get_total() { return total; } func get_discount() { return discount; }", NULL, &err) != 0){
+        fprintf(stderr, "setup: %s\n", err? err : "?"); AdaScript_FreeString(err); AdaScript_Destroy(vm); return NULL; }
+    return vm; }
+
+// one compiled program, executed 1000 times by each of two VMs with interleaved runs
+static void test_execute_many(AdaScriptProgram* rule, int engine){
+    char* err = NULL; AdaScriptVM* a = new_vm(engine); AdaScriptVM* b = new_vm(engine);
+    CHECK(a && b); if(!a || !b){ AdaScript_Destroy(a); AdaScript_Destroy(b); return; }
+    int failed = 0;
+    for(int i = 0; i < 1000; ++i){
+        if(AdaScript_Execute(a, rule, &err) != 0){ fprintf(stderr, "execute: %s\n", err); AdaScript_FreeString(err); err = NULL; ++failed; }
+        if(i % 2 == 0 && AdaScript_Execute(b, rule, &err) != 0){ AdaScript_FreeString(err); err = NULL; ++failed; }
+    }
+    CHECK(failed == 0);
+    CHECK(global_number(a, "counter") == 1000 && global_number(b, "counter") == 500); // each VM has its own globals
+    CHECK(global_number(a, "get_total") == 1000.0 * 1001 * 2001 / 6);                  // sum of squares 1..1000
+    // the program sees globals changed between runs
+    CHECK(AdaScript_Eval(a, "order[\"total\"] = 150;", NULL, &err) == 0);
+    CHECK(AdaScript_Execute(a, rule, &err) == 0 && global_number(a, "get_discount") == 0.1);
+    CHECK(global_number(b, "get_discount") == 0);
+    AdaScript_Destroy(a); AdaScript_Destroy(b);
+}
+
+// syntax errors come from Compile with a position (and the filename when given); runtime errors from Execute
+static void test_errors(int engine){
+    char* err = NULL;
+    CHECK(AdaScript_Compile("let = 1;", NULL, &err) == NULL && err && strcmp(err, "Expected variable name at line 1, col 6") == 0);
+    AdaScript_FreeString(err); err = NULL;
+    CHECK(AdaScript_Compile("let a = 1;\nlet b = (a + ;\n", "rules/r.ad", &err) == NULL && err && strcmp(err, "rules/r.ad: Expected expression at line 2, col 15") == 0);
+    AdaScript_FreeString(err); err = NULL;
+    CHECK(AdaScript_Compile("let s = \"open;\n", "rules/r.ad", &err) == NULL && err && strcmp(err, "rules/r.ad: Unterminated string starting at line 1, col 9") == 0);
+    AdaScript_FreeString(err); err = NULL;
+    CHECK(AdaScript_Compile("while (true) { }\nbreak;", NULL, &err) == NULL && err && strstr(err, "outside of a loop at line 2") != NULL);
+    AdaScript_FreeString(err); err = NULL;
+    CHECK(AdaScript_Compile(NULL, NULL, &err) == NULL && err && strcmp(err, "invalid source") == 0);
+    AdaScript_FreeString(err); err = NULL;
+    CHECK(AdaScript_Compile("let = 1;", NULL, NULL) == NULL); // error_message may be NULL
+    // Eval reports syntax errors the same way
+    AdaScriptVM* vm = new_vm(engine); CHECK(vm != NULL); if(!vm) return;
+    CHECK(AdaScript_Eval(vm, "print(1", "setup.ad", &err) != 0 && err && strcmp(err, "setup.ad: Expected ')' at line 1, col 8") == 0);
+    AdaScript_FreeString(err); err = NULL;
+    // a runtime error fails that execution only; the program and the VM stay usable
+    AdaScriptProgram* bad = AdaScript_Compile("hits = hits + 1;\nlet z = hits / 0;\n", NULL, &err);
+    CHECK(bad != NULL);
+    CHECK(AdaScript_Execute(vm, bad, &err) != 0 && err && strcmp(err, "Division by zero") == 0);
+    AdaScript_FreeString(err); err = NULL;
+    CHECK(AdaScript_Execute(vm, bad, &err) != 0); AdaScript_FreeString(err); err = NULL;
+    CHECK(global_number(vm, "counter") == 2);
+    // unbounded recursion stops at the default depth with the same error on both engines
+    AdaScriptProgram* deep = AdaScript_Compile("func down(n) { return down(n + 1); }\ndown(0);\n", NULL, &err);
+    CHECK(deep != NULL);
+    CHECK(AdaScript_Execute(vm, deep, &err) != 0 && err && strcmp(err, "Stack overflow: calls nested too deeply") == 0);
+    AdaScript_FreeString(err); err = NULL;
+    CHECK(global_number(vm, "counter") == 2);
+    AdaScript_FreeProgram(deep);
+    CHECK(AdaScript_Execute(vm, NULL, &err) != 0 && err && strcmp(err, "invalid vm or program") == 0);
+    AdaScript_FreeString(err); err = NULL;
+    AdaScript_FreeProgram(bad); AdaScript_FreeProgram(NULL);
+    AdaScript_Destroy(vm);
+}
+
+// handles: many calls, a fixed target, wrong arguments, and refusal after AdaScript_Destroy or on another VM
+static void test_function_handles(int engine){
+    char* err = NULL; AdaScriptVM* vm = new_vm(engine); AdaScriptVM* other = new_vm(engine);
+    CHECK(vm && other); if(!vm || !other){ AdaScript_Destroy(vm); AdaScript_Destroy(other); return; }
+    AdaScriptValue* square = AdaScript_GetFunction(vm, "square"); CHECK(square != NULL);
+    double sum = 0; int failed = 0;
+    for(int i = 1; i <= 1000; ++i){ AdaScript_PushNumber(vm, i);
+        if(AdaScript_CallHandle(vm, square, 1, &err) != 0){ AdaScript_FreeString(err); err = NULL; ++failed; continue; }
+        sum += AdaScript_ToNumber(vm, -1); AdaScript_Pop(vm, 1); }
+    CHECK(failed == 0 && sum == 1000.0 * 1001 * 2001 / 6 && AdaScript_GetTop(vm) == 0);
+    // the handle keeps calling the function it found; the global now names another one
+    CHECK(AdaScript_Eval(vm, "func cube(x) { return x * x * x; } square = cube;", NULL, &err) == 0);
+    AdaScript_PushNumber(vm, 3); CHECK(AdaScript_CallHandle(vm, square, 1, &err) == 0 && AdaScript_ToNumber(vm, -1) == 9); AdaScript_Pop(vm, 1);
+    AdaScript_PushNumber(vm, 3); CHECK(AdaScript_CallTyped(vm, "square", 1, &err) == 0 && AdaScript_ToNumber(vm, -1) == 27); AdaScript_Pop(vm, 1);
+    // a call with the wrong number of arguments fails and pops them
+    AdaScript_PushNumber(vm, 1); AdaScript_PushNumber(vm, 2);
+    CHECK(AdaScript_CallHandle(vm, square, 2, &err) != 0 && err && strcmp(err, "Arity mismatch") == 0 && AdaScript_GetTop(vm) == 0);
+    AdaScript_FreeString(err); err = NULL;
+    // a handle used with another VM is refused and pushes nothing
+    AdaScript_PushNumber(other, 2);
+    CHECK(AdaScript_CallHandle(other, square, 1, &err) != 0 && err && strcmp(err, "function handle belongs to another VM") == 0);
+    AdaScript_FreeString(err); err = NULL;
+    CHECK(AdaScript_GetTop(other) == 1); AdaScript_Pop(other, 1);
+    AdaScript_PushRef(other, square); CHECK(AdaScript_Type(other, -1) == ADASCRIPT_TYPE_NULL); AdaScript_Pop(other, 1);
+    // after its VM is destroyed the handle is detached: calls are refused, PushRef pushes null, Release frees it
+    AdaScriptValue* data = NULL; AdaScript_NewList(vm, 1); AdaScript_PushString(vm, "x", 1); AdaScript_ListAppend(vm, -2);
+    data = AdaScript_Ref(vm, -1); AdaScript_Pop(vm, 1); CHECK(data != NULL);
+    AdaScript_Destroy(vm);
+    AdaScript_PushNumber(other, 2);
+    CHECK(AdaScript_CallHandle(other, square, 1, &err) != 0 && err && strcmp(err, "function handle outlived its VM") == 0);
+    AdaScript_FreeString(err); err = NULL;
+    AdaScript_Pop(other, 1);
+    AdaScript_PushRef(other, data); CHECK(AdaScript_Type(other, -1) == ADASCRIPT_TYPE_NULL); AdaScript_Pop(other, 1);
+    AdaScript_Release(square); AdaScript_Release(data);
+    // the other VM is unaffected
+    AdaScriptValue* sq = AdaScript_GetFunction(other, "square"); AdaScript_PushNumber(other, 4);
+    CHECK(sq && AdaScript_CallHandle(other, sq, 1, &err) == 0 && AdaScript_ToNumber(other, -1) == 16); AdaScript_Pop(other, 1);
+    AdaScript_Release(sq);
+    AdaScript_Destroy(other);
+}
+
+int main(void){
+    char* err = NULL;
+    AdaScriptProgram* rule = AdaScript_Compile(kRule, NULL, &err); // compiled once for every VM and both engines
+    if(!rule){ fprintf(stderr, "FAIL: compile: %s\n", err? err : "?"); AdaScript_FreeString(err); return 1; }
+    for(int engine = ADASCRIPT_ENGINE_TREE; engine <= ADASCRIPT_ENGINE_BYTECODE; ++engine){
+        test_execute_many(rule, engine);
+        test_errors(engine);
+        test_function_handles(engine);
+    }
+    AdaScript_FreeProgram(rule);
+    if(g_failures){ fprintf(stderr, "FAIL: %d of %d checks\n", g_failures, g_checks); return 1; }
+    printf("c_program: %d checks passed\n", g_checks);
+    return 0;
+}
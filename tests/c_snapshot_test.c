@@ -0,0 +1,90 @@
+/*
+C API test: a VM per request from a snapshot. Each request creates a VM from the snapshot, runs a handler that changes
+globals, builds objects and leaves reference cycles behind, then destroys the VM. Checks that every VM starts from the
+snapshot's state, and that memory stays flat over many requests: the peak RSS after a warm-up must not keep growing.
+Runs on both engines, 300 requests each by default. Set ADASCRIPT_SOAK=1 (or pass a count) for a 20,000-request soak
+run, which shows slow leaks the short run can't. Built and run by CTest; by hand, from the repository root:
+     cc -Iinclude tests/c_snapshot_test.c -Lbuild -ladascript_core -o c_snapshot_test
+     LD_LIBRARY_PATH=build ./c_snapshot_test [requests]
+Prints "FAIL: ..." for each failed check and exits non-zero if there was one.
+*/
+#include "AdaScript.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+static int g_checks, g_failures;
+#define CHECK(cond) do{ ++g_checks; if(!(cond)){ ++g_failures; fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); } }while(0)
+
+static const char* kSetup =
+    "class Node { func init(name) { this.name = name; this.peers = []; } func link(o) { this.peers[len(this.peers)] = o; o.peers[len(o.peers)] = this; } }\n"
+    "let prices = {}; for (i in range(0, 100)) { prices[\"sku\" + str(i)] = i; }\n"
+    "let seen = []; let root = Node(\"root\"); let loop = [1]; loop[1] = loop;\n"
+    "func handle(id) {\n"
+    "  let a = Node(\"a\" + str(id)); let b = Node(\"b\"); a.link(b); root.link(a);\n" /* cycles through a global */
+    "  let d = {\"self\": null, \"items\": [id, str(id), [id]]}; d[\"self\"] = d;\n"
+    "  seen[len(seen)] = json.stringify({\"id\": id});\n"
+    "  let f = func_total;\n"
+    "  return f(id) + len(seen) + len(root.peers) + len(loop);\n"
+    "}\n"
+    "func func_total(id) { let t = 0; for (k in prices) { t = t + prices[k]; } return t + id % 7; }\n";
+
+static long peak_rss_kb(void){
+#ifndef _WIN32
+    struct rusage ru; if(getrusage(RUSAGE_SELF, &ru) == 0){
+#ifdef __APPLE__
+        return (long)(ru.ru_maxrss / 1024); // bytes on macOS
+#else
+        return (long)ru.ru_maxrss;
+#endif
+    }
+#endif
+    return -1; }
+
+// one request on a fresh VM; returns the handler's result, or -1
+static double request(const AdaScriptSnapshot* snap, int id){
+    char* err = NULL; double r = -1;
+    AdaScriptVM* vm = AdaScript_CreateFromSnapshot(snap); if(!vm) return -1;
+    AdaScriptValue* handle = AdaScript_GetFunction(vm, "handle");
+    AdaScript_PushNumber(vm, id);
+    if(handle && AdaScript_CallHandle(vm, handle, 1, &err) == 0){ r = AdaScript_ToNumber(vm, -1); AdaScript_Pop(vm, 1); }
+    else { fprintf(stderr, "handle: %s\n", err? err : "no function"); AdaScript_FreeString(err); }
+    AdaScript_Release(handle);
+    AdaScript_Destroy(vm);
+    return r; }
+
+static void run(int engine, int requests){
+    char* err = NULL; AdaScriptVM* base = AdaScript_Create(".");
+    CHECK(base != NULL); if(!base) return;
+    AdaScript_SetEngine(base, engine);
+    if(AdaScript_Eval(base, kSetup, NULL, &err) != 0){ fprintf(stderr, "FAIL: setup: %s\n", err); AdaScript_FreeString(err); ++g_failures; AdaScript_Destroy(base); return; }
+    AdaScriptSnapshot* snap = AdaScript_Snapshot(base, &err);
+    CHECK(snap != NULL); AdaScript_Destroy(base); if(!snap){ AdaScript_FreeString(err); return; }
+
+    // every VM starts from the snapshot: one entry in 'seen', one peer of 'root' (4950 is the sum of the prices)
+    int wrong = 0;
+    for(int i = 0; i < requests / 4; ++i) if(request(snap, i) != 4950 + i % 7 + 1 + 1 + 2) ++wrong;
+    CHECK(wrong == 0);
+    long warm = peak_rss_kb();
+    for(int i = 0; i < requests; ++i) if(request(snap, i) != 4950 + i % 7 + 1 + 1 + 2) ++wrong;
+    CHECK(wrong == 0);
+    long after = peak_rss_kb();
+    // a VM that isn't freed leaks about 20 KB per request; allow 2 MB of allocator noise, or 8 MB on a soak run,
+    // where a leak of even 1 KB per request adds 'requests' KB
+    if(warm > 0){ CHECK(after - warm < (requests > 1000? 8 : 2) * 1024);
+        printf("engine %d: %d requests, peak RSS %ld KB -> %ld KB\n", engine, requests, warm, after); }
+    AdaScript_FreeSnapshot(snap);
+}
+
+int main(int argc, char** argv){
+    const char* soak = getenv("ADASCRIPT_SOAK");
+    int requests = argc > 1? atoi(argv[1]) : soak && *soak && strcmp(soak, "0") != 0? 20000 : 300;
+    if(requests < 4) requests = 4;
+    for(int engine = ADASCRIPT_ENGINE_TREE; engine <= ADASCRIPT_ENGINE_BYTECODE; ++engine) run(engine, requests);
+    if(g_failures){ fprintf(stderr, "FAIL: %d of %d checks\n", g_failures, g_checks); return 1; }
+    printf("c_snapshot: %d checks passed\n", g_checks);
+    return 0;
+}